@@ -29,6 +29,9 @@
 /**
  * Allows the ray tracer to perceive the world through the camera's perspective. Only one camera can be the main
  * camera. However, multiple camera's can exist in world space at once.
+ * @paragraph Ray origins and directions change linearly across the screen, so commit() works out where they start
+ * and how far they step per pixel once rather than going through the matrix for every ray. Once the camera has
+ * stayed still for a commit, the normalised direction through every pixel is cached until it moves again.
  * @author Ryan Purse
  * @version 1.0.0 [Initial Version: 18/03/2021]
  */
@@ -42,26 +45,88 @@ public:
     ~Camera() override = default;
 
     void update(float deltaTime) override;
+    void commit() override;
     void updateMat();
 
     /** Creates a ray based on the pixel position on the screen and the matrix transform of the camera. */
-    Ray generateSingleRay(const glm::ivec2 &pixelPos);
+    Ray generateSingleRay(const glm::ivec2 &pixelPos) const;
+
+    /** Same as above but allows for sub-pixel positions. Used when super sampling. */
+    Ray generateSingleRay(const glm::vec2 &pixelPos) const;
+
+    /**
+     * Creates the rays for count pixels along a row, the same as generateSingleRay() would for each of them.
+     * @param start The first pixel. Every pixel must be on the screen.
+     * @param step How many pixels along the row each ray is from the last.
+     * @param rays Must have room for count rays.
+     */
+    void generateRow(const glm::ivec2 &start, int count, int step, Ray *rays) const;
+
+    const glm::ivec2 &getScreenResolution() const
+    {
+        return mScreenResolution;
+    }
+
+    /**
+     * @returns The matrix from world space to where the camera's rays see things, as of the last commit. x / w and
+     * y / w are pixel positions (the same as generateSingleRay() takes) and w is the depth in front of the camera.
+     */
+    glm::mat4 getWorldToScreen() const;
+
+    /** Rays start on this plane, so nothing with a w below it can be seen. */
+    float getNearPlane() const
+    {
+        return mNearPlane;
+    }
+
+    /** @returns True if the directions are cached. */
+    bool isCached() const
+    {
+        return !mDirectionCache.empty();
+    }
 
 protected:
     const glm::ivec2 mScreenResolution;
     const float mAspectRatio;
     const float mFovYHalfAngle;
+    const float mNearPlane { 0.1f };
 
 private:
     glm::mat4 mRotationMat;
     glm::mat4 mTranslationMat;
     glm::mat4 mInvProjectionMat;
 
-    /** Rotation mat, translation mat and inverse projection mat all in one. */
+    /** Rotation mat, translation mat and inverse projection mat all in one. Used to generate rays. */
     glm::mat4 mInvPrtMat;
 
+    /** Calculated by updateMat(). Copied to mInvPrtMat by commit(). */
+    glm::mat4 mNextInvPrtMat;
+
+    /** Set until the first commit(). */
+    bool mIsUncommitted { true };
+
+    // Worked out from mInvPrtMat by commit(). Rays start on the near plane and point towards the far plane.
+
+    /** The start of the ray through the top left corner of the screen. */
+    glm::vec3 mOrigin;
+    glm::vec3 mOriginStepX;
+    glm::vec3 mOriginStepY;
+
+    /** The direction (before it's normalised) through the top left corner of the screen. */
+    glm::vec3 mDirection;
+    glm::vec3 mDirectionStepX;
+    glm::vec3 mDirectionStepY;
+
+    /** The normalised direction through every pixel. Row major. Empty while the camera is moving. */
+    std::vector<glm::vec3> mDirectionCache;
+
     /** Generates the InvProjectionMat on creation */
     void init();
+
+    /** @returns Where the pixel is on the near (z = -1) or far (z = 1) plane in world space. */
+    glm::vec3 unproject(const glm::vec2 &pixelPos, float z) const;
+
+    void cacheDirections();
 };
 
 
@@ -33,6 +33,9 @@ protected:
      */
     glm::quat mRotation;
     glm::vec3 mScale;
+
+    /** @see isStatic() */
+    bool mIsStatic{ false };
 public:
     Entity();
     Entity(const glm::vec3 &position, const glm::vec3 &eulerRotation, const glm::vec3 &mScale);
@@ -41,10 +44,31 @@ public:
 
     virtual void update(float deltaTime) = 0;
 
+    /**
+     * Makes the state calculated by the last update() visible to the renderer.
+     * Only called between frames, which lets update() run while the previous frame is still rendering.
+     */
+    virtual void commit() {}
+
     const glm::vec3 &getPosition() const
     {
         return mPosition;
     }
+
+    /**
+     * Static entities never change after they've been created, so the ray tracer never updates or commits them.
+     * Each type of entity works out whether it's static when constructed. Anything that is going to be moved
+     * from the outside needs to be set to dynamic.
+     */
+    bool isStatic() const
+    {
+        return mIsStatic;
+    }
+
+    void setStatic(bool isStatic)
+    {
+        mIsStatic = isStatic;
+    }
 };
 
 
@@ -88,27 +88,34 @@ struct actorLightingMaterial : public lightingMaterial
      */
     float shininessConstant;
 
+    /** How much light bends as it goes into the object from the air. 1 - not at all, 1.5 - glass. */
+    float refractiveIndex;
+
     actorLightingMaterial(const glm::vec3 &baseColour, const glm::vec3 &ambientIntensity,
                           const glm::vec3 &diffuseIntensity, const glm::vec3 &specularIntensity,
                           const glm::vec3 &transmissionIntensity, const glm::vec3 &reflectivityIntensity,
-                          float shininessConstant) :
+                          float shininessConstant, float refractiveIndex=1.5f) :
                           lightingMaterial(baseColour, ambientIntensity, diffuseIntensity, specularIntensity),
                           transmissionIntensity(transmissionIntensity),
                           reflectivityIntensity(reflectivityIntensity),
-                          shininessConstant(shininessConstant)
+                          shininessConstant(shininessConstant),
+                          refractiveIndex(refractiveIndex)
     {}
 
     actorLightingMaterial(const glm::vec3 &baseColour, const glm::vec3 &specularIntensity,
                           const glm::vec3 &reflectivityIntensity, float shininessConstant) :
                           lightingMaterial(baseColour, specularIntensity),
+                          transmissionIntensity(0.f),
                           reflectivityIntensity(reflectivityIntensity),
-                          shininessConstant(shininessConstant)
+                          shininessConstant(shininessConstant),
+                          refractiveIndex(1.5f)
     {}
 
     actorLightingMaterial() :
         transmissionIntensity(0.f),
         reflectivityIntensity(0.38f),
-        shininessConstant(2048.f)
+        shininessConstant(2048.f),
+        refractiveIndex(1.5f)
     {}
 };
 
@@ -13,7 +13,9 @@
 
 #include "Entity.h"
 #include "Ray.h"
+#include "Geometry.h"
 #include "LightingMaterials.h"
+#include "VisibilityBuffer.h"
 
 #include "glm.hpp"
 /**
@@ -37,6 +39,18 @@ public:
     virtual hitInfo isIntersecting(const Ray &ray) = 0;
     virtual bool quickIsIntersecting(const Ray &ray) = 0;
 
+    /** @returns A box around the actor as the renderer currently sees it (i.e. after the last commit). */
+    virtual aabb getBounds() const = 0;
+
+    /** Adds the actor's surface as the renderer currently sees it to the visibility pass. @see VisibilityBuffer */
+    virtual void rasterize(rasterPrimitives &primitives) const = 0;
+
+    /**
+     * The same as isIntersecting() but only against one of the primitives from rasterize(), so that the hit
+     * found by the visibility pass can be rebuilt without searching the rest of the actor.
+     */
+    virtual hitInfo isIntersectingPrimitive(const Ray &ray, std::uint32_t primitive) = 0;
+
 protected:
     actorLightingMaterial mMaterial;
 };
@@ -0,0 +1,81 @@
+/**
+ * @file Mesh.h
+ * @brief A placement of a shared mesh asset with its own transform and material.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_MESH_H
+#define A2MCGRAYTRACER_MESH_H
+
+#include "Actor.h"
+#include "MeshAsset.h"
+#include "Ray.h"
+
+#include "glm.hpp"
+
+/**
+ * An instance of a MeshAsset with its own transform and material. The triangles stay in object space
+ * and rays are moved into object space instead, so any number of instances share the asset's vertices and tree.
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 19/10/2026]
+ */
+class Mesh : public Actor
+{
+public:
+    /**
+     * @param material Used by every triangle that the asset doesn't give a material.
+     * @param asset Must outlive the mesh.
+     * @param isOverridingFaceMaterials Use the material for every triangle, even those that have their own.
+     */
+    Mesh(const glm::vec3 &position, const glm::vec3 &eulerRotation, const glm::vec3 &scale,
+         const actorLightingMaterial &material, const MeshAsset &asset, bool isOverridingFaceMaterials=false);
+
+    ~Mesh() override = default;
+
+    hitInfo isIntersecting(const Ray &ray) override;
+
+    bool quickIsIntersecting(const Ray &ray) override;
+
+    aabb getBounds() const override;
+
+    void rasterize(rasterPrimitives &primitives) const override;
+
+    hitInfo isIntersectingPrimitive(const Ray &ray, std::uint32_t primitive) override;
+
+    void update(float deltaTime) override;
+
+    void commit() override;
+
+protected:
+    const MeshAsset *mAsset;
+    bool mIsOverridingFaceMaterials;
+
+    /** Everything needed to move rays in and out of object space. */
+    struct transformData
+    {
+        glm::mat4 worldToObject;
+        glm::mat4 objectToWorld;
+
+        /** The inverse transpose of the object to world matrix. */
+        glm::mat3 normalToWorld;
+    };
+
+    /** Calculated by update(). */
+    transformData mNextTransform;
+
+    /** What the renderer intersects against. Copied from mNextTransform by commit(). */
+    transformData mTransform;
+
+    /** Builds the matrices from the position, rotation and scale and writes them to mNextTransform. */
+    void calculateTransform();
+
+    /** @returns What the world space ray hit, where distance along it is on the triangle. */
+    hitInfo getHit(const Ray &ray, std::size_t triangle, float distance) const;
+};
+
+
+#endif //A2MCGRAYTRACER_MESH_H
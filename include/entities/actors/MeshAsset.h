@@ -0,0 +1,181 @@
+/**
+ * @file MeshAsset.h
+ * @brief The triangles of a mesh along with a tree over them, shared by every instance of the mesh.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_MESHASSET_H
+#define A2MCGRAYTRACER_MESHASSET_H
+
+#include "Bvh.h"
+#include "ClusterCache.h"
+#include "LightingMaterials.h"
+
+#include "glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * The vertices and indices of a mesh. The mesh does not own them, they usually live in a
+ * mapped scene file or a buffer shared between meshes.
+ */
+struct meshView
+{
+    /** Positions in object space. */
+    const glm::vec3     *positions;
+    std::size_t         vertexCount;
+
+    /** Three indices into positions per triangle. */
+    const std::uint32_t *indices;
+    std::size_t         triangleCount;
+
+    /** One per triangle, indexing into the materials of the mesh. Can be null if every triangle uses the same one. */
+    const std::uint32_t *materialIds;
+};
+
+/**
+ * The triangles of a mesh along with a tree over them (the bottom level of the scene's acceleration structure).
+ * Everything is in object space, so any number of Mesh instances can share a single asset.
+ * @paragraph Assets can be compacted to take up a fraction of the memory. Rays are intersected against the
+ * compacted triangles exactly, so only the triangles themselves move slightly.
+ * @paragraph Assets can also be paged out for scenes that don't fit in memory. Only a tree over the clusters
+ * stays in memory, the triangles and the trees over them live in a ClusterCache.
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 19/10/2026]
+ */
+class MeshAsset
+{
+public:
+    /**
+     * Builds the tree over the triangles straight away.
+     * @param faceMaterials The materials that the material ids of the view index into.
+     */
+    explicit MeshAsset(const meshView &view, const std::vector<actorLightingMaterial> &faceMaterials={});
+
+    /**
+     * Copies the triangles into the compact form so that whatever the view points at can be freed.
+     * Positions are quantised to 16 bits across the bounds of the mesh, face normals are octahedral encoded and
+     * face materials are referenced by a 16 bit index into a table without duplicates.
+     * @returns False if the asset can't be compacted (too many distinct materials), it's left as it was.
+     */
+    bool compact();
+
+    /**
+     * Moves the triangles and the tree over them into page sized clusters in the cache, which must outlive
+     * the asset. Whatever the view points at can be freed afterwards.
+     * @paragraph Rays that reach clusters that aren't resident don't hit anything in them, the cache marks
+     * them as deferred so that they can be traced again once the clusters are paged in.
+     */
+    void pageOut(ClusterCache &cache);
+
+    /**
+     * Finds the closest triangle that the object space ray hits.
+     * @param distance How far along the direction the hit is. Nothing further than its starting value is hit.
+     * @param stopAtFirst Returns the first hit found rather than the closest.
+     * @returns The index of the triangle or -1 if nothing was hit.
+     */
+    long long findClosestTriangle(const glm::vec3 &origin, const glm::vec3 &direction, float &distance,
+                                  bool stopAtFirst) const;
+
+    /**
+     * Tests the object space ray against a single triangle. Can't be used once the asset is paged out.
+     * @param distance Set to how far along the direction the hit is.
+     * @returns True if the ray hits the triangle.
+     */
+    bool isIntersectingTriangle(std::size_t triangle, const glm::vec3 &origin, const glm::vec3 &direction,
+                                float &distance) const;
+
+    /**
+     * @returns The three object space corners of the triangle from whichever form the triangles are in.
+     * Can't be used once the asset is paged out.
+     */
+    void getTriangle(std::size_t triangle, glm::vec3 (&corners)[3]) const;
+
+    /** @returns The object space normal of the triangle. Not normalised. */
+    glm::vec3 getFaceNormal(std::size_t triangle) const;
+
+    /** @returns The material of the triangle or null if it doesn't have one. */
+    const actorLightingMaterial *getFaceMaterial(std::size_t triangle) const;
+
+    const aabb &getBounds() const
+    {
+        return mBounds;
+    }
+
+    std::size_t getTriangleCount() const
+    {
+        return mView.triangleCount;
+    }
+
+    bool isCompact() const
+    {
+        return mIsCompact;
+    }
+
+    bool isPagedOut() const
+    {
+        return mPages != nullptr;
+    }
+
+    /** How much memory the triangles take up, whether or not the asset owns them or they're paged out. */
+    std::size_t getGeometryBytes() const;
+
+    /** How much memory the tree, materials and compacted triangles are using. */
+    std::size_t getBytesUsed() const;
+
+protected:
+    meshView mView;
+    std::vector<actorLightingMaterial> mFaceMaterials;
+    Bvh mTree;
+    aabb mBounds;
+
+    bool mIsCompact { false };
+
+    /** The triangles once they've been compacted. The view isn't used after that. */
+    struct compactGeometry
+    {
+        /** Each axis goes from 0 at the minimum of the bounds to 65535 at the maximum. */
+        std::vector<std::uint16_t>  positions;
+        glm::vec3                   origin;
+        glm::vec3                   step;
+
+        /** Only one of these is used. Short indices are used when there are few enough vertices. */
+        std::vector<std::uint16_t>  shortIndices;
+        std::vector<std::uint32_t>  indices;
+
+        /** One octahedral encoded normal per triangle. */
+        std::vector<std::uint32_t>  normals;
+
+        /** One per triangle indexing into the face materials, or empty if no triangle has one. */
+        std::vector<std::uint16_t>  materialIds;
+    };
+    compactGeometry mCompact;
+
+    /** Set once the asset has been paged out. mTree is over the clusters from then on. */
+    ClusterCache *mPages { nullptr };
+    std::uint32_t mFirstCluster { 0 };
+    std::size_t mPagedBytes { 0 };
+
+    /** The most triangles in a cluster. About 64KB with the tree. */
+    static const std::uint32_t trianglesPerCluster = 1024;
+
+    /** Used in place of a material id by triangles that don't have a material. */
+    static const std::uint16_t noMaterial = 0xFFFF;
+
+
+    std::uint32_t getIndex(std::size_t index) const;
+
+    glm::vec3 getCompactPosition(std::uint32_t vertex) const;
+
+    /** @returns The index of the triangle's face material or noMaterialId if it doesn't have one. */
+    std::uint32_t getMaterialId(std::size_t triangle) const;
+};
+
+
+#endif //A2MCGRAYTRACER_MESHASSET_H
@@ -29,16 +29,30 @@ public:
 
     Sphere(const glm::vec3 &position, const actorLightingMaterial &lightingMaterial, const float &radius);
 
+    /** A sphere that bobs up and down in place, so it's never static. */
+    Sphere(const glm::vec3 &position, const actorLightingMaterial &lightingMaterial, const float &radius,
+           float amplitude, float frequency);
+
     ~Sphere() override = default;
 
     void update(float deltaTime) override;
+    void commit() override;
     hitInfo isIntersecting(const Ray &ray) override;
 
     bool quickIsIntersecting(const Ray &ray) override;
 
+    aabb getBounds() const override;
+
+    void rasterize(rasterPrimitives &primitives) const override;
+
+    hitInfo isIntersectingPrimitive(const Ray &ray, std::uint32_t primitive) override;
+
 protected:
     float mRadius;
 
+    /** Where the renderer sees the centre of the sphere. Copied from mPosition by commit(). */
+    glm::vec3 mCentre;
+
 private:
     void init();
 
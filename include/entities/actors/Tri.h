@@ -23,10 +23,11 @@
 #include "GLM/gtx/quaternion.hpp"
 #include "GLM/vec3.hpp"
 
+#include <memory>
+
 struct vertex
 {
     glm::vec3 position;
-    glm::vec3 globalPosition;
     actorLightingMaterial material;
 
     explicit vertex(const glm::vec3 &position) : position(position)
@@ -54,24 +55,48 @@ public:
 
     bool quickIsIntersecting(const Ray &ray) override;
 
+    aabb getBounds() const override;
+
+    void rasterize(rasterPrimitives &primitives) const override;
+
+    hitInfo isIntersectingPrimitive(const Ray &ray, std::uint32_t primitive) override;
+
     void update(float deltaTime) override;
 
+    void commit() override;
+
 protected:
-    vertex mVertices[3];
-    glm::vec3 mSurfaceNormal;
+    /** Object space positions of the vertices. */
+    glm::vec3 mVertexPositions[3];
 
-    void transformVertices();
-    bool mUseVertexMaterial;
+    /** The material of each vertex. Null unless the vertex materials are used, which is rare. */
+    std::unique_ptr<actorLightingMaterial[]> mVertexMaterials;
 
     // coord pair used when calculating point in triangle. Defaults to x-y
     enum mUseCoordPair { Xy, Xz, Yz };
-    int mOrientation{ Xy };
 
-    // Lengths used for is intersecting function.
-    float s1, s2, s3, s4;
-    float mW1Denominator;
+    /** Everything the intersection test needs in world space. */
+    struct collisionData
+    {
+        glm::vec3 globalPositions[3];
+        glm::vec3 surfaceNormal;
+        int orientation{ Xy };
+
+        // Lengths used for is intersecting function.
+        float s1, s2, s3, s4;
+        float w1Denominator;
+    };
+
+    /** Calculated by update(). */
+    collisionData mNextCollision;
+
+    /** What the renderer intersects against. Copied from mNextCollision by commit(). */
+    collisionData mCollision;
+
+    /** Transforms the vertices into world space and writes the result to mNextCollision. */
+    void transformVertices();
 
-    void constructCollisionEdges();
+    void constructCollisionEdges(collisionData &collision);
 
     /** Mixes between mat1 and mat2 by alpha. */
     static actorLightingMaterial mix(const actorLightingMaterial &mat1,
@@ -11,142 +11,57 @@
 #ifndef A2MCGRAYTRACER_RAYTRACER_H
 #define A2MCGRAYTRACER_RAYTRACER_H
 
-#include "Camera.h"
-#include "Sphere.h"
-#include "Tri.h"
-#include "Entity.h"
-#include "LightSource.h"
-#include "SceneGenerator.h"
+#include "RenderCore.h"
 
 #include "MCG_GFX_Lib.h"
 #include "SDL.h"
 
-#include <memory>
+#include <mutex>
+#include <string>
 #include <vector>
-#include <iostream>
 
 /**
- * The renderer the displays the world to the screen.
+ * The renderer the displays the world to the screen. Opens a window with MCG, draws each frame into it as the
+ * tiles finish and handles the keyboard. Everything else is done by RenderCore.
  * @author Ryan Purse
  * @version 1.0.0 [Initial Version: 18/03/2021]
  */
-class RayTracer
+class RayTracer : public RenderCore
 {
 public:
-    explicit RayTracer(const glm::ivec2 &mWindowSize);
+    /**
+     * @param sceneFiles Compiled scene files that can be switched to with the keys '4' to '9' after the built in
+     * scenes. The first one is loaded straight away. Stress scene descriptions can be used in place of files.
+     * @see parseStressParameters()
+     * @param options Used for every scene that gets loaded.
+     */
+    explicit RayTracer(const glm::ivec2 &mWindowSize, const std::vector<std::string> &sceneFiles={},
+                       const loadOptions &options={}, const rendererOptions &renderer={});
+    ~RayTracer() override;
 
     void run();
     void updateAndHold();  // Unused.
 
 protected:
     void event();
-    void update();
-    void render();
-
-    /**
-     * Changes the items in the world to the specified scene requested by either index or by name
-     * (in enum lvl::[TheNameOfTheScene]). Throws an error if no such scene exists.
-     * @see SceneGenerator.h
-     * @param index The number of name (enum) of scene that you want to load.
-     */
-    void changeScene(unsigned int index);
-
-    /**
-     * Tracers an "origin" ray into world space until all
-     * energy is lost or the ray reaches the max bounce limit.
-     * @param originRay
-     * @return A colour for the specified ray.
-     */
-    glm::vec3 trace(Ray &originRay);
 
     /**
-     * Casts shadow rays to each light source in the scene.
-     * Additionally, it reflects the ray depending of the surface it hit.
-     * @param hitInfo
-     * @return The colour of an object at the hit position.
+     * SDL event watch that adds every event to mHeldEvents of the ray tracer passed in. It can be called from
+     * whichever thread pushed the event, such as an SDL timer or hotplug thread.
      */
-    glm::vec3 traceShadows(Ray &ray, const hitInfo &hit);
-
-    /**
-     * Traces a ray towards a light source.
-     * @param ray A ray towards said light source
-     * @param lightSource The light source you're targeting.
-     * @return True if it managed to get clear line of sight to the light source.
-     */
-    bool traceToLightSource(const Ray &ray, const LightSource *lightSource);
-
-    /**
-     * Reflects the ray based on the surface it hit.
-     * @param ray The ray that you want to modify.
-     * @param hit The surface that the ray hit.
-     */
-    static void reflectRay(Ray &ray, const hitInfo &hit);
-
-    /**
-     * Gets the closest object to the ray's origin.
-     * If no object was hit, the default diffuse is the 'skybox'.
-     * @param ray
-     * @return Information about what was hit.
-     */
-    hitInfo getHitInWorld(const Ray &ray);
-
-    /**
-     * Same as getHitInWorld but only returns if there was a hit or not.
-     * It will immediately exit upon finding a hit.
-     * @param ray
-     * @return True if it hit an object.
-     */
-    bool quickGetHitInWorld(const Ray &ray);
-
-    /***
-     * Returns a colour of the 'skybox' based the on the direction of a ray.
-     * @param rayDirection
-     * @return
-     */
-    glm::vec3 sampleSkybox(glm::vec3 rayDirection);
-
-    /** The Camera in which the Rays are generated from. */
-    Camera *mMainCamera {};
-
-    /** All entities within the world. Cameras, Actors, lights, etc. */
-    std::vector<Entity*> mEntities;
-
-    std::vector<Actor*> mActors;
-    std::vector<LightSource*> mLights;
-    glm::ivec2 mWindowSize;
-
-    // Skybox Colours.
-
-    /** The colour of the ground below the horizon */
-    glm::vec3 mGroundColour { 0.408f, 0.380f, 0.357f };
-
-    /** The colour of the horizon */
-    glm::vec3 mHorizonColour { 0.482f, 0.937f, 0.976f };
-
-    /** The colour of the sky towards the bottom. */
-    glm::vec3 mSkyBottomColour { 0.008f, 0.725f, 1.f };
-
-    /** The colour of the sky when looking directly up */
-    glm::vec3 mSkyTopColour { 0.f, 0.059f, 0.486f };
-
-    const float mSkyBottomAngle { 0.08f };
+    static int SDLCALL holdEvent(void *rayTracer, SDL_Event *sdlEvent);
 
-    // Channels
-    bool mShowAmbient;
-    bool mShowDiffuse;
-    bool mShowSpecular;
-    bool mShowSkybox;
+    /** Draws every tile of the shown view that has changed since the last call to the MCG pixel buffer. */
+    void present();
 
-    /** The bounce limit the program is at for the current frame */
-    int mBounceLimit{ 1 };
+    /** Converts a packed colour back so that mcg::drawPixel() gives the exact same 8-bit value. */
+    static glm::vec3 unpackColour(std::uint32_t colour);
 
-    /** The absolute bounce limit the program can go to. */
-    int mMaxBounceLimit{ 5 };
+    /** Every event since the last call to event(). Guarded by mHeldEventsLock. */
+    std::vector<SDL_Event> mHeldEvents;
+    std::mutex mHeldEventsLock;
 
-    // Information & user input
-    unsigned int mFrameCount{ 0 };
     bool mIsRunning{ true };
-    unsigned int mCurrentScene{ 999 };
 };
 
 
@@ -0,0 +1,731 @@
+/**
+ * @file RenderCore.h
+ * @brief Renders scenes into memory. Everything about the renderer except for the window, so it can be embedded.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 18/03/2021
+ */
+
+
+#ifndef A2MCGRAYTRACER_RENDERCORE_H
+#define A2MCGRAYTRACER_RENDERCORE_H
+
+#include "Camera.h"
+#include "Sphere.h"
+#include "Tri.h"
+#include "Entity.h"
+#include "LightSource.h"
+#include "SceneGenerator.h"
+#include "VisibilityBuffer.h"
+#include "Environment.h"
+
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <limits>
+
+/** How much adaptive anti-aliasing can spend on a frame. @see RenderCore::antiAlias() */
+struct antiAliasingOptions
+{
+    bool isEnabled { true };
+
+    /** The number of extra rays that can be traced each frame, as a fraction of the pixel count. */
+    float sampleBudget { 0.25f };
+
+    /**
+     * Sub-pixel samples are stratified over a grid of this size, one quadrant at a time, so it has to be even. Odd
+     * sizes are rounded up and anything below 2 is taken as 2. 4 allows for up to 16 samples.
+     */
+    int gridSize { 4 };
+
+    /** How different a pixel has to be from one of its neighbours before it gets super sampled. */
+    float contrastThreshold { 0.1f };
+
+    /** Super sampling a pixel stops once the variance of its mean colour is below this. */
+    float varianceThreshold { 0.0005f };
+};
+
+/** Changes how the renderer itself runs, rather than the scenes it loads. */
+struct rendererOptions
+{
+    /** The number of threads that render each frame. 0 uses one per hardware thread. */
+    unsigned int threadCount { 0 };
+
+    /**
+     * Finds what every camera ray hits first by rasterising the scene into a visibility buffer, so that only the
+     * rays after the first hit go through the trees. Pixels where rounding might have picked the wrong surface are
+     * traced instead, but a handful of pixels along triangle edges can still differ from the traced image.
+     * Ignored for scenes that are paged out of core.
+     */
+    bool isRasterizingVisibility { false };
+
+    /** An HDR image that rays see in place of the procedural sky. @see Environment::load() */
+    std::string environmentPath;
+
+    /** Where the first scene and environment are reported while the renderer is constructed. @see RenderCore::setLog() */
+    std::ostream *log { nullptr };
+
+    /**
+     * The most reflected and refracted rays that a single camera ray can branch into. Glass splits every ray in
+     * two at each surface, so this is what keeps the cost of a pixel bounded rather than the bounce limit alone.
+     */
+    int rayBudget { 64 };
+
+    /**
+     * Branches that would carry less than this much energy in every channel aren't traced. The default is half
+     * of an 8 bit step, so nothing that's pruned could have brightened the pixel by more than that.
+     */
+    float energyThreshold { 1.f / 512.f };
+
+    antiAliasingOptions antiAliasing;
+};
+
+/** How copyImage() lays out each pixel. The 8 bit formats are the image as it's shown, clamped and truncated. */
+enum pixelFormat
+{
+    Rgb8,
+    Rgba8,
+    Bgra8,
+
+    /** Three floats of what was traced for each pixel, before it's clamped. Heatmaps aren't shown in it. */
+    RgbFloat
+};
+
+/**
+ * Renders scenes into memory without a window, and without SDL or MCG, so that it can be embedded into other
+ * programs. The frame is pipelined the same way whatever drives it: the update for the next frame runs alongside
+ * the render of this one. RayTracer puts it in a window.
+ * @paragraph Instances share nothing, so any number of them can render at once, each with its own thread pool.
+ * The one exception is the profiler of an A2_PROFILING build, which is shared by the process: it only profiles
+ * while a single instance exists and pauses while there are more. @see profiling::endFrame()
+ * Every public function that changes or reads the renderer locks it first, so an instance can be driven from
+ * whichever thread a scheduler picks, and a call made while another thread is rendering waits for the frame.
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 18/03/2021]
+ */
+class RenderCore
+{
+public:
+    /**
+     * @param mWindowSize The resolution of every frame, and of the cameras that can be rendered.
+     * @param sceneFiles Compiled scene files that can be switched to after the built in scenes. The first one is
+     * loaded straight away. Stress scene descriptions can be used in place of files. @see parseStressParameters()
+     * @param options Used for every scene that gets loaded.
+     */
+    explicit RenderCore(const glm::ivec2 &mWindowSize, const std::vector<std::string> &sceneFiles={},
+                        const loadOptions &options={}, const rendererOptions &renderer={});
+    virtual ~RenderCore();
+
+    /** The rays traced in a frame by what they were traced for. */
+    struct rayCounts
+    {
+        /** From the camera, including anti-aliasing samples. */
+        std::uint64_t primary;
+
+        /** Towards a light source. */
+        std::uint64_t shadow;
+
+        /** Every bounce after the first hit. */
+        std::uint64_t reflection;
+
+        /** Through transparent surfaces. */
+        std::uint64_t refraction;
+
+        /** Branches that weren't traced because they were too dim or went over the ray budget. */
+        std::uint64_t pruned;
+    };
+
+    /** A cost of each pixel that can be shown as a false colour heatmap in place of the image. */
+    enum heatmap
+    {
+        NoHeatmap,
+
+        /** Tree nodes entered by every ray traced for the pixel, across the scene and mesh trees. */
+        TraversalSteps,
+
+        /** Actors and triangles tested by every ray traced for the pixel. */
+        PrimitiveTests,
+
+        ShadowRays,
+
+        /** How many surfaces the camera ray hit. Scaled to the bounce limit rather than the worst pixel. */
+        BounceDepth,
+
+        /** Microseconds spent tracing the pixel. */
+        PixelTime,
+
+        NumberOfHeatmaps
+    };
+
+    /**
+     * Loads the scene (by the same index as changeScene()) and swaps to it straight away, rather than in the
+     * background like changeScene().
+     * @returns False if the scene couldn't be loaded (which is logged) or doesn't exist. The current scene is kept
+     * in that case.
+     */
+    bool loadSceneNow(unsigned int index);
+
+    /**
+     * The same as above for a compiled scene file or a stress scene description, which is added to the end of
+     * the scene files.
+     */
+    bool loadSceneNow(const std::string &path);
+
+    /**
+     * Moves every dynamic entity on by a number of fixed updates without rendering anything. The next frame
+     * renders them from wherever they end up.
+     */
+    void advance(int updates=1);
+
+    /**
+     * @param view By the order they were selected in. @see setViews()
+     * @returns What the view would put on screen, packed as 0xRRGGBB. Row major. Only valid between frames.
+     */
+    std::vector<std::uint32_t> getImage(unsigned int view=0) const;
+
+    /** Updates, renders and finishes a single frame without presenting it. */
+    void renderFrame();
+
+    /** The same as above, then copies the view into pixels. @see copyImage() */
+    bool renderFrame(void *pixels, std::ptrdiff_t rowStride, pixelFormat format, unsigned int view=0);
+
+    /**
+     * Converts what the view would put on screen straight into memory that the caller owns. Only valid between
+     * frames, which the lock makes sure of.
+     * @param pixels The top left pixel of an image the size of the window.
+     * @param rowStride The bytes from the start of one row to the next. Negative for images stored bottom up.
+     * @returns False (without writing anything) if the view isn't rendered or a row doesn't fit in the stride.
+     */
+    bool copyImage(void *pixels, std::ptrdiff_t rowStride, pixelFormat format, unsigned int view=0) const;
+
+    /** @returns The size of a pixel in the format in bytes. */
+    static std::size_t getPixelSize(pixelFormat format);
+
+    /** Fixes the bounce limit rather than raising it by one each frame up to the maximum. */
+    void setBounceLimit(int bounceLimit);
+
+    /**
+     * Shows a cost of each pixel in place of the image from the next frame on, from blue for nothing up to red
+     * for the 99th percentile of the frame (or the bounce limit). Anti-aliasing is skipped while a heatmap is shown.
+     */
+    void setHeatmap(heatmap channel);
+
+    heatmap getHeatmap() const
+    {
+        std::lock_guard<std::recursive_mutex> lock(mLock);
+        return mHeatmap;
+    }
+
+    static const char *getHeatmapName(heatmap channel);
+
+    /** @returns The cost that the last finished frame showed as red, in the units of its heatmap. */
+    float getLastHeatmapMax() const
+    {
+        std::lock_guard<std::recursive_mutex> lock(mLock);
+        return mLastHeatmapMax;
+    }
+
+    /**
+     * Writes what the view would put on screen as a binary PPM image. Only valid between frames.
+     * @returns False if the file couldn't be written.
+     */
+    bool writeImage(const std::string &path, unsigned int view=0) const;
+
+    /**
+     * Prints the statistics of every frame, the memory and imports of every scene and why anything couldn't be
+     * loaded there. Null (the default) prints nothing.
+     */
+    void setLog(std::ostream *log);
+
+    /**
+     * Renders the scene's cameras (by their index in scene::cameras) from the next frame on, rather than only
+     * the main camera. Every view shares the frame's update, acceleration structures and lights, and the tiles of
+     * all of them are handed to the thread pool together. Cameras that don't exist in the current scene or that
+     * render at a different resolution to the window are skipped. Empty goes back to the main camera.
+     */
+    void setViews(const std::vector<unsigned int> &cameras);
+
+    /** Renders every camera in whichever scene is loaded from the next frame on. @see setViews() */
+    void setAllViews();
+
+    /** @returns How many views the last started frame renders. */
+    unsigned int getViewCount() const
+    {
+        std::lock_guard<std::recursive_mutex> lock(mLock);
+        return static_cast<unsigned int>(mViews.size());
+    }
+
+    /** Picks which of the views is printed about and shown in a window. Clamped to the views that are rendered. */
+    void setShownView(unsigned int view);
+
+    /** Turns the visibility pass on or off from the next frame on. @see rendererOptions::isRasterizingVisibility */
+    void setRasterizingVisibility(bool isRasterizing);
+
+    bool isRasterizingVisibility() const
+    {
+        std::lock_guard<std::recursive_mutex> lock(mLock);
+        return mIsRasterizingVisibility;
+    }
+
+    /** Bakes a procedural sky that replaces the environment from the next frame on. */
+    void setSkyColours(const skyColours &sky);
+
+    /**
+     * Maps an HDR image that replaces the environment from the next frame on.
+     * @param error If not null, set to why the image can't be used. It's logged either way.
+     * @returns False if it can't be used, in which case the environment stays the same.
+     */
+    bool setEnvironment(const std::string &path, std::string *error=nullptr);
+
+    /** @returns How long the last finished frame took, measured from the end of the frame before. */
+    double getLastFrameSeconds() const
+    {
+        std::lock_guard<std::recursive_mutex> lock(mLock);
+        return mLastFrameSeconds;
+    }
+
+    /** @returns How many rays the last finished frame traced. */
+    rayCounts getLastFrameRays() const
+    {
+        std::lock_guard<std::recursive_mutex> lock(mLock);
+        return mLastFrameRays;
+    }
+
+    /** Not locked, so only use it between frames on the thread that drives the renderer. */
+    const scene &getScene() const
+    {
+        return mScene;
+    }
+
+    unsigned int getThreadCount() const
+    {
+        return mThreadPool.getThreadCount();
+    }
+
+protected:
+    void update();
+
+    /** Makes the results of the last update() visible to the renderer. Nothing can be rendering when called. */
+    void commit();
+
+    /**
+     * Renders a whole frame into the frame buffer, splitting it into tiles across the thread pool.
+     * Stops early if the frame gets cancelled.
+     */
+    void render();
+
+    /**
+     * Starts rendering the world as it was left by the last update() in the background. The update for the frame
+     * after is then started alongside it, so the cost of updating is hidden behind rendering.
+     */
+    void startFrame();
+
+    /** Prints how long the frame took (if there's a log) and raises the bounce limit for the next one. */
+    void finishFrame();
+
+    /** Prints the statistics of the frame that just finished on a single line. */
+    void printFrame(std::ostream &log);
+
+    /**
+     * Stops the frame that is being rendered in the background (if any) and waits for it along with the update
+     * that is running alongside it. Every tile checks for cancellation before it starts, so this only waits for
+     * the tiles in flight.
+     */
+    void cancelFrame();
+
+    /**
+     * Works out which cameras the next frame renders from the views that were asked for and resizes the per view
+     * buffers to match. Nothing can be rendering when called.
+     */
+    void selectViews();
+
+    /**
+     * Traces one ray for every block of blockSize x blockSize pixels and fills the whole block with its colour.
+     * Samples that were already traced by a coarser pass (every other block in both axes) are reused rather than
+     * traced again, so refining from 16x16 down to 1x1 costs the same number of rays as a single full pass.
+     * @param blockSize The width and height of a block in pixels. Should be a power of two.
+     * @param isFirstPass True if no coarser pass has been traced for this frame.
+     */
+    void renderPass(int blockSize, bool isFirstPass);
+
+    /** Rasterises the visibility buffer of every view. */
+    void renderVisibility();
+
+    /**
+     * The part of renderPass() that covers a single tile.
+     * @param tileIndex The tiles of every view are interleaved, so this is the tile's index times the view count
+     * plus the view.
+     */
+    void renderTile(int tileIndex, int blockSize, bool isFirstPass);
+
+    /**
+     * Traces a single pixel of a view and writes it to the block that starts at it. A block size of 0 only writes
+     * the frame buffer, leaving the display to the caller.
+     * @returns False (without writing anything) if the ray needed a cluster that isn't resident.
+     */
+    bool renderPixel(unsigned int view, const glm::ivec2 &pixelPosition, int blockSize);
+
+    /** The same as above with the camera's ray for the pixel already generated. @see Camera::generateRow() */
+    bool renderPixel(unsigned int view, const glm::ivec2 &pixelPosition, int blockSize, Ray ray);
+
+    /**
+     * Rebuilds what the camera ray of the pixel hits first from the visibility buffer of the view. Rounding at the
+     * edges of triangles can hand a pixel a primitive that its ray misses or doesn't reach first, or leave a crack
+     * between two of them, in which case it has to be traced through the trees instead.
+     * @param hit Set to what the ray hits (or a miss), only valid when it returns true.
+     * @returns False if the visibility buffer can't be trusted for the pixel.
+     */
+    bool isVisibleHit(unsigned int view, const glm::ivec2 &pixelPosition, const Ray &ray, hitInfo &hit) const;
+
+    /**
+     * Pages in the clusters that deferred pixels asked for and traces them again, as many times as it takes.
+     * Every pixel that is deferred again asks for more of what it needs, so this always finishes.
+     */
+    void renderDeferred(int blockSize);
+
+    /**
+     * Writes a single colour to every pixel in the view's block starting at pixelPosition.
+     * The block is clipped to the window.
+     */
+    void fillBlock(unsigned int view, const glm::ivec2 &pixelPosition, int blockSize, const glm::vec3 &colour);
+
+    /** Adds the rays that the calling thread has traced to the frame's totals. Called at the end of every job. */
+    void flushRayCounts();
+
+    /**
+     * Writes a single cost to every pixel in the view's block starting at pixelPosition.
+     * The block is clipped to the window.
+     */
+    void fillCost(unsigned int view, const glm::ivec2 &pixelPosition, int blockSize, float cost);
+
+    /** Replaces the whole display buffer of every view with the frame's cost buffer in false colour. */
+    void showHeatmap();
+
+    /** @param value From 0 (blue) through cyan, green and yellow to 1 (red). */
+    static glm::vec3 heatColour(float value);
+
+    /** Lets present() know that a tile of a view has something new to draw. */
+    void markDirty(unsigned int view, const glm::ivec2 &pixelPosition);
+
+    /** @returns Where the view's pixel is in the frame, display and cost buffers. */
+    int getPixelIndex(unsigned int view, const glm::ivec2 &pixelPosition) const
+    {
+        return static_cast<int>(view) * mPixelsPerView + pixelPosition.y * mWindowSize.x + pixelPosition.x;
+    }
+
+    /**
+     * Adaptive anti-aliasing. Finds the pixels with the highest contrast against their neighbours and spends
+     * extra sub-pixel samples on them (highest contrast first) until the sample budget for the frame runs out.
+     * Every view gets a budget of its own. Requires a fully traced frame buffer.
+     * @paragraph The budget is handed out before any rays are traced so that the result doesn't depend on
+     * the order that the threads finish in.
+     */
+    void antiAlias();
+
+    /**
+     * Traces stratified sub-pixel samples over the pixel's footprint in batches of four (one per quadrant).
+     * Stops early once the variance of the mean colour drops below mAaVarianceThreshold.
+     * @param pixelPosition The pixel of the view to super sample.
+     * @param pixelSample The colour already traced through the centre of the pixel, which counts as a sample.
+     * @param maxSamples The most rays that can be traced for this pixel. Must be at least 4.
+     * @return The average colour of the pixel's sample and all the sub-pixel samples.
+     */
+    glm::vec3 superSample(unsigned int view, const glm::ivec2 &pixelPosition, const glm::vec3 &pixelSample,
+                          int maxSamples);
+
+    /** Converts a colour to 8-bit RGB the same way that mcg::drawPixel() does. */
+    static std::uint32_t packColour(const glm::vec3 &colour);
+
+    /** The largest difference between any channel of the two colours after they have been clamped for display. */
+    static float colourDifference(const glm::vec3 &a, const glm::vec3 &b);
+
+    /** @returns The scene by the same index as changeScene(). Safe to call from any thread. */
+    static scene loadSceneAt(const glm::ivec2 &screenSize, unsigned int index, const std::string &path,
+                             const loadOptions &options);
+
+    /** Deterministic hash of seed and index into [0, 1). Keeps sub-pixel jitter stable from frame to frame. */
+    static float randomFloat(unsigned int seed, unsigned int index);
+
+    /**
+     * Changes the items in the world to the specified scene requested by either index or by name
+     * (in enum lvl::[TheNameOfTheScene]). The scene is loaded in the background and the current
+     * scene keeps rendering until it's ready. @see updateScene()
+     * @see SceneGenerator.h
+     * @param index The number of name (enum) of scene that you want to load.
+     */
+    void changeScene(unsigned int index);
+
+    /**
+     * Swaps to the requested scene once it has finished loading and starts loading
+     * the requested scene if it isn't already. Called once per display frame.
+     */
+    void updateScene();
+
+    /**
+     * Cancels the frame in flight and replaces the current scene with level. The old scene is
+     * freed in the background. Throws an error if the scene failed to load.
+     */
+    void swapScene(scene level);
+
+    /** Frees the scene on another thread so that the display isn't held up by it. */
+    void unloadInBackground(scene level);
+
+    /**
+     * Tracers an "origin" ray into world space until all
+     * energy is lost or the ray reaches the max bounce limit.
+     * @param originRay
+     * @return A colour for the specified ray.
+     */
+    glm::vec3 trace(Ray &originRay);
+
+    /** The same as above where what the ray hits first is already known. @see VisibilityBuffer */
+    glm::vec3 trace(Ray &originRay, const hitInfo &firstHit);
+
+    /**
+     * The part of trace() that follows the ray on from the first hit. Reflections and refractions are pushed onto
+     * a work stack for the thread rather than recursed into, so the ray tree is walked depth first with the
+     * brighter branch first, until the bounce limit, the energy threshold or the ray budget stops it.
+     */
+    glm::vec3 tracePath(Ray &originRay, const hitInfo &firstHit);
+
+    /**
+     * Casts shadow rays to each light source in the scene.
+     * Additionally, it reflects the ray depending of the surface it hit.
+     * @param hitInfo
+     * @return The colour of an object at the hit position.
+     */
+    glm::vec3 traceShadows(Ray &ray, const hitInfo &hit);
+
+    /**
+     * Adds the Blinn-Phong diffuse and specular light from a single light source that the hit can see.
+     * @param ray The ray that hit the surface, before it was reflected.
+     * @param rayToLight From the hit towards the light.
+     * @param lightInfo The light that reaches the hit. @see LightSource::getInfo()
+     */
+    static void shadeLight(const Ray &ray, const hitInfo &hit, const Ray &rayToLight, const lightingMaterial &lightInfo,
+                           glm::vec3 &diffuseColour, glm::vec3 &specularColour);
+
+    /**
+     * Traces a ray towards a light source.
+     * @param ray A ray towards said light source
+     * @param lightSource The light source you're targeting.
+     * @return True if it managed to get clear line of sight to the light source.
+     */
+    bool traceToLightSource(const Ray &ray, const LightSource *lightSource);
+
+    /**
+     * Reflects the ray based on the surface it hit.
+     * @param ray The ray that you want to modify.
+     * @param hit The surface that the ray hit.
+     */
+    static void reflectRay(Ray &ray, const hitInfo &hit);
+
+    /**
+     * Bends the ray through the surface it hit.
+     * @returns False (without changing the ray) if the ray is reflected back inside instead.
+     */
+    static bool refractRay(Ray &ray, const hitInfo &hit);
+
+    /**
+     * Gets the closest object to the ray's origin.
+     * If no object was hit, the default diffuse is the 'skybox'.
+     * @param ray
+     * @return Information about what was hit.
+     */
+    hitInfo getHitInWorld(const Ray &ray);
+
+    /**
+     * Same as getHitInWorld but only returns if there was a hit or not.
+     * It will immediately exit upon finding a hit.
+     * @param ray
+     * @return True if it hit an object.
+     */
+    bool quickGetHitInWorld(const Ray &ray);
+
+    /***
+     * Returns a colour of the 'skybox' based the on the direction of a ray.
+     * @param rayDirection
+     * @return
+     */
+    glm::vec3 sampleSkybox(glm::vec3 rayDirection) const
+    {
+        return mEnvironment.sample(rayDirection);
+    }
+
+    /**
+     * All entities within the world. Cameras, Actors, lights, etc. The Rays are generated from the views' cameras.
+     * Only ever replaced while nothing is rendering.
+     */
+    scene mScene { false };
+
+    glm::ivec2 mWindowSize;
+
+    /** Every view is the size of the window. The per view buffers hold one after the other. */
+    int mPixelsPerView;
+
+    /** The cameras that the frame in flight renders. Only changed while nothing is rendering. */
+    std::vector<Camera*> mViews;
+
+    /** The cameras that were asked for by setViews(). Empty renders the main camera. */
+    std::vector<unsigned int> mRequestedViews;
+
+    /** Set by setAllViews(). Takes the place of mRequestedViews. */
+    bool mIsRenderingAllViews { false };
+
+    /** The view that present() draws. */
+    unsigned int mShownView { 0 };
+
+    /** The view that present() drew last, so that all of a newly shown view gets drawn. */
+    unsigned int mPresentedView { 0 };
+
+    /** The colour traced for each pixel of every view this frame. Row major. Only touched by the render threads. */
+    std::vector<glm::vec3> mFrameBuffer;
+
+    /**
+     * What each view should put on screen, packed the same way as packColour(). Row major.
+     * Written by the render threads and read by present(), so each pixel is atomic.
+     */
+    std::vector<std::atomic<std::uint32_t>> mDisplayBuffer;
+
+    /** The cost of each pixel this frame, in the units of mFrameHeatmap. Only used while a heatmap is shown. */
+    std::vector<float> mCostBuffer;
+
+    /** What the camera rays of each view hit first. Only filled in while the visibility pass is on. */
+    std::vector<VisibilityBuffer> mVisibilityBuffers;
+
+    bool mIsRasterizingVisibility;
+
+    /** Whether the frame in flight uses the visibility buffers. Only changed while nothing is rendering. */
+    bool mIsFrameRasterizing { false };
+
+    // Tiles & threading.
+
+    /** The width and height of a tile in pixels. Must be a multiple of mProgressiveBlockSize. */
+    const int mTileSize{ 32 };
+
+    /** The number of tiles across and down the window. */
+    glm::ivec2 mTileCount;
+
+    /** Set for each tile of every view that has been written to since it was last presented. */
+    std::vector<std::atomic<bool>> mDirtyTiles;
+
+    /** Pixels of the current pass that need clusters that weren't resident. By getPixelIndex(). */
+    std::vector<int> mDeferredPixels;
+    std::mutex mDeferredPixelsLock;
+
+    ThreadPool mThreadPool;
+
+    /** The frame that is rendering in the background. Not valid if no frame is in flight. */
+    std::future<void> mFrameJob;
+
+    /** Checked before each tile is rendered. */
+    std::atomic<bool> mCancelFrame{ false };
+
+    /** The update for the next frame that runs while the current frame is rendering. */
+    std::future<void> mUpdateJob;
+
+    /** The rays traced by the frame in flight so far. @see flushRayCounts() */
+    std::atomic<std::uint64_t> mPrimaryRays { 0 };
+    std::atomic<std::uint64_t> mShadowRays { 0 };
+    std::atomic<std::uint64_t> mReflectionRays { 0 };
+    std::atomic<std::uint64_t> mRefractionRays { 0 };
+    std::atomic<std::uint64_t> mPrunedRays { 0 };
+    rayCounts mLastFrameRays { 0, 0, 0, 0, 0 };
+
+    /** What escaping rays see. Shared by every render thread, so it's only changed while nothing is rendering. */
+    Environment mEnvironment;
+
+    /** Replaces mEnvironment at the start of the next frame. */
+    std::unique_ptr<Environment> mNextEnvironment;
+
+    // Channels
+    bool mShowAmbient;
+    bool mShowDiffuse;
+    bool mShowSpecular;
+    bool mShowSkybox;
+
+    /** The heatmap that the next frame shows. */
+    heatmap mHeatmap { NoHeatmap };
+
+    /** The heatmap of the frame in flight. Only changed while nothing is rendering. */
+    heatmap mFrameHeatmap { NoHeatmap };
+
+    /** The cost shown as red by the frame in flight. */
+    float mHeatmapMax { 0.f };
+    float mLastHeatmapMax { 0.f };
+
+    /** The bounce limit the program is at for the current frame */
+    int mBounceLimit{ 1 };
+
+    /** The absolute bounce limit the program can go to. */
+    int mMaxBounceLimit{ 5 };
+
+    /** @see rendererOptions::rayBudget */
+    int mRayBudget;
+
+    /** @see rendererOptions::energyThreshold */
+    float mEnergyThreshold;
+
+    /**
+     * The block size of the coarsest preview pass traced on the first frame after a scene change.
+     * Each following pass halves the block size until every pixel has been traced. Must be a power of two.
+     */
+    int mProgressiveBlockSize{ 16 };
+
+    // Adaptive anti-aliasing.
+
+    bool mAntiAliasing;
+
+    /** The number of extra rays that anti-aliasing may trace for each view each frame. @see antiAliasingOptions */
+    int mAaSampleBudget;
+    int mAaGridSize;
+    float mAaContrastThreshold;
+    float mAaVarianceThreshold;
+
+    // Information
+
+    unsigned int mFrameCount{ 0 };
+    std::chrono::steady_clock::time_point mLastFrameTime { std::chrono::steady_clock::now() };
+    double mLastFrameSeconds { 0.0 };
+
+    /** @see setLog() */
+    std::ostream *mLog { nullptr };
+
+    /** Held by every public function that changes or reads the renderer. Recursive so that they can call each other. */
+    mutable std::recursive_mutex mLock;
+
+    /** Stops the bounce limit from being raised each frame. */
+    bool mIsBounceLimitFixed { false };
+
+    // Scene loading
+
+    /** The scene that is being rendered. */
+    unsigned int mCurrentScene{ 999 };
+
+    /** The scene that the user asked for last. */
+    unsigned int mRequestedScene{ 999 };
+
+    /** The scene that mSceneJob is loading. */
+    unsigned int mLoadingScene{ 999 };
+
+    /** Scenes after the built in ones are loaded from these files. */
+    std::vector<std::string> mSceneFiles;
+    loadOptions mLoadOptions;
+
+    std::future<scene> mSceneJob;
+    std::future<void> mUnloadJob;
+};
+
+
+#endif //A2MCGRAYTRACER_RENDERCORE_H
@@ -17,6 +17,16 @@
 #include "Actor.h"
 #include "Sphere.h"
 #include "Tri.h"
+#include "Mesh.h"
+#include "SceneArena.h"
+#include "MappedFile.h"
+#include "MeshImporter.h"
+#include "Bvh.h"
+#include "ClusterCache.h"
+
+#include <ostream>
+#include <string>
+#include <vector>
 
 namespace lvl
 {
@@ -34,18 +44,151 @@ namespace lvl
 
         NumberOfScenes
     };
+
+    /** Generated scenes that can be made as large as needed, for measuring how the renderer scales. */
+    enum stressSceneName
+    {
+        /** count randomly placed spheres of random sizes and materials above a floor. */
+        RandomSpheres,
+
+        /** A single mesh made from a count by count grid of quads with random heights (2 triangles per quad). */
+        TriangleGrid,
+
+        /** A mirror room lit by count point lights with depth rings of mirrors nested inside each other. */
+        NestedMirrors,
+
+        /** count spheres and mesh instances, where a dynamic fraction of them bob up and down every frame. */
+        MixedPopulation,
+
+        NumberOfStressScenes
+    };
 }
 
+/**
+ * Which stress scene to generate and how large to make it. Every random choice comes from the seed,
+ * so the same parameters always generate the same scene.
+ */
+struct stressParameters
+{
+    lvl::stressSceneName    name { lvl::RandomSpheres };
+    unsigned int            count { 1000 };
+    unsigned int            depth { 3 };
+    float                   dynamic { 0.f };
+    std::uint32_t           seed { 1 };
+
+    /** The number of cameras. Every one after the main camera circles around the scene. */
+    unsigned int            views { 1 };
+};
+
+/** How long a mesh that a scene imports took to load. */
+struct meshImport
+{
+    std::string                 path;
+    std::size_t                 triangleCount;
+    std::size_t                 bytesRead;
+    double                      seconds;
+};
+
 struct scene
 {
     bool                        success;
+
+    /** Why the scene couldn't be loaded. Empty if it was. */
+    std::string                 error;
+
+    /** Every mesh that was imported while loading, for whoever loaded the scene to print. @see printImports() */
+    std::vector<meshImport>     imports;
+
     Camera                      *mainCamera;
     std::vector<Entity*>        entities;
     std::vector<Camera*>        cameras;
     std::vector<Actor*>         actors;
     std::vector<LightSource*>   lights;
+
+    /** Shared by the Mesh actors. Also owned by the arena. */
+    std::vector<MeshAsset*>     meshAssets;
+
+    /** The entities that aren't static. These are the only ones that get updated each frame. */
+    std::vector<Entity*>        dynamicEntities;
+
+    /** Where the mesh assets are paged out to. Null unless the scene was loaded with a resident budget. */
+    ClusterCache                *pages { nullptr };
+
+    /** Over the bounds of every actor, leaves index into actors. Rays go through this before any actor is tested. */
+    Bvh                         actorTree;
+
+    /** The compiled scene file that the entities were loaded from (if any). Meshes point straight into it. */
+    MappedFile                  file;
+
+    /** The vertices and triangles of every imported mesh. Meshes point straight into it. */
+    meshBuffer                  meshes;
+
+    /** Owns every entity above. Declared after the file so that it's destroyed first. */
+    SceneArena                  arena;
+};
+
+/** Changes how scenes are stored once they're loaded. */
+struct loadOptions
+{
+    /**
+     * Compacts every mesh asset and frees the full size copies of imported meshes.
+     * @see MeshAsset::compact()
+     */
+    bool isCompactingGeometry { false };
+
+    /**
+     * Pages mesh assets out to a file and keeps at most this many bytes of them in memory at once.
+     * 0 keeps everything in memory.
+     * @see MeshAsset::pageOut()
+     */
+    std::size_t residentBudget { 0 };
 };
 
-scene loadScene(const glm::ivec2 &screenSize, unsigned int index=0);
+/**
+ * Creates every entity in the scene inside the scene's arena. Safe to call from any thread since nothing
+ * is shared between scenes.
+ */
+scene loadScene(const glm::ivec2 &screenSize, unsigned int index=0, const loadOptions &options={});
+
+/**
+ * Maps a compiled scene file and creates every entity in it. Meshes use the vertices and
+ * indices in the file where they are, so nothing is parsed or copied. Meshes that come from
+ * OBJ or PLY files are imported into the scene's mesh buffer.
+ * @see SceneFormat.h
+ * @returns A scene that isn't a success (along with why) if the file is missing, isn't a compiled scene or
+ * imports a mesh that can't be read.
+ */
+scene loadSceneFile(const glm::ivec2 &screenSize, const std::string &path, const loadOptions &options={});
+
+/** @returns A scene that isn't a success because of the error. */
+scene failedScene(const std::string &error);
+
+/** @returns True if the path is a stress scene description rather than a file, whether or not it can be read. */
+bool isStressDescription(const std::string &path);
+
+/**
+ * Reads the parameters from a description like "stress:spheres:count=5000,seed=3". The names are
+ * spheres, grid, mirrors and mixed. The keys are count, depth, dynamic, seed and views, any that are missing
+ * keep their default. Count is at most a million (4096 for a grid), depth and views at most 64 and dynamic at
+ * most 1. Everything but dynamic has to be a whole number.
+ * @returns False if the description isn't for a stress scene, can't be read or is past the limits.
+ */
+bool parseStressParameters(const std::string &description, stressParameters &parameters);
+
+/** Generates the stress scene. Safe to call from any thread, like loadScene(). */
+scene loadStressScene(const glm::ivec2 &screenSize, const stressParameters &parameters,
+                      const loadOptions &options={});
+
+/** Destroys every entity in the scene in a single release and leaves it empty. */
+void unloadScene(scene &level);
+
+/** Updates the actor tree after dynamic actors have been committed. */
+void refitActorTree(scene &level);
+
+/** Writes out how much memory each type of entity in the scene is using. */
+void printMemoryUsage(const scene &level, std::ostream &out);
+
+/** Writes out how long each mesh that the scene imported took and how quickly it was read. */
+void printImports(const scene &level, std::ostream &out);
 
 #endif //A2MCGRAYTRACER_SCENEGENERATOR_H
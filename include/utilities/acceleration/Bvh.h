@@ -0,0 +1,234 @@
+/**
+ * @file Bvh.h
+ * @brief A bounding volume hierarchy that finds which items a ray might hit without testing all of them.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_BVH_H
+#define A2MCGRAYTRACER_BVH_H
+
+#include "Geometry.h"
+
+#include "glm.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/**
+ * A bounding volume hierarchy that finds which items a ray might hit without testing all of them.
+ * It only knows about the bounds of each item, so the same tree is used over the triangles of a mesh
+ * and over every actor in a scene.
+ * @paragraph Built top down by splitting on the surface area heuristic. Items that move can be refit without
+ * rebuilding the tree, which is fine as long as they don't move far.
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 19/10/2026]
+ */
+class Bvh
+{
+public:
+    struct node
+    {
+        aabb            bounds;
+
+        /** The first of the two children for interior nodes, or the first item for leaves. */
+        std::uint32_t   leftOrFirst;
+
+        /** 0 for interior nodes. */
+        std::uint32_t   itemCount;
+    };
+
+    /** The work that every traversal on a thread has done. Only ever grows, so compare two reads to measure. */
+    struct traversalCounts
+    {
+        /** Nodes that the ray entered. */
+        std::uint64_t nodes;
+
+        /** Items in the leaves that the ray entered. */
+        std::uint64_t items;
+    };
+
+    /**
+     * Builds the tree from scratch.
+     * @param itemBounds The bounds of every item. Traversal reports items by their index in here.
+     * @param maxLeafSize Nodes with this many items or fewer aren't split any further.
+     */
+    void build(const std::vector<aabb> &itemBounds, unsigned int maxLeafSize=4);
+
+    /** Updates the bounds of every node for items that have moved. There must be the same number of items. */
+    void refit(const std::vector<aabb> &itemBounds);
+
+    /**
+     * Calls hitItem(item, maxDistance) for every item whose node the ray passes through before maxDistance,
+     * nearest nodes first. hitItem can shrink maxDistance to skip anything further away and returns
+     * true to stop the traversal.
+     * @returns True if hitItem stopped the traversal.
+     */
+    template<typename HitItem>
+    bool traverse(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance, HitItem &&hitItem) const
+    {
+        if (mNodes.empty()) { return false; }
+        return traverse(mNodes.data(), mItems.data(), origin, direction, maxDistance, hitItem);
+    }
+
+    /**
+     * The same as traverse(), but calls hitLeaf(items, count, maxDistance) once with all the items of each leaf so
+     * that they can be tested together.
+     */
+    template<typename HitLeaf>
+    bool traverseLeaves(const glm::vec3 &origin, const glm::vec3 &direction, float maxDistance,
+                        HitLeaf &&hitLeaf) const
+    {
+        if (mNodes.empty()) { return false; }
+        return traverseLeaves(mNodes.data(), mItems.data(), origin, direction, maxDistance, hitLeaf);
+    }
+
+    /**
+     * The same as the traverse() above for a tree that has been copied somewhere else, such as a page file.
+     * @param nodes The nodes in the same order as getNodes(). There must be at least one.
+     * @param items The item indices in the same order as getItems().
+     */
+    template<typename HitItem>
+    static bool traverse(const node *nodes, const std::uint32_t *items, const glm::vec3 &origin,
+                         const glm::vec3 &direction, float maxDistance, HitItem &&hitItem)
+    {
+        return traverseLeaves(nodes, items, origin, direction, maxDistance,
+                              [&](const std::uint32_t *leafItems, std::uint32_t count, float &leafMaxDistance) {
+            for (std::uint32_t i = 0; i < count; ++i)
+            {
+                if (hitItem(leafItems[i], leafMaxDistance)) { return true; }
+            }
+            return false;
+        });
+    }
+
+    /** The same as the traverseLeaves() above for a tree that has been copied somewhere else. */
+    template<typename HitLeaf>
+    static bool traverseLeaves(const node *nodes, const std::uint32_t *items, const glm::vec3 &origin,
+                               const glm::vec3 &direction, float maxDistance, HitLeaf &&hitLeaf);
+
+    /** @returns The counts for every traversal on the calling thread, including the ones in progress. */
+    static traversalCounts &getThreadCounts()
+    {
+        thread_local traversalCounts counts { 0, 0 };
+        return counts;
+    }
+
+    bool isEmpty() const
+    {
+        return mNodes.empty();
+    }
+
+    const aabb &getBounds() const
+    {
+        return mNodes.front().bounds;
+    }
+
+    const std::vector<node> &getNodes() const
+    {
+        return mNodes;
+    }
+
+    const std::vector<std::uint32_t> &getItems() const
+    {
+        return mItems;
+    }
+
+    /** Frees the tree. */
+    void clear()
+    {
+        mNodes = std::vector<node>();
+        mItems = std::vector<std::uint32_t>();
+    }
+
+    /** How much memory the tree is using. */
+    std::size_t getBytesUsed() const
+    {
+        return mNodes.size() * sizeof(node) + mItems.size() * sizeof(std::uint32_t);
+    }
+
+protected:
+    /** Children always come after their parents and the two children of a node are next to each other. */
+    std::vector<node> mNodes;
+
+    /** Item indices, ordered so that the items of every leaf are next to each other. */
+    std::vector<std::uint32_t> mItems;
+
+    /** Deep enough for any tree that fits in memory. */
+    static const int maxDepth = 64;
+};
+
+template<typename HitLeaf>
+bool Bvh::traverseLeaves(const node *nodes, const std::uint32_t *items, const glm::vec3 &origin,
+                         const glm::vec3 &direction, float maxDistance, HitLeaf &&hitLeaf)
+{
+    // Axis aligned directions would give 0 * infinity when the ray starts on the face of a box.
+    glm::vec3 inverseDirection;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        const float component = std::abs(direction[axis]) > 1e-20f ? direction[axis]
+                                                                   : std::copysign(1e-20f, direction[axis]);
+        inverseDirection[axis] = 1.f / component;
+    }
+    float entryDistance;
+    if (!isIntersecting(nodes[0].bounds, origin, inverseDirection, maxDistance, entryDistance)) { return false; }
+
+    // Counted locally and added once at the end, so hitLeaf is free to traverse other trees meanwhile.
+    std::uint32_t nodeCount = 0;
+    std::uint32_t itemCount = 0;
+    auto finish = [&](bool isStopped) {
+        traversalCounts &counts = getThreadCounts();
+        counts.nodes += nodeCount;
+        counts.items += itemCount;
+        return isStopped;
+    };
+
+    std::uint32_t stack[maxDepth];
+    int stackSize = 0;
+    std::uint32_t current = 0;
+    while (true)
+    {
+        const node &n = nodes[current];
+        ++nodeCount;
+        if (n.itemCount > 0)
+        {
+            itemCount += n.itemCount;
+            if (hitLeaf(items + n.leftOrFirst, n.itemCount, maxDistance)) { return finish(true); }
+        }
+        else
+        {
+            // Visit the nearest child first so that hits shrink maxDistance as early as possible.
+            float leftDistance, rightDistance;
+            const bool isLeftHit = isIntersecting(nodes[n.leftOrFirst].bounds, origin, inverseDirection,
+                                                  maxDistance, leftDistance);
+            const bool isRightHit = isIntersecting(nodes[n.leftOrFirst + 1].bounds, origin, inverseDirection,
+                                                   maxDistance, rightDistance);
+            if (isLeftHit && isRightHit)
+            {
+                const bool isLeftNearest = leftDistance <= rightDistance;
+                stack[stackSize++] = isLeftNearest ? n.leftOrFirst + 1 : n.leftOrFirst;
+                current = isLeftNearest ? n.leftOrFirst : n.leftOrFirst + 1;
+                continue;
+            }
+            if (isLeftHit || isRightHit)
+            {
+                current = isLeftHit ? n.leftOrFirst : n.leftOrFirst + 1;
+                continue;
+            }
+        }
+
+        // Nodes on the stack may be further away than something that has since been hit.
+        do
+        {
+            if (stackSize == 0) { return finish(false); }
+            current = stack[--stackSize];
+        } while (!isIntersecting(nodes[current].bounds, origin, inverseDirection, maxDistance, entryDistance));
+    }
+}
+
+
+#endif //A2MCGRAYTRACER_BVH_H
@@ -0,0 +1,114 @@
+/**
+ * @file Kernels.h
+ * @brief The loops that run over whole rows of pixels or triangles, built for several instruction sets and picked
+ * at startup.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_KERNELS_H
+#define A2MCGRAYTRACER_KERNELS_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Each instruction set has its own translation unit that's compiled with the flags for it, so the rest of the
+ * renderer stays runnable on any x86-64 CPU. The widest set that both the CPU and the OS support is used unless the
+ * A2_ISA environment variable or select() asks for another.
+ * @paragraph Every version does the exact same operations on each pixel and triangle (nothing is fused into an FMA),
+ * so the image never depends on which one ran. Only the x86 builds have anything other than Generic.
+ */
+namespace kernels
+{
+    /** From the narrowest up. */
+    enum isa { Generic, Sse42, Avx2, Avx512, NumberOfIsas };
+
+    /** One row of a triangle in the visibility buffer. @see VisibilityBuffer::screenTriangle */
+    struct rasterSpan
+    {
+        /** The barycentric weight of each corner is weightStep * x + weightRow at pixel x. */
+        float           weightStep[3];
+        float           weightRow[3];
+
+        /** 1 / w the same way. */
+        float           depthStep;
+        float           depthRow;
+
+        /** The pixels to cover, from xStart up to (but not including) xEnd. */
+        int             xStart;
+        int             xEnd;
+        std::uint32_t   actor;
+        std::uint32_t   primitive;
+    };
+
+    struct table
+    {
+        /**
+         * Normalises count ray directions along a row: direction + (x + i * xStep) * step for each ray i, where
+         * direction and step are XYZ and x and xStep are whole pixels. Gives the same result as glm::normalize().
+         * The results are written to each of xs, ys and zs.
+         */
+        void (*normaliseDirections)(const float *direction, const float *step, float x, float xStep, int count,
+                                    float *xs, float *ys, float *zs);
+
+        /**
+         * Packs count RGB colours (three floats each) the same way as RenderCore::packColour(): clamped to [0, 1]
+         * and truncated to 8 bits per channel as 0x00RRGGBB.
+         */
+        void (*packColours)(const float *colours, std::uint32_t *packed, int count);
+
+        /**
+         * Writes the actor and primitive of the span to every pixel that it covers and is closer than what's there.
+         * Each array is a row of pixels indexed by x.
+         */
+        void (*rasteriseSpan)(const rasterSpan &span, float *inverseDepths, std::uint32_t *actors,
+                              std::uint32_t *primitives);
+
+        /**
+         * Tests a ray against count triangles (up to 32) with Moller-Trumbore. Each triangle is three XYZ corners
+         * one after the other. Edges are inclusive so that rays can't slip between neighbouring triangles.
+         * @returns A bit for each triangle, from the lowest up, that's hit in front of the ray and closer than
+         * maxDistance. Where it's hit is written to distances for those triangles; the rest may be overwritten.
+         */
+        std::uint32_t (*intersectTriangles)(const float *corners, int count, const float *origin,
+                                            const float *direction, float maxDistance, float *distances);
+    };
+
+    /** @returns The widest instruction set that this build, the CPU and the OS can all run. Checked with CPUID. */
+    isa getSupported();
+
+    /** @returns The instruction set whose kernels are in use. */
+    isa getSelected();
+
+    /** @returns The kernels to use. Selects them from A2_ISA or getSupported() the first time. */
+    const table &get();
+
+    /**
+     * Uses the kernels of an instruction set from now on, or the widest one below it that's supported.
+     * Only call it while nothing is using the kernels, like at startup.
+     */
+    void select(isa requested);
+
+    /**
+     * @returns Which kernels are in use and why, such as "AVX2 (up to AVX-512 is supported)", for the program to
+     * print. Nothing here prints, so that the kernels can be used by programs that own their output.
+     */
+    std::string describeSelection();
+
+    const char *getName(isa value);
+
+    /** @returns False if the name isn't one from getName(). Also takes sse42 and avx-512. */
+    bool readName(const std::string &name, isa &value);
+
+    // The table of each instruction set. Only use one that getSupported() allows.
+    const table &getGenericTable();
+    const table &getSse42Table();
+    const table &getAvx2Table();
+    const table &getAvx512Table();
+}
+
+#endif //A2MCGRAYTRACER_KERNELS_H
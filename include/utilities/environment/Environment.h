@@ -0,0 +1,119 @@
+/**
+ * @file Environment.h
+ * @brief What rays see when they leave the scene, either a procedural sky or an HDR image.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_ENVIRONMENT_H
+#define A2MCGRAYTRACER_ENVIRONMENT_H
+
+#include "MappedFile.h"
+
+#include "glm.hpp"
+
+#include <string>
+#include <vector>
+
+/** The colours of the procedural sky. A flat colour below the horizon and a gradient in two parts above it. */
+struct skyColours
+{
+    /** The colour of the ground below the horizon */
+    glm::vec3 ground { 0.408f, 0.380f, 0.357f };
+
+    /** The colour of the horizon */
+    glm::vec3 horizon { 0.482f, 0.937f, 0.976f };
+
+    /** The colour of the sky towards the bottom. */
+    glm::vec3 skyBottom { 0.008f, 0.725f, 1.f };
+
+    /** The colour of the sky when looking directly up */
+    glm::vec3 skyTop { 0.f, 0.059f, 0.486f };
+
+    /** How far up (as the dot product of the direction with up) the sky goes from the horizon to skyBottom. */
+    float skyBottomAngle { 0.08f };
+};
+
+/**
+ * The colour of everything infinitely far away, looked up by direction. Every kind of environment is sampled
+ * through a table, so escaping rays cost the same few loads whatever is behind them.
+ * @paragraph The procedural sky only changes with the height of the direction, so it's baked into a table over
+ * that whenever its colours change. HDR images are little endian PFM files that are mapped straight into memory
+ * and read in place. An image twice as wide as it is tall is equirectangular (longitude across, latitude down)
+ * and one six times as tall as it is wide is a cubemap with the +X, -X, +Y, -Y, +Z and -Z faces from top to bottom.
+ * Both are bilinearly filtered.
+ * @paragraph sample() only reads, so any number of threads can share an environment while nothing changes it.
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 19/10/2026]
+ */
+class Environment
+{
+public:
+    /** Starts out as the default sky. */
+    Environment();
+
+    explicit Environment(const skyColours &sky);
+
+    /** Bakes the procedural sky, replacing whatever was there before. */
+    void setSky(const skyColours &sky);
+
+    /**
+     * Maps an equirectangular or cubemap PFM image in place of the sky.
+     * @param error Set to why the image can't be used, if it can't.
+     * @returns False (without changing anything) if it can't be used.
+     */
+    bool load(const std::string &path, std::string &error);
+
+    /** @param direction Must be normalised. */
+    glm::vec3 sample(const glm::vec3 &direction) const;
+
+    bool isImage() const
+    {
+        return mLayout != Sky;
+    }
+
+    /** @returns The memory used by the tables. Mapped images are counted by the pages that the OS reads in. */
+    std::size_t getBytesUsed() const;
+
+protected:
+    enum layout { Sky, Equirectangular, Cubemap };
+    layout mLayout { Sky };
+
+    /** The number of steps in the baked sky from the horizon to straight up. */
+    static const int skyResolution = 1024;
+
+    glm::vec3 mGround { 0.f };
+
+    /** The sky at every step from the horizon up, with the top repeated so that lookups never need clamping. */
+    std::vector<glm::vec3> mSkyTable;
+
+    MappedFile mFile;
+
+    /** The first RGB float of the image, which PFM stores from the bottom row up. */
+    const char *mTexels { nullptr };
+
+    /** The size of the whole image in texels. */
+    glm::ivec2 mImageSize { 0 };
+
+    /** The size of the region that a direction lands in, which is a single face for cubemaps. */
+    glm::ivec2 mFaceSize { 0 };
+
+    glm::vec3 getTexel(int x, int y) const;
+
+    /**
+     * Filters the four texels around a point.
+     * @param position In texels, relative to the top left of the face's first row.
+     * @param isWrapping Whether x wraps around (equirectangular) rather than clamping to the face (cubemap).
+     */
+    glm::vec3 sampleBilinear(const glm::vec2 &position, int faceRow, bool isWrapping) const;
+
+    glm::vec3 sampleEquirectangular(const glm::vec3 &direction) const;
+
+    glm::vec3 sampleCubemap(const glm::vec3 &direction) const;
+};
+
+
+#endif //A2MCGRAYTRACER_ENVIRONMENT_H
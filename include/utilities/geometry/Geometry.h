@@ -16,6 +16,9 @@
 
 #include "glm.hpp"
 
+#include <cstdint>
+#include <limits>
+
 /**
  * Used to normalise a value between a range. There are no bound checks
  * for value x. Additionally, lB and uB do not have to be the correct way
@@ -42,5 +45,56 @@ float normalise(const float &x, const float &lB, const float &uB);
  */
 float map(const float &x, const float &xLb, const float &xUb, const float &yLb, const float &yUb);
 
+/** An axis aligned bounding box. Starts off empty (inside out) so that anything grown into it replaces it. */
+struct aabb
+{
+    glm::vec3 min { std::numeric_limits<float>::max() };
+    glm::vec3 max { -std::numeric_limits<float>::max() };
+
+    void grow(const glm::vec3 &point)
+    {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void grow(const aabb &box)
+    {
+        min = glm::min(min, box.min);
+        max = glm::max(max, box.max);
+    }
+
+    glm::vec3 getCentre() const
+    {
+        return (min + max) * 0.5f;
+    }
+
+    /** Used to guess how likely a random ray is to hit the box. */
+    float getSurfaceArea() const
+    {
+        const glm::vec3 size = max - min;
+        return size.x < 0.f ? 0.f : 2.f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+
+    /** @returns The box that contains this box after it has been transformed. */
+    aabb transform(const glm::mat4 &matrix) const;
+};
+
+/**
+ * Slab test between a ray and a box.
+ * @param inverseDirection 1 / the direction of the ray.
+ * @returns True if the ray enters the box before maxDistance. entryDistance is set to where it enters.
+ */
+bool isIntersecting(const aabb &box, const glm::vec3 &origin, const glm::vec3 &inverseDirection,
+                    float maxDistance, float &entryDistance);
+
+/**
+ * Packs a unit vector into 32 bits by folding the octahedron around it flat onto a square.
+ * @returns Two 16 bit signed normalised coordinates, x in the low half.
+ */
+std::uint32_t encodeOctahedral(const glm::vec3 &normal);
+
+/** @returns The unit vector packed by encodeOctahedral(). */
+glm::vec3 decodeOctahedral(std::uint32_t encoded);
+
 
 #endif //A2MCGRAYTRACER_GEOMETRY_H
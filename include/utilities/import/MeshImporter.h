@@ -0,0 +1,69 @@
+/**
+ * @file MeshImporter.h
+ * @brief Reads OBJ and binary PLY meshes into vertex and index buffers that are shared between meshes.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_MESHIMPORTER_H
+#define A2MCGRAYTRACER_MESHIMPORTER_H
+
+#include "LightingMaterials.h"
+#include "ThreadPool.h"
+
+#include "glm.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/** Vertices and triangles of any number of meshes, one after the other. */
+struct meshBuffer
+{
+    std::vector<glm::vec3>      positions;
+
+    /** Three per triangle. Relative to the first vertex of the mesh that the triangle belongs to. */
+    std::vector<std::uint32_t>  indices;
+
+    /** One per triangle. Indexes into the materials of the mesh that the triangle belongs to. */
+    std::vector<std::uint32_t>  materialIds;
+};
+
+/** Used as a material id by triangles that use the material of the mesh. */
+const std::uint32_t noMaterialId = 0xFFFFFFFF;
+
+/** Where an imported mesh ended up in a meshBuffer. */
+struct importedMesh
+{
+    bool                                success;
+    std::size_t                         firstVertex;
+    std::size_t                         vertexCount;
+    std::size_t                         firstTriangle;
+    std::size_t                         triangleCount;
+
+    /** The materials that the material ids of the mesh index into. Taken from the OBJ's material library. */
+    std::vector<actorLightingMaterial>  materials;
+
+    /** Why the import failed. */
+    std::string                         error;
+
+    // Load throughput.
+    std::size_t                         bytesRead;
+    double                              seconds;
+};
+
+/**
+ * Appends the mesh in the .obj or binary .ply file to the end of the buffer. The file is split into chunks that
+ * are decoded in parallel on the pool, with every chunk writing straight into its own part of the buffer.
+ * @paragraph OBJ faces are triangulated as fans and usemtl names are looked up in the first mtllib. PLY files
+ * may have a 'material_index' property on their faces. Anything other than positions and faces is skipped.
+ * @returns A mesh that isn't a success if the file can't be read. The buffer is left as it was when that happens.
+ */
+importedMesh importMesh(const std::string &path, meshBuffer &buffer, ThreadPool &pool);
+
+
+#endif //A2MCGRAYTRACER_MESHIMPORTER_H
@@ -0,0 +1,152 @@
+/**
+ * @file ClusterCache.h
+ * @brief Keeps a budgeted set of page file clusters in memory for scenes that are larger than memory.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_CLUSTERCACHE_H
+#define A2MCGRAYTRACER_CLUSTERCACHE_H
+
+#include "MappedFile.h"
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * Keeps a budgeted set of clusters from a page file in memory. A cluster is a page aligned block of geometry
+ * (a piece of a mesh along with the tree over it) that is only read while it's resident.
+ * @paragraph Rays that need a cluster that isn't resident ask for it and are marked as deferred.
+ * The renderer traces them again once pageIn() has brought every requested cluster in as a single batch.
+ * Nothing is ever paged out while a pass is rendering, so anything that was resident when a ray started
+ * stays resident until the ray finishes.
+ * @paragraph Clusters are added while the scene is loading, then finish() maps the file. The page file is
+ * deleted when the cache is destroyed.
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 19/10/2026]
+ */
+class ClusterCache
+{
+public:
+    /** Paging since the last call to resetStatistics(). */
+    struct statistics
+    {
+        std::size_t     residentBytes;
+        std::size_t     budget;
+        std::size_t     residentClusters;
+        std::size_t     clusterCount;
+        std::uint64_t   pageIns;
+        std::uint64_t   bytesPagedIn;
+        std::uint64_t   evictions;
+        std::uint64_t   deferredRays;
+        std::uint64_t   batches;
+        double          pageInSeconds;
+    };
+
+    /** Clusters start on multiples of this in the page file. */
+    static const std::size_t pageSize = 4096;
+
+    /**
+     * @param path Where the page file is written. It's created (or replaced) straight away.
+     * @param residentBudget How many bytes of clusters can be resident at once. Clusters that have been used
+     * since the last batch aren't evicted, so the budget is exceeded rather than stalling rays that need more.
+     */
+    ClusterCache(const std::string &path, std::size_t residentBudget);
+
+    ~ClusterCache();
+
+    ClusterCache(const ClusterCache &) = delete;
+    ClusterCache &operator=(const ClusterCache &) = delete;
+
+    /** @returns A path in the temporary directory that no other cache is using. */
+    static std::string makeTemporaryPath();
+
+    /**
+     * Appends a cluster to the page file. Only valid before finish().
+     * @returns The index of the cluster.
+     */
+    std::uint32_t addCluster(const std::vector<char> &data);
+
+    /**
+     * Maps the page file. Nothing is resident until it's asked for.
+     * @returns False if the page file couldn't be written or mapped.
+     */
+    bool finish();
+
+    /**
+     * Used while rendering, from any thread.
+     * @returns The cluster, or null if it isn't resident. The cluster is requested and the
+     * current ray is marked as deferred in that case.
+     */
+    const char *find(std::uint32_t cluster);
+
+    /** Clears the deferred mark of the calling thread. Call before tracing each ray. */
+    static void beginRay();
+
+    /** @returns True if the ray that the calling thread is tracing needed a cluster that wasn't resident. */
+    static bool isRayDeferred();
+
+    /** Adds to the deferred ray statistic. */
+    void countDeferredRays(std::size_t count);
+
+    /** @returns True if a ray has asked for a cluster since the last pageIn(). */
+    bool hasRequests() const
+    {
+        return mHasRequests.load(std::memory_order_acquire);
+    }
+
+    /**
+     * Brings in every requested cluster, evicting the least recently used ones to stay in budget.
+     * Must not be called while anything is rendering.
+     */
+    void pageIn();
+
+    statistics getStatistics() const;
+
+    void resetStatistics();
+
+protected:
+    struct cluster
+    {
+        std::size_t                 offset;
+        std::size_t                 size;
+        std::atomic<bool>           isResident { false };
+        std::atomic<bool>           isRequested { false };
+
+        /** The batch that the cluster was last used in. Anything used in the same batch is as recent. */
+        std::atomic<std::uint32_t>  lastUsed { 0 };
+    };
+
+    std::string mPath;
+    std::ofstream mWriter;
+    std::vector<std::pair<std::size_t, std::size_t>> mRanges;
+    std::size_t mWriteOffset { 0 };
+
+    MappedFile mFile;
+    std::unique_ptr<cluster[]> mClusters;
+    std::size_t mClusterCount { 0 };
+    std::size_t mBudget;
+    std::size_t mResidentBytes { 0 };
+    std::atomic<bool> mHasRequests { false };
+    std::uint32_t mBatch { 1 };
+
+    std::atomic<std::uint64_t> mDeferredRays { 0 };
+    std::uint64_t mPageIns { 0 };
+    std::uint64_t mBytesPagedIn { 0 };
+    std::uint64_t mEvictions { 0 };
+    std::uint64_t mBatches { 0 };
+    double mPageInSeconds { 0.0 };
+
+    void evict(cluster &evicted);
+};
+
+
+#endif //A2MCGRAYTRACER_CLUSTERCACHE_H
@@ -0,0 +1,79 @@
+/**
+ * @file MappedFile.h
+ * @brief A read-only view of a file that is mapped straight into memory.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_MAPPEDFILE_H
+#define A2MCGRAYTRACER_MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * A read-only view of a file that is mapped straight into memory. Nothing is read
+ * until it's touched, so the OS pages the file in as it is used.
+ * @paragraph The mapping stays at the same address when moved, so pointers into
+ * the data stay valid for as long as some MappedFile owns it.
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 19/10/2026]
+ */
+class MappedFile
+{
+public:
+    MappedFile() = default;
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+
+    /**
+     * Maps the whole file, closing whatever was mapped before.
+     * @returns False if the file doesn't exist, is empty or can't be mapped.
+     */
+    bool open(const std::string &path);
+
+    void close();
+
+    bool isOpen() const
+    {
+        return mData != nullptr;
+    }
+
+    const char *getData() const
+    {
+        return mData;
+    }
+
+    std::size_t getSize() const
+    {
+        return mSize;
+    }
+
+    /**
+     * Asks the OS to start reading the range in before it's touched.
+     * @param offset Must be a multiple of the page size.
+     */
+    void prefetch(std::size_t offset, std::size_t size) const;
+
+    /**
+     * Lets the OS drop the range from memory. It's read back in from the file the next time it's touched.
+     * @param offset Must be a multiple of the page size.
+     */
+    void evict(std::size_t offset, std::size_t size) const;
+
+protected:
+    const char *mData{ nullptr };
+    std::size_t mSize{ 0 };
+};
+
+
+#endif //A2MCGRAYTRACER_MAPPEDFILE_H
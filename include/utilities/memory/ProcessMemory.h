@@ -0,0 +1,22 @@
+/**
+ * @file ProcessMemory.h
+ * @brief Asks the OS how much memory the whole process is using.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_PROCESSMEMORY_H
+#define A2MCGRAYTRACER_PROCESSMEMORY_H
+
+#include <cstddef>
+
+/**
+ * @returns The most physical memory that the process has used at once since it started (the peak resident set or
+ * working set) in bytes, or 0 if the OS can't say.
+ */
+std::size_t getPeakMemoryUsage();
+
+#endif //A2MCGRAYTRACER_PROCESSMEMORY_H
@@ -0,0 +1,129 @@
+/**
+ * @file SceneArena.h
+ * @brief Owns every entity in a scene in a few large chunks of memory.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_SCENEARENA_H
+#define A2MCGRAYTRACER_SCENEARENA_H
+
+#include <cstddef>
+#include <new>
+#include <string>
+#include <typeindex>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+/**
+ * Owns every entity in a scene. Objects of the same type are placed next to each other
+ * in blocks that are cut out of a few large chunks, so walking the actors of a scene doesn't
+ * hop all over the heap and tearing a scene down frees a handful of chunks rather than every object.
+ * @paragraph Objects live until release() is called (or the arena is destroyed).
+ * Not thread-safe; a scene is only ever built by a single thread.
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 19/10/2026]
+ */
+class SceneArena
+{
+public:
+    /** How much memory a single type of object is using. */
+    struct usage
+    {
+        std::string typeName;
+        std::size_t count;
+        std::size_t bytesUsed;
+        std::size_t bytesReserved;
+    };
+
+    SceneArena();
+
+    /** @param chunkSize The size of each chunk that is requested from the heap. */
+    explicit SceneArena(std::size_t chunkSize);
+
+    ~SceneArena();
+
+    SceneArena(const SceneArena &) = delete;
+    SceneArena &operator=(const SceneArena &) = delete;
+
+    SceneArena(SceneArena &&other) noexcept;
+    SceneArena &operator=(SceneArena &&other) noexcept;
+
+    /**
+     * Constructs a T inside the arena. The arena owns the object so it must never be deleted.
+     * @returns The new object. Stays valid until release() is called.
+     */
+    template<typename T, typename ...Args>
+    T *make(Args &&...args);
+
+    /** Destroys every object and gives all of the memory back to the heap in one go. */
+    void release();
+
+    /** How much memory each type of object is using, in the order that the types were first made. */
+    std::vector<usage> getUsage() const;
+
+    /** The number of bytes that objects are taking up. */
+    std::size_t getBytesUsed() const;
+
+    /** The number of bytes requested from the heap. */
+    std::size_t getBytesReserved() const
+    {
+        return mBytesReserved;
+    }
+
+protected:
+    /** A run of objects of the same type. */
+    struct block
+    {
+        char        *data;
+        std::size_t capacity;
+        std::size_t count;
+    };
+
+    /** Every object of a single type. */
+    struct pool
+    {
+        std::type_index     type;
+        std::string         typeName;
+        std::size_t         size;
+        std::size_t         alignment;
+        void                (*destroy)(void *object);
+        std::vector<block>  blocks;
+    };
+
+    pool &getPool(const std::type_info &type, std::size_t size, std::size_t alignment, void (*destroy)(void *));
+
+    /** @returns Space for one more object in the pool, adding a block if the last one is full. */
+    void *allocate(pool &objectPool);
+
+    /** Cuts space out of the current chunk, starting a new one if there isn't enough room. */
+    char *allocateFromChunk(std::size_t bytes, std::size_t alignment);
+
+    std::vector<pool> mPools;
+    std::vector<char*> mChunks;
+
+    std::size_t mChunkSize;
+    std::size_t mChunkOffset{ 0 };
+    std::size_t mCurrentChunkSize{ 0 };
+    std::size_t mBytesReserved{ 0 };
+};
+
+template<typename T, typename ...Args>
+T *SceneArena::make(Args &&...args)
+{
+    static_assert(alignof(T) <= alignof(std::max_align_t), "Chunks are only aligned to max_align_t.");
+
+    pool &objectPool = getPool(typeid(T), sizeof(T), alignof(T),
+                               [](void *object) { static_cast<T*>(object)->~T(); });
+    void *memory = allocate(objectPool);
+    T *object = new (memory) T(std::forward<Args>(args)...);
+    ++objectPool.blocks.back().count;  // Only counted once constructed so that a throwing constructor isn't destroyed.
+    return object;
+}
+
+
+#endif //A2MCGRAYTRACER_SCENEARENA_H
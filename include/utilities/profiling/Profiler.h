@@ -0,0 +1,204 @@
+/**
+ * @file Profiler.h
+ * @brief Counters and timers for the renderer's hot paths that are only compiled in with A2_PROFILING.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_PROFILER_H
+#define A2MCGRAYTRACER_PROFILER_H
+
+/*
+ * Use the macros rather than calling into profiling directly. Without A2_PROFILING they expand to nothing,
+ * so their arguments aren't even evaluated and nothing is left behind in the hot paths.
+ */
+#ifdef A2_PROFILING
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Every thread counts into its own data without any synchronisation. It's all gathered by endFrame(),
+ * which has to be called when nothing else is running. The profile is shared by the whole process, so it
+ * only profiles a single renderer: while more than one exists nothing is gathered, since the other renderers'
+ * threads could be counting at the time. @see addRenderer()
+ */
+namespace profiling
+{
+    using clock = std::conditional<std::chrono::high_resolution_clock::is_steady,
+                                   std::chrono::high_resolution_clock,
+                                   std::chrono::steady_clock>::type;
+
+    enum timerName
+    {
+        Update,
+        Commit,
+        Visibility,
+        RenderPass,
+        Tile,
+        AntiAliasing,
+        Presentation,
+
+        // Timed for every ray, so they are too fine to appear in the trace. Tracing includes Shading.
+        RayGeneration,
+        Tracing,
+        Shading,
+
+        NumberOfTimers
+    };
+
+    /** Timers before this appear in the trace as well as in the totals. */
+    const timerName firstUntracedTimer = RayGeneration;
+
+    /** Paths with more bounces than this are counted with it. */
+    const int maxCountedBounces = 16;
+
+    struct traceEvent
+    {
+        timerName           timer;
+        clock::time_point   start;
+        clock::time_point   end;
+    };
+
+    /** Everything counted over some span of time. */
+    struct profileCounts
+    {
+        double                      timerSeconds[NumberOfTimers] {};
+        std::uint64_t               timerCalls[NumberOfTimers] {};
+
+        /** Indexed by the actor's index in the scene. */
+        std::vector<std::uint64_t>  actorTests;
+        std::vector<std::uint64_t>  actorHits;
+
+        /** Indexed by the light's index in the scene. */
+        std::vector<std::uint64_t>  lightShadowRays;
+
+        /** The number of paths by how many surfaces they hit. */
+        std::uint64_t               pathBounces[maxCountedBounces + 1] {};
+
+        std::vector<traceEvent>     events;
+    };
+
+    /** What a single thread has counted since the last endFrame(). */
+    struct threadProfile : profileCounts
+    {
+        std::uint32_t threadId;
+
+        threadProfile();
+
+        /** Hands whatever hasn't been gathered yet over so that it isn't lost with the thread. */
+        ~threadProfile();
+
+        threadProfile(const threadProfile &) = delete;
+        threadProfile &operator=(const threadProfile &) = delete;
+    };
+
+    /** Set while a trace is being recorded. Read without synchronisation, it only changes between frames. */
+    extern bool isTracing;
+
+    inline threadProfile &getThreadProfile()
+    {
+        thread_local threadProfile profile;
+        return profile;
+    }
+
+    inline void countIntersection(std::uint32_t actor, bool isHit)
+    {
+        threadProfile &profile = getThreadProfile();
+        if (actor >= profile.actorTests.size())
+        {
+            profile.actorTests.resize(actor + 1);
+            profile.actorHits.resize(actor + 1);
+        }
+        ++profile.actorTests[actor];
+        profile.actorHits[actor] += isHit ? 1 : 0;
+    }
+
+    inline void countShadowRay(std::uint32_t light)
+    {
+        threadProfile &profile = getThreadProfile();
+        if (light >= profile.lightShadowRays.size()) { profile.lightShadowRays.resize(light + 1); }
+        ++profile.lightShadowRays[light];
+    }
+
+    inline void countPath(int bounces)
+    {
+        ++getThreadProfile().pathBounces[bounces < maxCountedBounces ? bounces : maxCountedBounces];
+    }
+
+    /** Adds the time between its construction and destruction to a timer. */
+    class ScopedTimer
+    {
+    public:
+        explicit ScopedTimer(timerName timer) : mTimer(timer), mStart(clock::now()) {}
+
+        ~ScopedTimer()
+        {
+            const clock::time_point end = clock::now();
+            threadProfile &profile = getThreadProfile();
+            profile.timerSeconds[mTimer] += std::chrono::duration<double>(end - mStart).count();
+            ++profile.timerCalls[mTimer];
+            if (isTracing && mTimer < firstUntracedTimer) { profile.events.push_back({ mTimer, mStart, end }); }
+        }
+
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        timerName mTimer;
+        clock::time_point mStart;
+    };
+
+    /**
+     * Gathers everything counted by every thread since the last call and writes a summary of it,
+     * along with the frame time percentiles so far. Must be called when nothing else is running.
+     * Does nothing while more than one renderer exists.
+     * @param out Where the summary is written. Null only gathers.
+     */
+    void endFrame(std::ostream *out);
+
+    /** Called by each renderer before it counts anything, so that endFrame() knows when it's the only one. */
+    void addRenderer();
+
+    /** Called by each renderer once nothing of its own is running. */
+    void removeRenderer();
+
+    /** Starts recording every traced timer. The trace is written in the Chrome trace format by stopTrace(). */
+    void startTrace(const std::string &path);
+
+    /** @returns False if the trace couldn't be written. */
+    bool stopTrace();
+}
+
+#define A2_PROFILE_CONCAT_INNER(a, b) a##b
+#define A2_PROFILE_CONCAT(a, b) A2_PROFILE_CONCAT_INNER(a, b)
+
+/** Times the rest of the enclosing scope with the named timer. */
+#define A2_PROFILE_SCOPE(timer) ::profiling::ScopedTimer A2_PROFILE_CONCAT(profileScope, __LINE__)(::profiling::timer)
+#define A2_PROFILE_INTERSECTION(actor, isHit) ::profiling::countIntersection(actor, isHit)
+#define A2_PROFILE_SHADOW_RAY(light) ::profiling::countShadowRay(light)
+#define A2_PROFILE_PATH(bounces) ::profiling::countPath(bounces)
+#define A2_PROFILE_END_FRAME(out) ::profiling::endFrame(out)
+#define A2_PROFILE_ADD_RENDERER() ::profiling::addRenderer()
+#define A2_PROFILE_REMOVE_RENDERER() ::profiling::removeRenderer()
+
+#else
+
+#define A2_PROFILE_SCOPE(timer)
+#define A2_PROFILE_INTERSECTION(actor, isHit) ((void)0)
+#define A2_PROFILE_SHADOW_RAY(light) ((void)0)
+#define A2_PROFILE_PATH(bounces) ((void)0)
+#define A2_PROFILE_END_FRAME(out) ((void)0)
+#define A2_PROFILE_ADD_RENDERER() ((void)0)
+#define A2_PROFILE_REMOVE_RENDERER() ((void)0)
+
+#endif
+
+#endif //A2MCGRAYTRACER_PROFILER_H
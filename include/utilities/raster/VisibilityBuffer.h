@@ -0,0 +1,171 @@
+/**
+ * @file VisibilityBuffer.h
+ * @brief The nearest surface under every pixel of a camera, found by rasterising the scene instead of tracing rays.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_VISIBILITYBUFFER_H
+#define A2MCGRAYTRACER_VISIBILITYBUFFER_H
+
+#include "ThreadPool.h"
+
+#include "glm.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+class Actor;
+class Camera;
+
+/** The surfaces that an actor hands to the visibility pass, in world space. @see Actor::rasterize() */
+struct rasterPrimitives
+{
+    /** Three corners for each triangle. A triangle's primitive is its index. */
+    std::vector<glm::vec3> triangles;
+
+    /**
+     * The centre and radius of each sphere. Spheres are drawn as impostors that are intersected with the pixel's
+     * camera ray, so their outline and depth are exact. Their primitives follow on from the triangles.
+     */
+    std::vector<glm::vec4> spheres;
+
+    void clear()
+    {
+        triangles.clear();
+        spheres.clear();
+    }
+};
+
+/**
+ * The actor, primitive and depth of the nearest surface under every pixel of a camera. It's the same surface that
+ * the pixel's camera ray would hit first, give or take the very edges of triangles, so rays can carry on from it
+ * without going through the scene's trees at all.
+ * @paragraph Every actor is set up and clipped to the near plane in parallel, then binned into tiles. Each tile is
+ * rasterised by a single thread, as many pixels at a time as the widest kernels the CPU has. @see kernels
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 19/10/2026]
+ */
+class VisibilityBuffer
+{
+public:
+    /** The actor of pixels that nothing covers. */
+    static const std::uint32_t noActor = 0xFFFFFFFF;
+
+    struct texel
+    {
+        /** The actor's index in the list that was rendered, or noActor. */
+        std::uint32_t actor;
+
+        /** @see rasterPrimitives */
+        std::uint32_t primitive;
+    };
+
+    /** Everything the tiles need to rasterise a triangle, in pixels. */
+    struct screenTriangle
+    {
+        /** The barycentric weights of the corners are plane.x * x + plane.y * y + plane.z at pixel (x, y). */
+        glm::vec3       weights[3];
+
+        /** 1 / w across the triangle the same way. Larger is closer. */
+        glm::vec3       inverseDepth;
+
+        /** The pixels that it can cover, inclusive. */
+        glm::ivec4      bounds;
+        std::uint32_t   actor;
+        std::uint32_t   primitive;
+    };
+
+    struct screenSphere
+    {
+        glm::vec4       sphere;
+        glm::ivec4      bounds;
+        std::uint32_t   actor;
+        std::uint32_t   primitive;
+    };
+
+    explicit VisibilityBuffer(const glm::ivec2 &resolution);
+
+    /**
+     * Finds the nearest surface under every pixel as the camera sees it, as of its last commit.
+     * Stops early (leaving the buffer incomplete) if cancel gets set.
+     * @param camera Must render at the same resolution as the buffer.
+     */
+    void render(const Camera &camera, const std::vector<Actor*> &actors, ThreadPool &threadPool,
+                const std::atomic<bool> &cancel);
+
+    texel get(const glm::ivec2 &pixelPosition) const
+    {
+        const int index = pixelPosition.y * mResolution.x + pixelPosition.x;
+        return { mActors[index], mPrimitives[index] };
+    }
+
+    /** @returns 1 / w of the nearest surface under the pixel, where w is its depth in front of the camera. 0 if none. */
+    float getInverseDepth(const glm::ivec2 &pixelPosition) const
+    {
+        return mInverseDepths[pixelPosition.y * mResolution.x + pixelPosition.x];
+    }
+
+    /**
+     * @returns Whether a point on a surface is as far from the camera as the nearest surface under the pixel, give
+     * or take rounding. A ray that hits the pixel's primitive somewhere else has been handed the wrong surface.
+     */
+    bool isNearestAt(const glm::ivec2 &pixelPosition, const glm::vec3 &position) const;
+
+    /**
+     * Gets the pixels above, below and to either side of this one. Rounding only ever moves an edge by a fraction
+     * of a pixel, so a surface that a pixel should have seen is under one of these if it's under any.
+     * @returns How many of them are inside the buffer. Those come first.
+     */
+    int getNeighbours(const glm::ivec2 &pixelPosition, texel (&neighbours)[4]) const;
+
+    std::size_t getBytesUsed() const;
+
+protected:
+    glm::ivec2 mResolution;
+
+    /** The width and height of a tile in pixels. A multiple of sixteen so that rows split into whole SIMD groups. */
+    static const int tileSize = 32;
+    glm::ivec2 mTileCount;
+
+    // One of each per pixel. Row major.
+    std::vector<float> mInverseDepths;
+    std::vector<std::uint32_t> mActors;
+    std::vector<std::uint32_t> mPrimitives;
+
+    // What every actor was set up into, in the order of the actors so that the result never depends on the threads.
+    std::vector<screenTriangle> mTriangles;
+    std::vector<screenSphere> mSpheres;
+
+    /** Takes a world position to its w. Along with the near plane, from the camera that's being rendered. */
+    glm::vec4 mToDepth { 0.f };
+    float mNearPlane { 0.f };
+
+    /** The indices of the primitives that overlap each tile. */
+    std::vector<std::vector<std::uint32_t>> mTriangleBins;
+    std::vector<std::vector<std::uint32_t>> mSphereBins;
+
+    /** Projects, clips and culls the primitives of the actors in [first, last) and appends what's left. */
+    void setUp(const Camera &camera, const std::vector<Actor*> &actors, std::size_t first, std::size_t last,
+               std::vector<screenTriangle> &triangles, std::vector<screenSphere> &spheres) const;
+
+    /** Adds a triangle whose corners are (x, y, w) after projection to pixels, if it covers any pixels. */
+    void addTriangle(const glm::vec3 (&corners)[3], std::uint32_t actor, std::uint32_t primitive,
+                     std::vector<screenTriangle> &triangles) const;
+
+    void bin();
+
+    void rasteriseTile(const Camera &camera, int tileIndex);
+
+    void rasteriseTriangle(const screenTriangle &triangle, const glm::ivec2 &tileStart, const glm::ivec2 &tileEnd);
+
+    void rasteriseSphere(const Camera &camera, const screenSphere &sphere, const glm::ivec2 &tileStart,
+                         const glm::ivec2 &tileEnd);
+};
+
+
+#endif //A2MCGRAYTRACER_VISIBILITYBUFFER_H
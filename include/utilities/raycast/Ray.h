@@ -57,6 +57,9 @@ struct hitInfo
 
     /** The lighting information of the surface to calculate the lighting later on. */
     actorLightingMaterial material;
+
+    /** Did it hit the inside (or back) of the surface? The normal always faces back along the ray either way. */
+    bool isBackFace { false };
 };
 
 #endif //A2MCGRAYTRACER_RAY_H
@@ -0,0 +1,186 @@
+/**
+ * @file SceneFormat.h
+ * @brief The layout of a compiled scene file.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_SCENEFORMAT_H
+#define A2MCGRAYTRACER_SCENEFORMAT_H
+
+#include <cstdint>
+
+/**
+ * The layout of a compiled scene file. A compiled scene is a header followed by flat arrays of the
+ * records below, so it can be mapped into memory and used where it is without being parsed.
+ * Mesh vertices and indices are used directly by the mesh assets, which are shared by any number of instances.
+ * @paragraph Every record other than the characters in the string section only holds 4 byte types and every
+ * section starts on a 16 byte boundary.
+ * Files are written in the byte order of the machine that compiles them (always little endian in practice).
+ * Rotations are euler angles in radians. Material indices point into the material section.
+ * @see SceneCompiler.cpp for the text format that compiles into this.
+ */
+namespace sceneFile
+{
+    const char magic[8] = { 'A', '2', 'S', 'C', 'E', 'N', 'E', '\0' };
+    const std::uint32_t version = 4;
+
+    /** Used in place of a material index when there isn't one. */
+    const std::uint32_t noMaterial = 0xFFFFFFFF;
+
+    /** Sections start on multiples of this from the start of the file. */
+    const std::uint64_t sectionAlignment = 16;
+
+    enum sectionType
+    {
+        Materials, Cameras, Lights, Spheres, Tris, Meshes, Vertices, Indices, MeshFiles, Strings, Instances,
+        NumberOfSections
+    };
+
+    struct section
+    {
+        /** Bytes from the start of the file. */
+        std::uint64_t offset;
+
+        /** The number of records in the section. */
+        std::uint64_t count;
+    };
+
+    struct header
+    {
+        char            magic[8];
+        std::uint32_t   version;
+
+        /** Index into the camera section of the camera that the scene is rendered from. */
+        std::uint32_t   mainCamera;
+        section         sections[NumberOfSections];
+    };
+
+    struct material
+    {
+        float baseColour[3];
+        float ambientIntensity[3];
+        float diffuseIntensity[3];
+        float specularIntensity[3];
+        float transmissionIntensity[3];
+        float reflectivityIntensity[3];
+        float shininessConstant;
+        float refractiveIndex;
+    };
+
+    struct camera
+    {
+        float position[3];
+        float rotation[3];
+        float fovHalfAngle;
+    };
+
+    enum lightType { Directional, Point };
+
+    struct light
+    {
+        std::uint32_t   type;
+
+        /** The direction of directional lights. */
+        float           position[3];
+        float           colour[3];
+
+        /** Only used by point lights. */
+        float           fallOff;
+    };
+
+    struct sphere
+    {
+        float           position[3];
+        float           radius;
+        std::uint32_t   material;
+    };
+
+    struct tri
+    {
+        float           position[3];
+        float           rotation[3];
+        float           scale[3];
+        float           vertices[3][3];
+        std::uint32_t   material;
+
+        /** Blended across the triangle when none of them are noMaterial. */
+        std::uint32_t   vertexMaterials[3];
+    };
+
+    /** A mesh asset that is stored in the vertex and index sections. */
+    struct mesh
+    {
+        /** The range of the vertex section that the mesh uses. Indices are relative to the first vertex. */
+        std::uint32_t   firstVertex;
+        std::uint32_t   vertexCount;
+
+        /** The range of the index section that the mesh uses, three indices per triangle. */
+        std::uint32_t   firstIndex;
+        std::uint32_t   triangleCount;
+    };
+
+    /** A mesh asset that is imported from an OBJ or PLY file when the scene is loaded. */
+    struct meshFile
+    {
+        /** The path to the file in the string section. Relative paths start from the compiled scene file. */
+        std::uint32_t   pathOffset;
+        std::uint32_t   pathLength;
+    };
+
+    enum instanceFlags
+    {
+        /** The asset indexes into the mesh file section rather than the mesh section. */
+        Imported = 1,
+
+        /** Use the instance's material for every face, even those that the asset gives a material. */
+        OverrideMaterials = 2
+    };
+
+    /** A placement of a mesh asset in the scene. */
+    struct instance
+    {
+        float           position[3];
+        float           rotation[3];
+        float           scale[3];
+
+        /** Used by every face that the asset doesn't give a material. */
+        std::uint32_t   material;
+        std::uint32_t   asset;
+
+        /** A combination of instanceFlags. */
+        std::uint32_t   flags;
+    };
+
+    /** A single entry in the vertex section. */
+    struct vertexPosition
+    {
+        float x, y, z;
+    };
+
+    /** @returns The size of a single record in the section. */
+    inline std::uint64_t recordSize(sectionType type)
+    {
+        switch (type)
+        {
+            case Materials: return sizeof(material);
+            case Cameras:   return sizeof(camera);
+            case Lights:    return sizeof(light);
+            case Spheres:   return sizeof(sphere);
+            case Tris:      return sizeof(tri);
+            case Meshes:    return sizeof(mesh);
+            case Vertices:  return sizeof(vertexPosition);
+            case Indices:   return sizeof(std::uint32_t);
+            case MeshFiles: return sizeof(meshFile);
+            case Strings:   return sizeof(char);
+            case Instances: return sizeof(instance);
+            default:        return 0;
+        }
+    }
+}
+
+
+#endif //A2MCGRAYTRACER_SCENEFORMAT_H
@@ -0,0 +1,80 @@
+/**
+ * @file ThreadPool.h
+ * @brief A fixed set of worker threads that split a range of jobs between them.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#ifndef A2MCGRAYTRACER_THREADPOOL_H
+#define A2MCGRAYTRACER_THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads that split a range of jobs between them.
+ * Jobs are handed out one index at a time so that expensive jobs (e.g. tiles
+ * full of mirrors) don't hold up the other threads.
+ * @paragraph Only one thread may call parallelFor() at a time. The calling thread
+ * also runs jobs, so a pool of one thread runs everything on the caller.
+ * @author Ryan Purse
+ * @version 1.0.0 [Initial Version: 19/10/2026]
+ */
+class ThreadPool
+{
+public:
+    /**
+     * @param threadCount The number of threads that run jobs, including the caller of parallelFor().
+     * 0 uses one thread per hardware thread.
+     */
+    explicit ThreadPool(unsigned int threadCount=0);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /**
+     * Calls job(i) for every i in [0, count) across all threads.
+     * Returns once every job has finished.
+     */
+    void parallelFor(int count, const std::function<void(int)> &job);
+
+    /** The number of threads that run jobs, including the caller. */
+    unsigned int getThreadCount() const
+    {
+        return static_cast<unsigned int>(mWorkers.size()) + 1;
+    }
+
+protected:
+    void workerLoop();
+
+    /** Takes the next job index until there are none left. */
+    void runJobs();
+
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mMutex;
+    std::condition_variable mWakeCondition;
+    std::condition_variable mDoneCondition;
+
+    // The current range of jobs. Only written while holding the mutex and no workers are busy.
+    const std::function<void(int)> *mJob{ nullptr };
+    int mJobCount{ 0 };
+    std::atomic<int> mNextJob{ 0 };
+
+    /** Incremented for every call to parallelFor() so that sleeping workers know there is new work. */
+    unsigned int mGeneration{ 0 };
+    unsigned int mBusyWorkers{ 0 };
+    bool mIsStopping{ false };
+};
+
+
+#endif //A2MCGRAYTRACER_THREADPOOL_H
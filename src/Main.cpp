@@ -4,10 +4,61 @@
  */
 
 #include "RayTracer.h"
+#include "Kernels.h"
+#include "Profiler.h"
 
 int main(int argc, char *argv[])
 {
-    RayTracer renderer({ 640, 480 });  // 640x480, 800x600
-    renderer.run();
+    // Any compiled scene files passed in can be switched to after the built in scenes.
+    std::vector<std::string> sceneFiles;
+    loadOptions options;
+    rendererOptions renderer;
+    std::string tracePath;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (argument == "--compact")
+        {
+            options.isCompactingGeometry = true;
+        }
+        else if (argument == "--out-of-core" && i + 1 < argc)
+        {
+            // The resident budget is given in megabytes.
+            options.residentBudget = static_cast<std::size_t>(std::stod(argv[++i]) * 1024.0 * 1024.0);
+        }
+        else if (argument == "--environment" && i + 1 < argc)
+        {
+            renderer.environmentPath = argv[++i];
+        }
+        else if (argument == "--isa" && i + 1 < argc)
+        {
+            // Overrides the row kernels picked for the CPU, which is mostly useful for comparing them.
+            kernels::isa isa;
+            if (kernels::readName(argv[++i], isa))  { kernels::select(isa); }
+            else                                    { std::cerr << "Unknown instruction set " << argv[i] << "\n"; }
+        }
+        else if (argument == "--trace" && i + 1 < argc)
+        {
+            tracePath = argv[++i];
+        }
+        else
+        {
+            sceneFiles.push_back(argument);
+        }
+    }
+
+#ifdef A2_PROFILING
+    if (!tracePath.empty()) { profiling::startTrace(tracePath); }
+#else
+    if (!tracePath.empty()) { std::cerr << "--trace needs a build with A2_PROFILING, ignoring it\n"; }
+#endif
+
+    std::cout << "Kernels: " << kernels::describeSelection() << "\n";
+    RayTracer rayTracer({ 640, 480 }, sceneFiles, options, renderer);  // 640x480, 800x600
+    rayTracer.run();
+
+#ifdef A2_PROFILING
+    if (!profiling::stopTrace()) { std::cerr << "Could not write the trace to " << tracePath << "\n"; }
+#endif
     return 0;
 }
@@ -9,6 +9,7 @@
  */
 
 #include "Camera.h"
+#include "Kernels.h"
 
 Camera::Camera(const glm::vec3 &position, const glm::vec3 &eulerAngle, const glm::vec3 &scale,
                const glm::ivec2 &screenResolution, const float &fovHalfAngle) :
@@ -34,10 +35,16 @@ void Camera::init()
     mInvProjectionMat = glm::perspective(
             glm::radians(mFovYHalfAngle * 2),
             mAspectRatio,
-            0.1f,
+            mNearPlane,
             100.f);
 
     mInvProjectionMat = glm::inverse(mInvProjectionMat);
+
+    // Cameras stay where the scene puts them unless something sets them to dynamic.
+    mIsStatic = true;
+
+    updateMat();
+    commit();
 }
 
 void Camera::update(float deltaTime)
@@ -51,37 +58,136 @@ void Camera::updateMat()
     mRotationMat = glm::toMat4(mRotation);
     mTranslationMat = glm::translate(mPosition);
 
-    mInvPrtMat = mTranslationMat * mRotationMat * mInvProjectionMat;
+    mNextInvPrtMat = mTranslationMat * mRotationMat * mInvProjectionMat;
 }
 
-Ray Camera::generateSingleRay(const glm::ivec2 &pixelPos)
+void Camera::commit()
 {
-    // Generate coords for the start point of the ray and the and the end point of the ray.
-    const float xNormal = map(static_cast<float>(pixelPos.x),
+    // Dynamic cameras are committed every frame, even when they haven't moved.
+    if (!mIsUncommitted && mNextInvPrtMat == mInvPrtMat)
+    {
+        if (mDirectionCache.empty()) { cacheDirections(); }
+        return;
+    }
+    mIsUncommitted = false;
+    mInvPrtMat = mNextInvPrtMat;
+
+    // w only depends on the depth, so the planes (and the rays between them) are linear in the pixel position.
+    const glm::vec2 screen(mScreenResolution);
+    const glm::vec3 nearCorner = unproject(glm::vec2(0.f), -1.f);
+    const glm::vec3 farCorner = unproject(glm::vec2(0.f), 1.f);
+    mOrigin = nearCorner;
+    mOriginStepX = (unproject(glm::vec2(screen.x, 0.f), -1.f) - nearCorner) / screen.x;
+    mOriginStepY = (unproject(glm::vec2(0.f, screen.y), -1.f) - nearCorner) / screen.y;
+    mDirection = farCorner - nearCorner;
+    mDirectionStepX = (unproject(glm::vec2(screen.x, 0.f), 1.f) - farCorner) / screen.x - mOriginStepX;
+    mDirectionStepY = (unproject(glm::vec2(0.f, screen.y), 1.f) - farCorner) / screen.y - mOriginStepY;
+
+    mDirectionCache.clear();
+    if (mIsStatic) { cacheDirections(); }
+}
+
+glm::vec3 Camera::unproject(const glm::vec2 &pixelPos, float z) const
+{
+    // Generate coords for the point of the ray on the plane.
+    const float xNormal = map(pixelPos.x,
                               0.f, static_cast<float>(mScreenResolution.x),
                               -1.f, 1.f);
-    const float yNormal = map(static_cast<float>(pixelPos.y),
+    const float yNormal = map(pixelPos.y,
                               0.f, static_cast<float>(mScreenResolution.y),
                               1.f, -1.f);
 
-    // So far, the view frustum is just a cube.
-    glm::vec4 nearPlane(xNormal, yNormal, - 1, 1);
-    glm::vec4 farPlane(xNormal, yNormal, 1, 1);
-
-    // Multiply the coords by the inverse perspective mat to give the typical view frustum.
-    // We also multiply be the transform and rotation mat.
-    nearPlane = mInvPrtMat * nearPlane;
-    farPlane = mInvPrtMat * farPlane;
+    // So far, the view frustum is just a cube. Multiply the coords by the inverse perspective mat to give the
+    // typical view frustum. We also multiply be the transform and rotation mat.
+    const glm::vec4 plane = mInvPrtMat * glm::vec4(xNormal, yNormal, z, 1.f);
 
     // Normalise the vector coords by their w component.
-    nearPlane /= nearPlane.w;
-    farPlane /= farPlane.w;
+    return glm::vec3(plane) / plane.w;
+}
+
+glm::mat4 Camera::getWorldToScreen() const
+{
+    // The inverse of unproject(), then normalised device coordinates to pixels (scaled by w so that it stays linear).
+    const glm::vec2 halfScreen = glm::vec2(mScreenResolution) * 0.5f;
+    glm::mat4 toPixels(1.f);
+    toPixels[0][0] = halfScreen.x;
+    toPixels[1][1] = -halfScreen.y;
+    toPixels[3][0] = halfScreen.x;
+    toPixels[3][1] = halfScreen.y;
+    return toPixels * glm::inverse(mInvPrtMat);
+}
 
-    // Convert to ray format where we have an origin and then a direction
+void Camera::cacheDirections()
+{
+    // Rows have to be generated without the cache, so it's only swapped in once it's full.
+    std::vector<glm::vec3> directions(mScreenResolution.x * mScreenResolution.y);
+    std::vector<Ray> rays(mScreenResolution.x);
+    for (int y = 0; y < mScreenResolution.y; ++y)
+    {
+        generateRow({ 0, y }, mScreenResolution.x, 1, rays.data());
+        for (int x = 0; x < mScreenResolution.x; ++x)
+        {
+            directions[y * mScreenResolution.x + x] = rays[x].mDirection;
+        }
+    }
+    mDirectionCache.swap(directions);
+}
+
+Ray Camera::generateSingleRay(const glm::ivec2 &pixelPos) const
+{
+    Ray ray;
+    generateRow(pixelPos, 1, 1, &ray);
+    return ray;
+}
+
+Ray Camera::generateSingleRay(const glm::vec2 &pixelPos) const
+{
+    // Rows are worked out the same way, one step at a time.
+    const glm::vec3 rowOrigin = mOrigin + pixelPos.y * mOriginStepY;
+    const glm::vec3 rowDirection = mDirection + pixelPos.y * mDirectionStepY;
     return {
-            nearPlane,
-            glm::normalize(farPlane - nearPlane),
+            rowOrigin + pixelPos.x * mOriginStepX,
+            glm::normalize(rowDirection + pixelPos.x * mDirectionStepX),
             glm::vec3(1.f)
     };
 }
 
+void Camera::generateRow(const glm::ivec2 &start, int count, int step, Ray *rays) const
+{
+    const float y = static_cast<float>(start.y);
+    const glm::vec3 rowOrigin = mOrigin + y * mOriginStepY;
+    const glm::vec3 rowDirection = mDirection + y * mDirectionStepY;
+    int i = 0;
+
+    if (!mDirectionCache.empty())
+    {
+        const glm::vec3 *directions = &mDirectionCache[start.y * mScreenResolution.x + start.x];
+        for (; i < count; ++i)
+        {
+            const float x = static_cast<float>(start.x + i * step);
+            rays[i] = Ray(rowOrigin + x * mOriginStepX, directions[i * step], glm::vec3(1.f));
+        }
+        return;
+    }
+
+    // The directions are normalised a chunk at a time by the widest kernels the CPU has, exactly as glm::normalize()
+    // would.
+    const kernels::table &kernel = kernels::get();
+    const int chunkSize = 64;
+    float directions[3][chunkSize];
+    for (; i < count; i += chunkSize)
+    {
+        const int chunkCount = glm::min(chunkSize, count - i);
+        kernel.normaliseDirections(&rowDirection.x, &mDirectionStepX.x, static_cast<float>(start.x + i * step),
+                                   static_cast<float>(step), chunkCount, directions[0], directions[1], directions[2]);
+        for (int lane = 0; lane < chunkCount; ++lane)
+        {
+            const float x = static_cast<float>(start.x + (i + lane) * step);
+            Ray &ray = rays[i + lane];
+            ray.mPosition = rowOrigin + x * mOriginStepX;
+            ray.mDirection = glm::vec3(directions[0][lane], directions[1][lane], directions[2][lane]);
+            ray.mEnergy = glm::vec3(1.f);
+        }
+    }
+}
+
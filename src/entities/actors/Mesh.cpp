@@ -0,0 +1,114 @@
+/**
+ * @file Mesh.cpp
+ * @brief A placement of a shared mesh asset with its own transform and material.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "Mesh.h"
+
+#include "GLM/gtx/transform.hpp"
+
+#include <limits>
+
+Mesh::Mesh(const glm::vec3 &position, const glm::vec3 &eulerRotation, const glm::vec3 &scale,
+           const actorLightingMaterial &material, const MeshAsset &asset, bool isOverridingFaceMaterials) :
+           Actor(position, eulerRotation, scale, material),
+           mAsset(&asset),
+           mIsOverridingFaceMaterials(isOverridingFaceMaterials)
+{
+    // Nothing moves meshes, so the transform is baked in unless the mesh gets set to dynamic.
+    calculateTransform();
+    commit();
+    mIsStatic = true;
+}
+
+void Mesh::calculateTransform()
+{
+    const glm::mat4 objectToWorld = glm::translate(mPosition) * glm::toMat4(mRotation) * glm::scale(mScale);
+    mNextTransform.objectToWorld = objectToWorld;
+    mNextTransform.worldToObject = glm::inverse(objectToWorld);
+    mNextTransform.normalToWorld = glm::transpose(glm::mat3(mNextTransform.worldToObject));
+}
+
+void Mesh::update(float deltaTime)
+{
+    calculateTransform();
+}
+
+void Mesh::commit()
+{
+    mTransform = mNextTransform;
+}
+
+aabb Mesh::getBounds() const
+{
+    return mAsset->getBounds().transform(mTransform.objectToWorld);
+}
+
+hitInfo Mesh::isIntersecting(const Ray &ray)
+{
+    // The direction isn't normalised after the transform so that distances match in both spaces.
+    const glm::vec3 origin = mTransform.worldToObject * glm::vec4(ray.mPosition, 1.f);
+    const glm::vec3 direction = mTransform.worldToObject * glm::vec4(ray.mDirection, 0.f);
+
+    float distance = std::numeric_limits<float>::max();
+    const long long triangle = mAsset->findClosestTriangle(origin, direction, distance, false);
+    if (triangle < 0) { return { false }; }
+    return getHit(ray, static_cast<std::size_t>(triangle), distance);
+}
+
+hitInfo Mesh::getHit(const Ray &ray, std::size_t triangle, float distance) const
+{
+    glm::vec3 normal = glm::normalize(mTransform.normalToWorld * mAsset->getFaceNormal(triangle));
+    const bool isBackFace = glm::dot(normal, ray.mDirection) > 0.f;
+    if (isBackFace) { normal = -normal; }  // We hit the back of the triangle.
+
+    const actorLightingMaterial *faceMaterial = mAsset->getFaceMaterial(triangle);
+    return {
+            true,
+            ray.mPosition + distance * ray.mDirection,
+            normal,
+            faceMaterial != nullptr && !mIsOverridingFaceMaterials ? *faceMaterial : mMaterial,
+            isBackFace
+    };
+}
+
+void Mesh::rasterize(rasterPrimitives &primitives) const
+{
+    if (mAsset->isPagedOut()) { return; }  // Only the clusters that rays ask for are in memory.
+
+    const std::size_t triangleCount = mAsset->getTriangleCount();
+    primitives.triangles.reserve(primitives.triangles.size() + triangleCount * 3);
+    for (std::size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        glm::vec3 corners[3];
+        mAsset->getTriangle(triangle, corners);
+        for (const glm::vec3 &corner : corners)
+        {
+            primitives.triangles.emplace_back(mTransform.objectToWorld * glm::vec4(corner, 1.f));
+        }
+    }
+}
+
+hitInfo Mesh::isIntersectingPrimitive(const Ray &ray, std::uint32_t primitive)
+{
+    const glm::vec3 origin = mTransform.worldToObject * glm::vec4(ray.mPosition, 1.f);
+    const glm::vec3 direction = mTransform.worldToObject * glm::vec4(ray.mDirection, 0.f);
+
+    float distance;
+    if (!mAsset->isIntersectingTriangle(primitive, origin, direction, distance)) { return { false }; }
+    return getHit(ray, primitive, distance);
+}
+
+bool Mesh::quickIsIntersecting(const Ray &ray)
+{
+    const glm::vec3 origin = mTransform.worldToObject * glm::vec4(ray.mPosition, 1.f);
+    const glm::vec3 direction = mTransform.worldToObject * glm::vec4(ray.mDirection, 0.f);
+
+    float distance = std::numeric_limits<float>::max();
+    return mAsset->findClosestTriangle(origin, direction, distance, true) >= 0;
+}
@@ -0,0 +1,382 @@
+/**
+ * @file MeshAsset.cpp
+ * @brief The triangles of a mesh along with a tree over them, shared by every instance of the mesh.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "MeshAsset.h"
+#include "MeshImporter.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <map>
+
+namespace
+{
+    /** What's at the start of every cluster in the page file. */
+    struct clusterHeader
+    {
+        std::uint32_t nodeCount;
+        std::uint32_t triangleCount;
+        std::uint32_t padding[2];
+    };
+
+    /**
+     * A cluster where it sits in the page file. The header is followed by the nodes of the tree over the triangles,
+     * the items of the tree, three corners per triangle and a material id per triangle.
+     */
+    struct clusterView
+    {
+        const Bvh::node     *nodes;
+        const std::uint32_t *items;
+        const glm::vec3     *corners;
+        const std::uint32_t *materialIds;
+    };
+
+    clusterView viewCluster(const char *data)
+    {
+        const auto *header = reinterpret_cast<const clusterHeader*>(data);
+        const auto *nodes = reinterpret_cast<const Bvh::node*>(header + 1);
+        const auto *items = reinterpret_cast<const std::uint32_t*>(nodes + header->nodeCount);
+        const auto *corners = reinterpret_cast<const glm::vec3*>(items + header->triangleCount);
+        const auto *materialIds = reinterpret_cast<const std::uint32_t*>(corners + header->triangleCount * 3);
+        return { nodes, items, corners, materialIds };
+    }
+
+    template<typename T>
+    void append(std::vector<char> &data, const T *values, std::size_t count)
+    {
+        const auto *bytes = reinterpret_cast<const char*>(values);
+        data.insert(data.end(), bytes, bytes + count * sizeof(T));
+    }
+
+    /** The most triangles that are gathered for the kernel at once. Leaves rarely hold more than four. */
+    const std::uint32_t triangleBatchSize = 8;
+
+    /**
+     * Tests the triangles of a leaf in batches with the selected kernel. The hits are then taken in order as though
+     * each triangle had been tested on its own, so the same one is found by every kernel.
+     * @param getCorners Called as getCorners(triangle, corners) to write the three corners of a triangle.
+     * @param hitTriangle Called as hitTriangle(triangle, distance) for each hit closer than maxDistance, after
+     * maxDistance has shrunk to it. Returns true to stop.
+     * @returns True if hitTriangle stopped.
+     */
+    template<typename GetCorners, typename HitTriangle>
+    bool intersectLeaf(const std::uint32_t *triangles, std::uint32_t count, const glm::vec3 &origin,
+                       const glm::vec3 &direction, float &maxDistance, GetCorners &&getCorners,
+                       HitTriangle &&hitTriangle)
+    {
+        const kernels::table &kernel = kernels::get();
+        glm::vec3 corners[triangleBatchSize][3];
+        float distances[triangleBatchSize];
+        for (std::uint32_t first = 0; first < count; first += triangleBatchSize)
+        {
+            const std::uint32_t batchSize = std::min(count - first, triangleBatchSize);
+            for (std::uint32_t i = 0; i < batchSize; ++i) { getCorners(triangles[first + i], corners[i]); }
+
+            std::uint32_t hits = kernel.intersectTriangles(&corners[0][0].x, static_cast<int>(batchSize), &origin.x,
+                                                           &direction.x, maxDistance, distances);
+            for (std::uint32_t i = 0; hits != 0; ++i, hits >>= 1u)
+            {
+                // Earlier hits in the batch may have come closer since.
+                if ((hits & 1u) == 0 || !(distances[i] < maxDistance)) { continue; }
+                maxDistance = distances[i];
+                if (hitTriangle(triangles[first + i], distances[i])) { return true; }
+            }
+        }
+        return false;
+    }
+}
+
+// Passed by reference to std::min, so it needs a definition.
+const std::uint32_t MeshAsset::trianglesPerCluster;
+
+MeshAsset::MeshAsset(const meshView &view, const std::vector<actorLightingMaterial> &faceMaterials) :
+    mView(view),
+    mFaceMaterials(faceMaterials)
+{
+    std::vector<aabb> triangleBounds(mView.triangleCount);
+    for (std::size_t i = 0; i < mView.triangleCount; ++i)
+    {
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            triangleBounds[i].grow(mView.positions[mView.indices[i * 3 + corner]]);
+        }
+        mBounds.grow(triangleBounds[i]);
+    }
+    mTree.build(triangleBounds);
+}
+
+bool MeshAsset::compact()
+{
+    if (mIsCompact) { return true; }
+
+    // Identical materials are only stored once. Materials are plain floats, so they can be compared bytewise.
+    auto isLess = [](const actorLightingMaterial &a, const actorLightingMaterial &b) {
+        return std::memcmp(&a, &b, sizeof(actorLightingMaterial)) < 0;
+    };
+    std::map<actorLightingMaterial, std::uint16_t, decltype(isLess)> uniqueIds(isLess);
+    std::vector<std::uint16_t> remappedIds(mFaceMaterials.size());
+    std::vector<actorLightingMaterial> uniqueMaterials;
+    for (std::size_t i = 0; i < mFaceMaterials.size(); ++i)
+    {
+        const auto unique = uniqueIds.emplace(mFaceMaterials[i], static_cast<std::uint16_t>(uniqueMaterials.size()));
+        if (unique.second)
+        {
+            if (uniqueMaterials.size() >= noMaterial) { return false; }
+            uniqueMaterials.push_back(mFaceMaterials[i]);
+        }
+        remappedIds[i] = unique.first->second;
+    }
+
+    compactGeometry geometry;
+    geometry.origin = mBounds.min;
+    geometry.step = glm::max(mBounds.max - mBounds.min, glm::vec3(std::numeric_limits<float>::min())) / 65535.f;
+
+    geometry.positions.resize(mView.vertexCount * 3);
+    for (std::size_t i = 0; i < mView.vertexCount; ++i)
+    {
+        const glm::vec3 quantised = glm::round((mView.positions[i] - geometry.origin) / geometry.step);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            geometry.positions[i * 3 + axis] = static_cast<std::uint16_t>(glm::clamp(quantised[axis], 0.f, 65535.f));
+        }
+    }
+
+    const std::size_t indexCount = mView.triangleCount * 3;
+    if (mView.vertexCount <= 0x10000) { geometry.shortIndices.assign(mView.indices, mView.indices + indexCount); }
+    else                              { geometry.indices.assign(mView.indices, mView.indices + indexCount); }
+
+    if (mView.materialIds != nullptr && !uniqueMaterials.empty())
+    {
+        geometry.materialIds.resize(mView.triangleCount);
+        for (std::size_t i = 0; i < mView.triangleCount; ++i)
+        {
+            const std::uint32_t id = mView.materialIds[i];
+            geometry.materialIds[i] = id < remappedIds.size() ? remappedIds[id] : noMaterial;
+        }
+    }
+
+    mCompact = std::move(geometry);
+    mFaceMaterials = std::move(uniqueMaterials);
+    mFaceMaterials.shrink_to_fit();
+    mIsCompact = true;
+
+    // The normals and the tree have to match the triangles as they are now, not as they were.
+    mCompact.normals.resize(mView.triangleCount);
+    std::vector<aabb> triangleBounds(mView.triangleCount);
+    mBounds = aabb();
+    for (std::size_t i = 0; i < mView.triangleCount; ++i)
+    {
+        glm::vec3 corners[3];
+        getTriangle(i, corners);
+        const glm::vec3 normal = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+        const float length = glm::length(normal);
+        mCompact.normals[i] = encodeOctahedral(length > 0.f ? normal / length : glm::vec3(0.f, 1.f, 0.f));
+        for (const glm::vec3 &corner : corners)
+        {
+            triangleBounds[i].grow(corner);
+        }
+        mBounds.grow(triangleBounds[i]);
+    }
+    mTree.refit(triangleBounds);
+
+    mView.positions = nullptr;
+    mView.indices = nullptr;
+    mView.materialIds = nullptr;
+    return true;
+}
+
+glm::vec3 MeshAsset::getCompactPosition(std::uint32_t vertex) const
+{
+    const std::uint16_t *position = &mCompact.positions[vertex * 3];
+    return mCompact.origin + glm::vec3(position[0], position[1], position[2]) * mCompact.step;
+}
+
+std::uint32_t MeshAsset::getIndex(std::size_t index) const
+{
+    if (!mIsCompact) { return mView.indices[index]; }
+    return mCompact.shortIndices.empty() ? mCompact.indices[index] : mCompact.shortIndices[index];
+}
+
+void MeshAsset::getTriangle(std::size_t triangle, glm::vec3 (&corners)[3]) const
+{
+    for (int corner = 0; corner < 3; ++corner)
+    {
+        const std::uint32_t index = getIndex(triangle * 3 + corner);
+        corners[corner] = mIsCompact ? getCompactPosition(index) : mView.positions[index];
+    }
+}
+
+void MeshAsset::pageOut(ClusterCache &cache)
+{
+    if (mPages != nullptr) { return; }
+
+    // The tree already puts triangles that are close to each other next to each other.
+    const std::vector<std::uint32_t> order = mTree.getItems();
+    const auto triangleCount = static_cast<std::uint32_t>(order.size());
+    std::vector<aabb> clusterBounds;
+    for (std::uint32_t first = 0; first < triangleCount; first += trianglesPerCluster)
+    {
+        const std::uint32_t count = std::min(trianglesPerCluster, triangleCount - first);
+        std::vector<aabb> triangleBounds(count);
+        std::vector<glm::vec3> corners(count * 3);
+        std::vector<std::uint32_t> materialIds(count);
+        for (std::uint32_t i = 0; i < count; ++i)
+        {
+            glm::vec3 triangle[3];
+            getTriangle(order[first + i], triangle);
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                corners[i * 3 + corner] = triangle[corner];
+                triangleBounds[i].grow(triangle[corner]);
+            }
+            materialIds[i] = getMaterialId(order[first + i]);
+        }
+
+        Bvh tree;
+        tree.build(triangleBounds);
+        const clusterHeader header { static_cast<std::uint32_t>(tree.getNodes().size()), count, { 0, 0 } };
+
+        std::vector<char> data;
+        append(data, &header, 1);
+        append(data, tree.getNodes().data(), tree.getNodes().size());
+        append(data, tree.getItems().data(), tree.getItems().size());
+        append(data, corners.data(), corners.size());
+        append(data, materialIds.data(), materialIds.size());
+
+        const std::uint32_t cluster = cache.addCluster(data);
+        if (first == 0) { mFirstCluster = cluster; }
+        mPagedBytes += data.size();
+        clusterBounds.push_back(tree.getBounds());
+    }
+
+    // Only the tree over the clusters stays in memory.
+    mTree.build(clusterBounds, 1);
+    mCompact = compactGeometry();
+    mIsCompact = false;
+    mView.positions = nullptr;
+    mView.indices = nullptr;
+    mView.materialIds = nullptr;
+    mPages = &cache;
+}
+
+long long MeshAsset::findClosestTriangle(const glm::vec3 &origin, const glm::vec3 &direction, float &distance,
+                                         bool stopAtFirst) const
+{
+    long long closest = -1;
+    if (mPages != nullptr)
+    {
+        mTree.traverse(origin, direction, distance, [&](std::uint32_t cluster, float &maxDistance) {
+            // Keep going without it, so that the ray asks for every cluster it needs in one go.
+            const char *data = mPages->find(mFirstCluster + cluster);
+            if (data == nullptr) { return false; }
+
+            const clusterView view = viewCluster(data);
+            auto getCorners = [&](std::uint32_t triangle, glm::vec3 (&corners)[3]) {
+                std::copy_n(&view.corners[triangle * 3], 3, corners);
+            };
+            auto hitLeaf = [&](const std::uint32_t *triangles, std::uint32_t count, float &clusterMaxDistance) {
+                return intersectLeaf(triangles, count, origin, direction, clusterMaxDistance, getCorners,
+                                     [&](std::uint32_t triangle, float t) {
+                    maxDistance = distance = t;
+                    closest = static_cast<long long>(cluster) * trianglesPerCluster + triangle;
+                    return stopAtFirst;
+                });
+            };
+            return Bvh::traverseLeaves(view.nodes, view.items, origin, direction, maxDistance, hitLeaf);
+        });
+        return closest;
+    }
+
+    mTree.traverseLeaves(origin, direction, distance,
+                         [&](const std::uint32_t *triangles, std::uint32_t count, float &maxDistance) {
+        auto getCorners = [&](std::uint32_t triangle, glm::vec3 (&corners)[3]) { getTriangle(triangle, corners); };
+        return intersectLeaf(triangles, count, origin, direction, maxDistance, getCorners,
+                             [&](std::uint32_t triangle, float t) {
+            distance = t;
+            closest = triangle;
+            return stopAtFirst;
+        });
+    });
+
+    return closest;
+}
+
+bool MeshAsset::isIntersectingTriangle(std::size_t triangle, const glm::vec3 &origin, const glm::vec3 &direction,
+                                       float &distance) const
+{
+    glm::vec3 corners[3];
+    getTriangle(triangle, corners);
+    return kernels::get().intersectTriangles(&corners[0].x, 1, &origin.x, &direction.x,
+                                             std::numeric_limits<float>::max(), &distance) != 0;
+}
+
+glm::vec3 MeshAsset::getFaceNormal(std::size_t triangle) const
+{
+    if (mPages != nullptr)
+    {
+        // The cluster was hit by the ray that's asking, so it's still resident.
+        const clusterView view = viewCluster(mPages->find(mFirstCluster + triangle / trianglesPerCluster));
+        const glm::vec3 *corners = &view.corners[triangle % trianglesPerCluster * 3];
+        return glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+    }
+    if (mIsCompact) { return decodeOctahedral(mCompact.normals[triangle]); }
+
+    const std::uint32_t *index = &mView.indices[triangle * 3];
+    const glm::vec3 &v0 = mView.positions[index[0]];
+    return glm::cross(mView.positions[index[1]] - v0, mView.positions[index[2]] - v0);
+}
+
+std::uint32_t MeshAsset::getMaterialId(std::size_t triangle) const
+{
+    if (mPages != nullptr)
+    {
+        const clusterView view = viewCluster(mPages->find(mFirstCluster + triangle / trianglesPerCluster));
+        return view.materialIds[triangle % trianglesPerCluster];
+    }
+    if (mIsCompact)
+    {
+        if (mCompact.materialIds.empty()) { return noMaterialId; }
+        const std::uint16_t id = mCompact.materialIds[triangle];
+        return id == noMaterial ? noMaterialId : id;
+    }
+    return mView.materialIds == nullptr ? noMaterialId : mView.materialIds[triangle];
+}
+
+const actorLightingMaterial *MeshAsset::getFaceMaterial(std::size_t triangle) const
+{
+    if (mFaceMaterials.empty()) { return nullptr; }
+    const std::uint32_t id = getMaterialId(triangle);
+    return id < mFaceMaterials.size() ? &mFaceMaterials[id] : nullptr;
+}
+
+std::size_t MeshAsset::getGeometryBytes() const
+{
+    if (mPages != nullptr) { return mPagedBytes + mFaceMaterials.size() * sizeof(actorLightingMaterial); }
+    if (mIsCompact)
+    {
+        return (mCompact.positions.size() + mCompact.shortIndices.size() + mCompact.materialIds.size())
+               * sizeof(std::uint16_t)
+               + (mCompact.indices.size() + mCompact.normals.size()) * sizeof(std::uint32_t)
+               + mFaceMaterials.size() * sizeof(actorLightingMaterial);
+    }
+
+    return mView.vertexCount * sizeof(glm::vec3)
+           + mView.triangleCount * 3 * sizeof(std::uint32_t)
+           + (mView.materialIds != nullptr ? mView.triangleCount * sizeof(std::uint32_t) : 0)
+           + mFaceMaterials.size() * sizeof(actorLightingMaterial);
+}
+
+std::size_t MeshAsset::getBytesUsed() const
+{
+    const std::size_t ownedBytes = mIsCompact ? getGeometryBytes()
+                                              : mFaceMaterials.size() * sizeof(actorLightingMaterial);
+    return mTree.getBytesUsed() + ownedBytes;
+}
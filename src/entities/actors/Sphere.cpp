@@ -23,12 +23,24 @@ Sphere::Sphere(const glm::vec3 &position, const actorLightingMaterial &lightingM
     init();
 }
 
+Sphere::Sphere(const glm::vec3 &position, const actorLightingMaterial &lightingMaterial, const float &radius,
+               float amplitude, float frequency) :
+    Actor(position, lightingMaterial),
+    mRadius(radius),
+    mIsBobbing(true)
+{
+    init();
+    mAmplitude = amplitude;
+    mFrequency = frequency;
+}
+
 hitInfo Sphere::isIntersecting(const Ray &ray)
 {
-    glm::vec3 delta = mPosition - ray.mPosition;
+    glm::vec3 delta = mCentre - ray.mPosition;
     float deltaDot = glm::dot(delta, ray.mDirection);
 
-    if (deltaDot < 0) { return { false }; }  // The ray went backward so we won't hit anything
+    // The ray went backward so we won't hit anything, unless it started inside.
+    if (deltaDot < 0 && glm::dot(delta, delta) >= mRadius * mRadius) { return { false }; }
 
     const float closestPoint = glm::length(delta - (deltaDot * ray.mDirection));
 
@@ -37,26 +49,31 @@ hitInfo Sphere::isIntersecting(const Ray &ray)
 
     // Work out the position that the ray intercepted the sphere.
     const float x = glm::sqrt(mRadius * mRadius - closestPoint * closestPoint);
-    glm::vec3 hitPosition = ray.mPosition + (deltaDot - x) * ray.mDirection;
+
+    // Refracted rays start inside, where the near side is behind them and they hit the far side instead.
+    const bool isInside = deltaDot < x;
+    glm::vec3 hitPosition = ray.mPosition + (isInside ? deltaDot + x : deltaDot - x) * ray.mDirection;
 
     // Ray hit normal
-    glm::vec3 hitNormal = glm::normalize(hitPosition - mPosition);
+    glm::vec3 hitNormal = glm::normalize(hitPosition - mCentre);
 
     return {
             true,
             hitPosition,
-            hitNormal,
-            mMaterial
+            isInside ? -hitNormal : hitNormal,
+            mMaterial,
+            isInside
     };
 }
 
 bool Sphere::quickIsIntersecting(const Ray &ray)
 {
     // The same as isIntersecting, but we don't need to work out all the other information.
-    glm::vec3 delta = mPosition - ray.mPosition;
+    glm::vec3 delta = mCentre - ray.mPosition;
     float deltaDot = glm::dot(delta, ray.mDirection);
 
-    if (deltaDot < 0) { return false; }  // The ray went backward so we won't hit anything
+    // The ray went backward so we won't hit anything, unless it started inside where it can't get out.
+    if (deltaDot < 0) { return glm::dot(delta, delta) < mRadius * mRadius; }
 
     const float closestPoint = glm::length(delta - (deltaDot * ray.mDirection));
 
@@ -66,6 +83,24 @@ bool Sphere::quickIsIntersecting(const Ray &ray)
     return true;
 }
 
+aabb Sphere::getBounds() const
+{
+    aabb bounds;
+    bounds.grow(mCentre - mRadius);
+    bounds.grow(mCentre + mRadius);
+    return bounds;
+}
+
+void Sphere::rasterize(rasterPrimitives &primitives) const
+{
+    primitives.spheres.emplace_back(mCentre, mRadius);
+}
+
+hitInfo Sphere::isIntersectingPrimitive(const Ray &ray, std::uint32_t primitive)
+{
+    return isIntersecting(ray);  // The sphere is the only primitive.
+}
+
 void Sphere::update(float deltaTime)
 {
     if (mIsBobbing)
@@ -82,9 +117,16 @@ void Sphere::update(float deltaTime)
     }
 }
 
+void Sphere::commit()
+{
+    mCentre = mPosition;
+}
+
 void Sphere::init()
 {
     mStaticPos = mPosition;
+    mCentre = mPosition;
+    mIsStatic = !mIsBobbing;
     mTime = 0;
     mAmplitude = 1;
     mFrequency = 1;
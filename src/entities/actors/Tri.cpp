@@ -9,14 +9,27 @@
 
 #include "Tri.h"
 
+#include <iterator>
+
 Tri::Tri(const glm::vec3 &mPosition, const glm::vec3 &eulerRotation, const glm::vec3 &mScale,
          const actorLightingMaterial &material, vertex *vertices, bool useVertexMat) :
          Actor(mPosition, eulerRotation, mScale, material),
-         mVertices{ vertices[0], vertices[1], vertices[2] },
-         mUseVertexMaterial(useVertexMat)
+         mVertexPositions{ vertices[0].position, vertices[1].position, vertices[2].position }
 {
+    if (useVertexMat)
+    {
+        mVertexMaterials = std::make_unique<actorLightingMaterial[]>(3);
+        for (int i = 0; i < 3; ++i)
+        {
+            mVertexMaterials[i] = vertices[i].material;
+        }
+    }
 
-    transformVertices();  // for safety.
+    // Bake the triangle into world space. Nothing moves triangles, so this is the only time it happens
+    // unless the triangle gets set to dynamic.
+    transformVertices();
+    commit();
+    mIsStatic = true;
 }
 
 void Tri::transformVertices()
@@ -28,89 +41,99 @@ void Tri::transformVertices()
     glm::mat4 transform = translationMat * rotMat * scaleMat;
 
     // Transform vertices
-    for (auto &vertex : mVertices)
+    glm::vec3 *globalPositions = mNextCollision.globalPositions;
+    for (int i = 0; i < 3; ++i)
     {
-        vertex.globalPosition = transform * glm::vec4(vertex.position, 1);
+        globalPositions[i] = transform * glm::vec4(mVertexPositions[i], 1);
     }
 
     // Transform surface normal
-    glm::vec3 ab = mVertices[1].globalPosition - mVertices[0].globalPosition;
-    glm::vec3 ac = mVertices[2].globalPosition - mVertices[0].globalPosition;
-    mSurfaceNormal = glm::normalize(glm::cross(ab, ac));
+    glm::vec3 ab = globalPositions[1] - globalPositions[0];
+    glm::vec3 ac = globalPositions[2] - globalPositions[0];
+    mNextCollision.surfaceNormal = glm::normalize(glm::cross(ab, ac));
+
+    constructCollisionEdges(mNextCollision);
+}
 
-    constructCollisionEdges();
+void Tri::commit()
+{
+    mCollision = mNextCollision;
 }
 
 hitInfo Tri::isIntersecting(const Ray &ray)
 {
-    if (mW1Denominator == 0.f) { return { false }; }  // Degenerate triangle case.
+    const collisionData &c = mCollision;
+    if (c.w1Denominator == 0.f) { return { false }; }  // Degenerate triangle case.
 
-    const vertex *v0 = mVertices;  // Gets the first vertex in the array
+    const glm::vec3 &v0 = c.globalPositions[0];  // Gets the first vertex in the array
 
     // Ray plane intersection
-    const float dot = glm::dot(ray.mDirection, mSurfaceNormal);
+    const float dot = glm::dot(ray.mDirection, c.surfaceNormal);
     if (dot == 0) { return { false }; }  // We are parallel with the triangle.
 
-    const float scalarToP = glm::dot(v0->globalPosition - ray.mPosition, mSurfaceNormal) / (dot);
+    const float scalarToP = glm::dot(v0 - ray.mPosition, c.surfaceNormal) / (dot);
     if (scalarToP <= 0.f) { return { false }; }  // The ray went the opposite direction.
 
     const glm::vec3 point = ray.mPosition + scalarToP * ray.mDirection;
 
     // Point in triangle
     float s5, w1;
-    switch (mOrientation)
+    switch (c.orientation)
     {
         case Xy:
         default:
-            s5 = point.y - v0->globalPosition.y;
-            w1 = (v0->globalPosition.x * s1 + s5 * s2 - point.x * s1) / mW1Denominator;
+            s5 = point.y - v0.y;
+            w1 = (v0.x * c.s1 + s5 * c.s2 - point.x * c.s1) / c.w1Denominator;
             break;
         case Xz:
-            s5 = point.z - v0->globalPosition.z;
-            w1 = (v0->globalPosition.x * s1 + s5 * s2 - point.x * s1) / mW1Denominator;
+            s5 = point.z - v0.z;
+            w1 = (v0.x * c.s1 + s5 * c.s2 - point.x * c.s1) / c.w1Denominator;
             break;
         case Yz:
-            s5 = point.z - v0->globalPosition.z;
-            w1 = (v0->globalPosition.y * s1 + s5 * s2 - point.y * s1) / mW1Denominator;
+            s5 = point.z - v0.z;
+            w1 = (v0.y * c.s1 + s5 * c.s2 - point.y * c.s1) / c.w1Denominator;
             break;
     }
 
     float w2;
-    if (s1 != 0.f)
+    if (c.s1 != 0.f)
     {
-        w2 = (s5 - w1 * s3) / s1;
+        w2 = (s5 - w1 * c.s3) / c.s1;
     }
     else
     {
         // A and C are vertically aligned so we can just normalise for w2.
-        w2 = mOrientation == Yz ?
-                normalise(point.y, mVertices[0].globalPosition.y, mVertices[2].globalPosition.y) :
-                normalise(point.x, mVertices[0].globalPosition.x, mVertices[2].globalPosition.x);
+        w2 = c.orientation == Yz ?
+                normalise(point.y, c.globalPositions[0].y, c.globalPositions[2].y) :
+                normalise(point.x, c.globalPositions[0].x, c.globalPositions[2].x);
     }
 
 
     if (w1 <= 0.f || w2 <= 0.f || w1 + w2 >= 1) { return { false }; } // Our point lies out side of the triangle.
 
     // We've hit the triangle
-    glm::vec3 surfaceNorm = dot >= 0 ? -mSurfaceNormal : mSurfaceNormal; // Was it the back of the triangle or not?
-    if (!mUseVertexMaterial)
+    const bool isBackFace = dot >= 0;
+    glm::vec3 surfaceNorm = isBackFace ? -c.surfaceNormal : c.surfaceNormal; // Was it the back of the triangle or not?
+    if (!mVertexMaterials)
     {
         return {  // Use the base material provided by the tri
                 true,
                 point,
                 surfaceNorm,
-                mMaterial
+                mMaterial,
+                isBackFace
         };
     }
 
     // lerp between the different materials at each vertex
-    actorLightingMaterial abLerp = mix(mVertices[0].material, mVertices[1].material, w1);
-    actorLightingMaterial abcLerp = mix(abLerp, mVertices[2].material, w2);
+    actorLightingMaterial abLerp = mix(mVertexMaterials[0], mVertexMaterials[1], w1);
+    actorLightingMaterial abcLerp = mix(abLerp, mVertexMaterials[2], w2);
     return {
             true,
             point,
             surfaceNorm,
-            abcLerp
+            abcLerp,
+            isBackFace
     };
 }
 
@@ -119,49 +142,73 @@ bool Tri::quickIsIntersecting(const Ray &ray)
     return isIntersecting(ray).hit;  // There isn't anything we can optimise
 }
 
+aabb Tri::getBounds() const
+{
+    aabb bounds;
+    for (const glm::vec3 &position : mCollision.globalPositions)
+    {
+        bounds.grow(position);
+    }
+    return bounds;
+}
+
+void Tri::rasterize(rasterPrimitives &primitives) const
+{
+    if (mCollision.w1Denominator == 0.f) { return; }  // Rays never hit degenerate triangles either.
+    primitives.triangles.insert(primitives.triangles.end(), std::begin(mCollision.globalPositions),
+                                std::end(mCollision.globalPositions));
+}
+
+hitInfo Tri::isIntersectingPrimitive(const Ray &ray, std::uint32_t primitive)
+{
+    return isIntersecting(ray);  // The triangle is the only primitive.
+}
+
 void Tri::update(float deltaTime)
 {
     transformVertices();
 }
 
-void Tri::constructCollisionEdges()
+void Tri::constructCollisionEdges(collisionData &collision)
 {
+    const glm::vec3 *globalPositions = collision.globalPositions;
+
     // The triangle lies flat.
-    if (mSurfaceNormal == glm::vec3(0.f, 1.f, 0.f)
-        || mSurfaceNormal == glm::vec3(0.f, -1.f, 0.f))
+    if (collision.surfaceNormal == glm::vec3(0.f, 1.f, 0.f)
+        || collision.surfaceNormal == glm::vec3(0.f, -1.f, 0.f))
     {
-        mOrientation = Xz;  // use X and Z for point in triangle.
+        collision.orientation = Xz;  // use X and Z for point in triangle.
 
-        s1 = mVertices[2].globalPosition.z - mVertices[0].globalPosition.z;
-        s2 = mVertices[2].globalPosition.x - mVertices[0].globalPosition.x;
-        s3 = mVertices[1].globalPosition.z - mVertices[0].globalPosition.z;
-        s4 = mVertices[1].globalPosition.x - mVertices[0].globalPosition.x;
+        collision.s1 = globalPositions[2].z - globalPositions[0].z;
+        collision.s2 = globalPositions[2].x - globalPositions[0].x;
+        collision.s3 = globalPositions[1].z - globalPositions[0].z;
+        collision.s4 = globalPositions[1].x - globalPositions[0].x;
     }
 
     // The triangle is vertical.
-    else if (mSurfaceNormal == glm::vec3(1.f, 0.f, 0.f)
-            || mSurfaceNormal == glm::vec3(-1.f, 0.f, 0.f))
+    else if (collision.surfaceNormal == glm::vec3(1.f, 0.f, 0.f)
+            || collision.surfaceNormal == glm::vec3(-1.f, 0.f, 0.f))
     {
-        mOrientation = Yz;  // use Y and Z for point in triangle
+        collision.orientation = Yz;  // use Y and Z for point in triangle
 
-        s1 = mVertices[2].globalPosition.z - mVertices[0].globalPosition.z;
-        s2 = mVertices[2].globalPosition.y - mVertices[0].globalPosition.y;
-        s3 = mVertices[1].globalPosition.z - mVertices[0].globalPosition.z;
-        s4 = mVertices[1].globalPosition.y - mVertices[0].globalPosition.y;
+        collision.s1 = globalPositions[2].z - globalPositions[0].z;
+        collision.s2 = globalPositions[2].y - globalPositions[0].y;
+        collision.s3 = globalPositions[1].z - globalPositions[0].z;
+        collision.s4 = globalPositions[1].y - globalPositions[0].y;
     }
 
     // Default case
     else
     {
-        mOrientation = Xy;  // use X and Y for point in triangle
+        collision.orientation = Xy;  // use X and Y for point in triangle
 
-        s1 = mVertices[2].globalPosition.y - mVertices[0].globalPosition.y;
-        s2 = mVertices[2].globalPosition.x - mVertices[0].globalPosition.x;
-        s3 = mVertices[1].globalPosition.y - mVertices[0].globalPosition.y;
-        s4 = mVertices[1].globalPosition.x - mVertices[0].globalPosition.x;
+        collision.s1 = globalPositions[2].y - globalPositions[0].y;
+        collision.s2 = globalPositions[2].x - globalPositions[0].x;
+        collision.s3 = globalPositions[1].y - globalPositions[0].y;
+        collision.s4 = globalPositions[1].x - globalPositions[0].x;
     }
 
-    mW1Denominator = (s3 * s2) - (s4 * s1);
+    collision.w1Denominator = (collision.s3 * collision.s2) - (collision.s4 * collision.s1);
 }
 
 actorLightingMaterial Tri::mix(const actorLightingMaterial &mat1, const actorLightingMaterial &mat2, const float &alpha)
@@ -174,6 +221,7 @@ actorLightingMaterial Tri::mix(const actorLightingMaterial &mat1, const actorLig
         glm::mix(mat1.specularIntensity, mat2.specularIntensity, alphaVec),
         glm::mix(mat1.transmissionIntensity, mat2.transmissionIntensity, alphaVec),
         glm::mix(mat1.reflectivityIntensity, mat2.transmissionIntensity, alphaVec),
-        glm::mix(mat1.shininessConstant, mat2.shininessConstant, alpha)
+        glm::mix(mat1.shininessConstant, mat2.shininessConstant, alpha),
+        glm::mix(mat1.refractiveIndex, mat2.refractiveIndex, alpha)
     };
 }
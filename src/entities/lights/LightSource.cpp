@@ -14,13 +14,17 @@
 // Directional Light source
 LightSource::LightSource(const glm::vec3 &direction, const glm::vec3 &colour) :
     Entity(), mType(Directional), mDirection(glm::normalize(direction)), mMaterial(colour), mFallOffConstant(0.f)
-{}
+{
+    mIsStatic = true;  // Lights have nothing to update.
+}
 
 // Point Light source
 LightSource::LightSource(const glm::vec3 &position, const glm::vec3 &colour, const float &fallOff) :
     Entity(position, glm::vec3(0.f), glm::vec3(1.f)), mType(Point),
     mDirection(0.f), mMaterial(colour), mFallOffConstant(fallOff)
-{}
+{
+    mIsStatic = true;  // Lights have nothing to update.
+}
 
 Ray LightSource::getRayToLight(glm::vec3 pos)
 {
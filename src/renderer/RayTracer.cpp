@@ -1,5 +1,5 @@
 /**
- * @file RayTracer.cpp.cc
+ * @file RayTracer.cpp
  * @brief The renderer that displays the world to the screen.
  * Project: A2McgRayTracer
  * @author Ryan Purse
@@ -8,290 +8,169 @@
  */
 
 #include "RayTracer.h"
+#include "Profiler.h"
 
-RayTracer::RayTracer(const glm::ivec2 &mWindowSize) :
-    mWindowSize(mWindowSize),
-    mShowAmbient(true), mShowDiffuse(true), mShowSpecular(true), mShowSkybox(true)
+namespace
 {
-    if(!mcg::init(mWindowSize)) { throw std::exception(); }
-    changeScene(lvl::TheDefaultScene);
-}
-
-void RayTracer::run()
-{
-    static unsigned int current = 0;
-    static unsigned int last = 0;
-
-    while (mcg::processFrame() && mIsRunning)
+    /** The window prints everything that the renderer has to say to the console, from the first scene on. */
+    rendererOptions loggingToConsole(rendererOptions renderer)
     {
-        update();
-        render();
-        event();  // overrides the event system within mcg::processFrame() depending on timing.
-
-        // Get how long the frame took with some useful information
-        current = SDL_GetTicks();
-        float delta = (static_cast<float>(current - last)) / 1000.f;
-        last = current;
-        std::cout   << "\rFrame: " << mFrameCount++
-                    << "\tFrame Time: " << delta
-                    << "\tBounce Limit: " << mBounceLimit << "/" << mMaxBounceLimit;
-        // Try and increase the bounce limit of the rays.
-        mBounceLimit = glm::min(mMaxBounceLimit, mBounceLimit + 1);
+        renderer.log = &std::cout;
+        return renderer;
     }
 }
 
-void RayTracer::updateAndHold()
-{
-    update();
-    render();
-    mcg::showAndHold();  // Waits until the user exits the program.
-}
-
-void RayTracer::event()
+RayTracer::RayTracer(const glm::ivec2 &mWindowSize, const std::vector<std::string> &sceneFiles,
+                     const loadOptions &options, const rendererOptions &renderer) :
+    RenderCore(mWindowSize, sceneFiles, options, loggingToConsole(renderer))
 {
-    SDL_Event sdlEvent;
+    if(!mcg::init(mWindowSize)) { throw std::exception(); }
 
-    while (SDL_PollEvent(&sdlEvent) != 0)
-    {
-        if (sdlEvent.type == SDL_QUIT) { mIsRunning = false; }
-        if (sdlEvent.type == SDL_KEYDOWN)
-        {
-            switch (sdlEvent.key.keysym.sym)
-            {
-                case SDLK_ESCAPE:
-                    mIsRunning = false;
-                    break;
-                case SDLK_0:
-                    changeScene(lvl::TheDefaultScene);
-                    mFrameCount = 0;
-                    mBounceLimit = 1;
-                    break;
-                case SDLK_1:
-                    changeScene(lvl::Triangle);
-                    mFrameCount = 0;
-                    mBounceLimit = 1;
-                    break;
-                case SDLK_2:
-                    changeScene(lvl::MirrorRoom);
-                    mFrameCount = 0;
-                    mBounceLimit = 1;
-                    break;
-                case SDLK_3:
-                    changeScene(lvl::BasicBall);
-                    mFrameCount = 0;
-                    mBounceLimit = 1;
-            }
-        }
-    }
+    // mcg::processFrame() throws away any events that it finds, so keep a copy of every event as it arrives.
+    SDL_AddEventWatch(holdEvent, this);
 }
 
-void RayTracer::update()
+RayTracer::~RayTracer()
 {
-    for (auto &entity : mEntities)
-    {
-        entity->update(0.16f);  // Updates as if it was running at 60fps.
-    }
+    // The frame in flight could still be marking tiles for present().
+    cancelFrame();
+    SDL_DelEventWatch(holdEvent, this);
 }
 
-void RayTracer::render()
+void RayTracer::run()
 {
-    // Loop through each pixel coord pair on the screen.
-    for (int y = 0; y < mWindowSize.y; ++y)
+    // The frame renders in the background so that events and the screen can be kept up to date at display rate.
+    while (mIsRunning)
     {
-        for (int x = 0; x < mWindowSize.x; ++x)
         {
-            // Pair the coord together.
-            glm::ivec2 pixelPosition(x, y);
-
-            // Create a ray from our camera
-            Ray ray = mMainCamera->generateSingleRay(pixelPosition);
-
-            // Cast it into the world to get our colour.
-            glm::vec3 colour = trace(ray);
+            std::lock_guard<std::recursive_mutex> lock(mLock);
+            updateScene();
 
-            // Draw the pixel to MCG pixel buffer.
-            mcg::drawPixel(pixelPosition, colour);
-        }
-    }
-}
+            if (!mFrameJob.valid())  // Nothing in flight. Either the first frame or it was cancelled.
+            {
+                startFrame();
+            }
+            else if (mFrameJob.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+            {
+                mFrameJob.get();
+                finishFrame();
+                startFrame();
+            }
 
-void RayTracer::changeScene(unsigned int index)
-{
-    if (index == mCurrentScene) { return; }  // Already on the correct scene
-    mCurrentScene = index;
-    // Deallocate memory from the old scene.
-    if (!mEntities.empty())
-    {
-        for (auto &entity : mEntities)
-        {
-            delete entity;
+            present();
+            event();
         }
-        // Reset vectors back to zero elements. Possibly not needed since we use a copy constructor later on.
-        mEntities.clear();
-        mActors.clear();
-        mLights.clear();
-        mMainCamera = nullptr;
+        if (mIsRunning && !mcg::processFrame()) { mIsRunning = false; }
     }
-
-    scene level = loadScene(mWindowSize, index);
-    if (!level.success) { throw std::exception(); }  // The scene doesn't exits. Should never get here.
-
-    // Give ownership to the Ray Tracer
-    mEntities = level.entities;
-    mActors = level.actors;
-    mLights = level.lights;
-    mMainCamera = level.mainCamera;
+    cancelFrame();
 }
 
-glm::vec3 RayTracer::trace(Ray &originRay)
+void RayTracer::updateAndHold()
 {
-    glm::vec3 colour(0);
-    Ray ray = originRay;
-    for (int i = 0; i < mBounceLimit; ++i)
     {
-        hitInfo hit = getHitInWorld(ray);
-
-        // Shadow tracing changes the energy value for the next ray so we take a copy now.
-        glm::vec3 energy = ray.mEnergy;
-
-        // Trace shadow will also reflect the ray.
-        colour += energy * traceShadows(ray, hit);
-
-        if (glm::dot(ray.mEnergy, ray.mEnergy) < 0.f)
-        {
-            break;
-        }
+        std::lock_guard<std::recursive_mutex> lock(mLock);
+        update();
+        commit();
+        selectViews();
+        render();
+        present();
     }
-    return colour;
+    mcg::showAndHold();  // Waits until the user exits the program.
 }
 
-glm::vec3 RayTracer::traceShadows(Ray &ray, const hitInfo &hit)
+void RayTracer::present()
 {
-    if (!hit.hit)
+    A2_PROFILE_SCOPE(Presentation);
+    if (mViews.empty()) { return; }
+
+    const int tilesPerView = mTileCount.x * mTileCount.y;
+    const unsigned int view = glm::min(mShownView, getViewCount() - 1);
+    const bool isNewView = view != mPresentedView;
+    mPresentedView = view;
+    for (int tileIndex = 0; tileIndex < tilesPerView; ++tileIndex)
     {
-        ray.mEnergy = glm::vec3(0.f);
-        return mShowSkybox ? sampleSkybox(ray.mDirection) : glm::vec3(0.f);
-    }
+        const bool isDirty = mDirtyTiles[view * tilesPerView + tileIndex].exchange(false, std::memory_order_acquire);
+        if (!isDirty && !isNewView) { continue; }
 
-    // Lighting Calculation.
-    glm::vec3 diffuseColour(0);
-    glm::vec3 specularColour(0);
-    for (auto &light : mLights)
-    {
-        // Construct a rayToLight and fire it towards the light
-        Ray rayToLight = light->getRayToLight(hit.hitPosition);
-        rayToLight.mPosition += hit.hitNormal * 0.001f;  // Offset to avoid artifacts from floating point precision.
-
-        if (traceToLightSource(rayToLight, light))
+        const glm::ivec2 tileStart = glm::ivec2(tileIndex % mTileCount.x, tileIndex / mTileCount.x) * mTileSize;
+        const glm::ivec2 tileEnd = glm::min(tileStart + mTileSize, mWindowSize);
+        for (int y = tileStart.y; y < tileEnd.y; ++y)
         {
-            // Nothing was hit, so we can apply some shading.
-            lightingMaterial lightInfo = light->getInfo(hit.hitPosition);
-
-            // Diffuse Colour
-            float dot = glm::dot(hit.hitNormal, rayToLight.mDirection);
-            if (dot > 0)
+            for (int x = tileStart.x; x < tileEnd.x; ++x)
             {
-                diffuseColour += dot * lightInfo.diffuseIntensity * hit.material.diffuseIntensity;
-            }
-
-            // specular
-            glm::vec3 halfDir = glm::normalize(rayToLight.mDirection - ray.mDirection);
-            dot = glm::pow(glm::dot(hit.hitNormal, halfDir), hit.material.shininessConstant);
-            if (dot > 0)
-            {
-                specularColour += dot * lightInfo.specularIntensity * hit.material.specularIntensity;
+                const std::uint32_t colour = mDisplayBuffer[getPixelIndex(view, { x, y })].load(std::memory_order_relaxed);
+                mcg::drawPixel({ x, y }, unpackColour(colour));
             }
         }
     }
-
-    reflectRay(ray, hit);
-
-    // Times by booleans so that we can isolate channels
-    return  glm::vec3(mShowAmbient) * hit.material.ambientIntensity +
-            glm::vec3(mShowDiffuse) * diffuseColour +
-            glm::vec3(mShowSpecular) * specularColour;
 }
 
-bool RayTracer::traceToLightSource(const Ray &ray, const LightSource *lightSource)
+void RayTracer::event()
 {
-    if (lightSource->mType != lightSource->Directional)  // The light source is not infinitely far away.
+    SDL_PumpEvents();  // Anything new gets added to mHeldEvents by holdEvent().
+    std::vector<SDL_Event> events;
     {
-        hitInfo lightHit = getHitInWorld(ray);
-        if (lightHit.hit)
-        {
-            // Is the light source closer than the nearest hit?
-            return (glm::length(ray.mPosition - lightSource->getPosition()) <
-                    glm::length(ray.mPosition - lightHit.hitPosition));
-        }
-        return true;  // Nothing was hit. Therefore clear line of sight.
+        std::lock_guard<std::mutex> lock(mHeldEventsLock);
+        events.swap(mHeldEvents);
     }
-    return !quickGetHitInWorld(ray);  // Directional Lights can use quick hit instead.
-}
-
-void RayTracer::reflectRay(Ray &ray, const hitInfo &hit)
-{
-    ray.mDirection = glm::reflect(ray.mDirection, hit.hitNormal);
-    ray.mPosition = hit.hitPosition + hit.hitNormal * 0.001f;  // Offset to avoid artifacts from floating point precision.
-    ray.mEnergy = ray.mEnergy * hit.material.reflectivityIntensity;
-}
 
-hitInfo RayTracer::getHitInWorld(const Ray &ray)
-{
-    // Brute force method of obtaining the closest hit object in the world.
-    hitInfo closestHit{ false };
-    closestHit.hitPosition = glm::vec3 { 0.f };
-    float closestHitLength(0);
-    // Get the diffuse that the ray interception returns
-    for (auto &actor : mActors)
+    for (const SDL_Event &sdlEvent : events)
     {
-        hitInfo cur = actor->isIntersecting(ray);
-        if (cur.hit)
+        if (sdlEvent.type == SDL_QUIT) { mIsRunning = false; }
+        if (sdlEvent.type == SDL_KEYDOWN)
         {
-            float hitDistance = glm::length(cur.hitPosition - ray.mPosition);
-            if (!closestHit.hit)
-            {
-                closestHit = cur;
-                closestHitLength = hitDistance;
-            }
-            else
+            switch (sdlEvent.key.keysym.sym)
             {
-                // compare to the previous hit to see if it is closer.
-                if (hitDistance < closestHitLength)
+                case SDLK_ESCAPE:
+                    mIsRunning = false;
+                    break;
+                case SDLK_0:
+                    changeScene(lvl::TheDefaultScene);
+                    break;
+                case SDLK_1:
+                    changeScene(lvl::Triangle);
+                    break;
+                case SDLK_2:
+                    changeScene(lvl::MirrorRoom);
+                    break;
+                case SDLK_3:
+                    changeScene(lvl::BasicBall);
+                    break;
+                case SDLK_h:
+                    setHeatmap(static_cast<heatmap>((mHeatmap + 1) % NumberOfHeatmaps));
+                    break;
+                case SDLK_v:
+                    if (mIsRenderingAllViews)   { setViews({}); }
+                    else                        { setAllViews(); }
+                    break;
+                case SDLK_r:
+                    setRasterizingVisibility(!mIsRasterizingVisibility);
+                    break;
+                case SDLK_c:
+                    setShownView(mViews.empty() ? 0 : (glm::min(mShownView, getViewCount() - 1) + 1) % getViewCount());
+                    break;
+                case SDLK_4: case SDLK_5: case SDLK_6: case SDLK_7: case SDLK_8: case SDLK_9:
                 {
-                    closestHit = cur;
-                    closestHitLength = hitDistance;
+                    const unsigned int file = sdlEvent.key.keysym.sym - SDLK_4;
+                    if (file < mSceneFiles.size()) { changeScene(lvl::NumberOfScenes + file); }
+                    break;
                 }
             }
         }
     }
-    return closestHit;
 }
 
-bool RayTracer::quickGetHitInWorld(const Ray &ray)
+int RayTracer::holdEvent(void *rayTracer, SDL_Event *sdlEvent)
 {
-    // Brute force method to see if a ray is ever obstructed.
-    for (auto &actor : mActors)
-    {
-        if (actor->quickIsIntersecting(ray))
-        {
-            return true;
-        }
-    }
-    return false;
+    auto *self = static_cast<RayTracer*>(rayTracer);
+    std::lock_guard<std::mutex> lock(self->mHeldEventsLock);
+    self->mHeldEvents.push_back(*sdlEvent);
+    return 0;  // Ignored for event watches.
 }
 
-glm::vec3 RayTracer::sampleSkybox(glm::vec3 rayDirection)
+glm::vec3 RayTracer::unpackColour(std::uint32_t colour)
 {
-    float dot = glm::dot(rayDirection, { 0.f, 1.f, 0.f });
-    if (dot < 0)  // Below the horizon
-    {
-        return mGroundColour;
-    }
-    else if (0 <= dot && dot < mSkyBottomAngle)
-    {
-        dot = normalise(dot, 0.f, mSkyBottomAngle);
-        return glm::mix(mHorizonColour, mSkyBottomColour, dot);
-    }
-    dot = normalise(dot, mSkyBottomAngle, 1.f);
-    return glm::mix(mSkyBottomColour, mSkyTopColour, dot);
+    // Half way between two values so that mcg::drawPixel() truncates back to the same value.
+    const glm::vec3 channels(colour >> 16u & 0xffu, colour >> 8u & 0xffu, colour & 0xffu);
+    return (channels + 0.5f) / 255.f;
 }
@@ -0,0 +1,1241 @@
+/**
+ * @file RenderCore.cpp
+ * @brief Renders scenes into memory. Everything about the renderer except for the window, so it can be embedded.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 18/03/2021
+ */
+
+#include "RenderCore.h"
+#include "Kernels.h"
+#include "Profiler.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+    /** The rays that this thread has traced since its last flushRayCounts(). */
+    thread_local RenderCore::rayCounts threadRays { 0, 0, 0, 0, 0 };
+
+    /** The number of surfaces hit by the last path that this thread traced. */
+    thread_local int threadPathSurfaces = 0;
+
+    /** A branch of the ray tree that is still to be traced, along with how many surfaces are behind it. */
+    struct pathBranch
+    {
+        Ray ray;
+        int depth;
+    };
+
+    /** The work stack of tracePath(). Kept between pixels so that it only allocates while it grows. */
+    thread_local std::vector<pathBranch> threadPathBranches;
+
+    /**
+     * @returns The grid size rounded up to the next even size of at least 2. Odd grids can't be split into
+     * quadrants, and smaller ones would leave super sampling with nothing to trace.
+     */
+    int getEvenGridSize(int gridSize)
+    {
+        return glm::max(2, gridSize + glm::abs(gridSize % 2));
+    }
+
+    float getBrightest(const glm::vec3 &energy)
+    {
+        return glm::max(energy.x, glm::max(energy.y, energy.z));
+    }
+
+    /** Everything that a heatmap can measure, taken before and after tracing a pixel. */
+    struct costSample
+    {
+        Bvh::traversalCounts                    traversal;
+        std::uint64_t                           shadowRays;
+        std::chrono::steady_clock::time_point   time;
+    };
+
+    costSample sampleCost()
+    {
+        return { Bvh::getThreadCounts(), threadRays.shadow, std::chrono::steady_clock::now() };
+    }
+
+    /** @returns The cost of everything since start was sampled. */
+    float measureCost(RenderCore::heatmap channel, const costSample &start)
+    {
+        const costSample end = sampleCost();
+        switch (channel)
+        {
+            case RenderCore::TraversalSteps: return static_cast<float>(end.traversal.nodes - start.traversal.nodes);
+            case RenderCore::PrimitiveTests: return static_cast<float>(end.traversal.items - start.traversal.items);
+            case RenderCore::ShadowRays:     return static_cast<float>(end.shadowRays - start.shadowRays);
+            case RenderCore::BounceDepth:    return static_cast<float>(threadPathSurfaces);
+            case RenderCore::PixelTime:      return std::chrono::duration<float, std::micro>(end.time - start.time).count();
+            default:                        return 0.f;
+        }
+    }
+}
+
+RenderCore::RenderCore(const glm::ivec2 &mWindowSize, const std::vector<std::string> &sceneFiles,
+                       const loadOptions &options, const rendererOptions &renderer) :
+    mWindowSize(mWindowSize),
+    mPixelsPerView(mWindowSize.x * mWindowSize.y),
+    mFrameBuffer(mWindowSize.x * mWindowSize.y),
+    mDisplayBuffer(mWindowSize.x * mWindowSize.y),
+    mCostBuffer(mWindowSize.x * mWindowSize.y),
+    mIsRasterizingVisibility(renderer.isRasterizingVisibility),
+    mTileCount((mWindowSize + mTileSize - 1) / mTileSize),
+    mDirtyTiles(mTileCount.x * mTileCount.y),
+    mThreadPool(renderer.threadCount),
+    mShowAmbient(true), mShowDiffuse(true), mShowSpecular(true), mShowSkybox(true),
+    mRayBudget(renderer.rayBudget),
+    mEnergyThreshold(renderer.energyThreshold),
+    mAntiAliasing(renderer.antiAliasing.isEnabled),
+    mAaSampleBudget(static_cast<int>(static_cast<float>(mWindowSize.x * mWindowSize.y) * renderer.antiAliasing.sampleBudget)),
+    mAaGridSize(getEvenGridSize(renderer.antiAliasing.gridSize)),
+    mAaContrastThreshold(renderer.antiAliasing.contrastThreshold),
+    mAaVarianceThreshold(renderer.antiAliasing.varianceThreshold),
+    mSceneFiles(sceneFiles),
+    mLoadOptions(options)
+{
+    A2_PROFILE_ADD_RENDERER();
+    mLog = renderer.log;
+
+    std::string error;
+    if (!renderer.environmentPath.empty() && !mEnvironment.load(renderer.environmentPath, error) && mLog != nullptr)
+    {
+        *mLog << "\n" << error << "\n";
+    }
+
+    // There is nothing to show until the first scene is ready, so it doesn't get loaded in the background.
+    if (mSceneFiles.empty() || !loadSceneNow(lvl::NumberOfScenes))
+    {
+        mCurrentScene = mRequestedScene = lvl::TheDefaultScene;
+        swapScene(loadScene(mWindowSize, mCurrentScene, mLoadOptions));
+    }
+}
+
+RenderCore::~RenderCore()
+{
+    cancelFrame();
+
+    if (mSceneJob.valid())
+    {
+        scene level = mSceneJob.get();
+        unloadScene(level);
+    }
+    if (mUnloadJob.valid()) { mUnloadJob.get(); }
+    unloadScene(mScene);
+    A2_PROFILE_REMOVE_RENDERER();
+}
+
+bool RenderCore::loadSceneNow(unsigned int index)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    if (index >= lvl::NumberOfScenes + mSceneFiles.size()) { return false; }
+
+    const std::string path = index >= lvl::NumberOfScenes ? mSceneFiles[index - lvl::NumberOfScenes] : "";
+    scene level = loadSceneAt(mWindowSize, index, path, mLoadOptions);
+    if (!level.success)
+    {
+        if (mLog != nullptr) { *mLog << "\n" << level.error << "\n"; }
+        return false;
+    }
+
+    swapScene(std::move(level));
+    mCurrentScene = mRequestedScene = index;
+    return true;
+}
+
+bool RenderCore::loadSceneNow(const std::string &path)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    mSceneFiles.push_back(path);
+    if (loadSceneNow(lvl::NumberOfScenes + static_cast<unsigned int>(mSceneFiles.size()) - 1)) { return true; }
+
+    mSceneFiles.pop_back();
+    return false;
+}
+
+void RenderCore::advance(int updates)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    if (mFrameJob.valid())
+    {
+        mFrameJob.get();
+        finishFrame();
+    }
+
+    // Nothing is rendering now, so each update can be committed straight away, the same as startFrame() does.
+    if (mUpdateJob.valid()) { mUpdateJob.get(); }
+    else                    { update(); }
+    for (int i = 0; i < updates; ++i)
+    {
+        commit();
+        update();
+    }
+
+    // The last update is left for startFrame() to commit, as though it ran alongside the frame before.
+    std::promise<void> finished;
+    finished.set_value();
+    mUpdateJob = finished.get_future();
+}
+
+void RenderCore::renderFrame()
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    startFrame();
+    mFrameJob.get();
+    finishFrame();
+}
+
+bool RenderCore::renderFrame(void *pixels, std::ptrdiff_t rowStride, pixelFormat format, unsigned int view)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    renderFrame();
+    return copyImage(pixels, rowStride, format, view);
+}
+
+void RenderCore::setBounceLimit(int bounceLimit)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    mBounceLimit = mMaxBounceLimit = bounceLimit;
+    mIsBounceLimitFixed = true;
+}
+
+void RenderCore::setHeatmap(heatmap channel)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    mHeatmap = channel;
+}
+
+const char *RenderCore::getHeatmapName(heatmap channel)
+{
+    switch (channel)
+    {
+        case TraversalSteps:    return "Traversal Steps";
+        case PrimitiveTests:    return "Primitive Tests";
+        case ShadowRays:        return "Shadow Rays";
+        case BounceDepth:       return "Bounce Depth";
+        case PixelTime:         return "Pixel Time (us)";
+        default:                return "None";
+    }
+}
+
+std::vector<std::uint32_t> RenderCore::getImage(unsigned int view) const
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    std::vector<std::uint32_t> image;
+    if (view >= getViewCount()) { return image; }
+
+    image.reserve(mPixelsPerView);
+    const auto start = mDisplayBuffer.begin() + getPixelIndex(view, glm::ivec2(0));
+    for (auto pixel = start; pixel != start + mPixelsPerView; ++pixel)
+    {
+        image.push_back(pixel->load(std::memory_order_relaxed));
+    }
+    return image;
+}
+
+bool RenderCore::copyImage(void *pixels, std::ptrdiff_t rowStride, pixelFormat format, unsigned int view) const
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    const auto rowSize = static_cast<std::ptrdiff_t>(getPixelSize(format)) * mWindowSize.x;
+    if (view >= getViewCount() || pixels == nullptr || std::abs(rowStride) < rowSize) { return false; }
+
+    auto row = static_cast<unsigned char *>(pixels);
+    for (int y = 0; y < mWindowSize.y; ++y, row += rowStride)
+    {
+        const unsigned int start = getPixelIndex(view, { 0, y });
+        if (format == RgbFloat)
+        {
+            // Copied a channel at a time, since the rows might not be aligned for floats.
+            for (int x = 0; x < mWindowSize.x; ++x)
+            {
+                std::memcpy(row + x * sizeof(glm::vec3), &mFrameBuffer[start + x], sizeof(glm::vec3));
+            }
+            continue;
+        }
+
+        const std::size_t pixelSize = getPixelSize(format);
+        for (int x = 0; x < mWindowSize.x; ++x)
+        {
+            const std::uint32_t colour = mDisplayBuffer[start + x].load(std::memory_order_relaxed);
+            const auto red = static_cast<unsigned char>(colour >> 16u);
+            const auto green = static_cast<unsigned char>(colour >> 8u);
+            const auto blue = static_cast<unsigned char>(colour);
+            unsigned char *pixel = row + x * pixelSize;
+            switch (format)
+            {
+                case Rgb8:
+                    pixel[0] = red; pixel[1] = green; pixel[2] = blue;
+                    break;
+                case Rgba8:
+                    pixel[0] = red; pixel[1] = green; pixel[2] = blue; pixel[3] = 0xffu;
+                    break;
+                default:
+                    pixel[0] = blue; pixel[1] = green; pixel[2] = red; pixel[3] = 0xffu;
+                    break;
+            }
+        }
+    }
+    return true;
+}
+
+std::size_t RenderCore::getPixelSize(pixelFormat format)
+{
+    switch (format)
+    {
+        case Rgb8:      return 3;
+        case RgbFloat:  return sizeof(glm::vec3);
+        default:        return 4;
+    }
+}
+
+bool RenderCore::writeImage(const std::string &path, unsigned int view) const
+{
+    std::vector<unsigned char> rgb(static_cast<std::size_t>(mPixelsPerView) * 3);
+    if (!copyImage(rgb.data(), mWindowSize.x * 3, Rgb8, view)) { return false; }
+
+    std::ofstream image(path, std::ios::binary);
+    image << "P6\n" << mWindowSize.x << " " << mWindowSize.y << "\n255\n";
+    image.write(reinterpret_cast<const char *>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+    return static_cast<bool>(image);
+}
+
+void RenderCore::setLog(std::ostream *log)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    mLog = log;
+}
+
+void RenderCore::setViews(const std::vector<unsigned int> &cameras)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    mRequestedViews = cameras;
+    mIsRenderingAllViews = false;
+}
+
+void RenderCore::setAllViews()
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    mRequestedViews.clear();
+    mIsRenderingAllViews = true;
+}
+
+void RenderCore::setShownView(unsigned int view)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    mShownView = view;
+}
+
+void RenderCore::setRasterizingVisibility(bool isRasterizing)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    mIsRasterizingVisibility = isRasterizing;
+}
+
+void RenderCore::setSkyColours(const skyColours &sky)
+{
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    mNextEnvironment.reset(new Environment(sky));
+}
+
+bool RenderCore::setEnvironment(const std::string &path, std::string *error)
+{
+    // Loaded before locking, so that it doesn't hold up a frame.
+    std::unique_ptr<Environment> environment(new Environment());
+    std::string loadError;
+    const bool isLoaded = environment->load(path, loadError);
+
+    std::lock_guard<std::recursive_mutex> lock(mLock);
+    if (!isLoaded)
+    {
+        if (mLog != nullptr)    { *mLog << "\n" << loadError << "\n"; }
+        if (error != nullptr)   { *error = loadError; }
+        return false;
+    }
+
+    mNextEnvironment = std::move(environment);
+    return true;
+}
+
+void RenderCore::selectViews()
+{
+    std::vector<Camera*> views;
+    const auto addView = [&](unsigned int camera) {
+        if (camera < mScene.cameras.size() && mScene.cameras[camera]->getScreenResolution() == mWindowSize)
+        {
+            views.push_back(mScene.cameras[camera]);
+        }
+    };
+    if (mIsRenderingAllViews)
+    {
+        for (unsigned int camera = 0; camera < mScene.cameras.size(); ++camera) { addView(camera); }
+    }
+    for (const unsigned int camera : mRequestedViews) { addView(camera); }
+    if (views.empty()) { views.push_back(mScene.mainCamera); }
+
+    // Atomics can't be moved, so the buffers that hold them are replaced rather than resized.
+    if (views.size() != mViews.size())
+    {
+        const std::size_t pixelCount = views.size() * mPixelsPerView;
+        mFrameBuffer.resize(pixelCount);
+        mCostBuffer.resize(pixelCount);
+        mDisplayBuffer = std::vector<std::atomic<std::uint32_t>>(pixelCount);
+        mDirtyTiles = std::vector<std::atomic<bool>>(views.size() * mTileCount.x * mTileCount.y);
+        mVisibilityBuffers.resize(views.size(), VisibilityBuffer(mWindowSize));
+        mPresentedView = static_cast<unsigned int>(views.size());  // Draws the whole of the shown view.
+    }
+    mViews.swap(views);
+}
+
+void RenderCore::startFrame()
+{
+    // There isn't an update in flight for the first frame of a scene.
+    if (mUpdateJob.valid()) { mUpdateJob.get(); }
+    else                    { update(); }
+
+    // Nothing is rendering at this point, so it's safe to swap over to the new state.
+    commit();
+    selectViews();
+    mFrameHeatmap = mHeatmap;
+    mIsFrameRasterizing = mIsRasterizingVisibility && mScene.pages == nullptr;
+    if (mNextEnvironment)
+    {
+        mEnvironment = std::move(*mNextEnvironment);
+        mNextEnvironment.reset();
+    }
+    mHeatmapMax = 0.f;
+    mPrimaryRays = 0;  // Anything left over is from a cancelled frame.
+    mShadowRays = 0;
+    mReflectionRays = 0;
+    mRefractionRays = 0;
+    mPrunedRays = 0;
+
+    // The previous frame and its update have both finished, so the counters can be gathered.
+    A2_PROFILE_END_FRAME(mLog);
+    mFrameJob = std::async(std::launch::async, [this]() { render(); });
+
+    // Entities only write to their own state while the renderer reads from what was committed.
+    mUpdateJob = std::async(std::launch::async, [this]() { update(); });
+}
+
+void RenderCore::finishFrame()
+{
+    const auto current = std::chrono::steady_clock::now();
+    mLastFrameSeconds = std::chrono::duration<double>(current - mLastFrameTime).count();
+    mLastFrameTime = current;
+    mLastFrameRays = { mPrimaryRays.load(), mShadowRays.load(), mReflectionRays.load(), mRefractionRays.load(),
+                       mPrunedRays.load() };
+    mLastHeatmapMax = mHeatmapMax;
+
+    if (mLog != nullptr) { printFrame(*mLog); }
+    ++mFrameCount;
+
+    // Try and increase the bounce limit of the rays.
+    if (!mIsBounceLimitFixed) { mBounceLimit = glm::min(mMaxBounceLimit, mBounceLimit + 1); }
+}
+
+void RenderCore::printFrame(std::ostream &log)
+{
+    // Get how long the frame took with some useful information
+    const float delta = static_cast<float>(mLastFrameSeconds);
+    log         << "\rFrame: " << mFrameCount
+                << "\tFrame Time: " << delta
+                << "\tBounce Limit: " << mBounceLimit << "/" << mMaxBounceLimit;
+    if (mViews.size() > 1)
+    {
+        log         << "\tView: " << glm::min(mShownView, getViewCount() - 1) + 1 << "/" << mViews.size();
+    }
+    if (mFrameHeatmap != NoHeatmap)
+    {
+        log         << "\tHeatmap: " << getHeatmapName(mFrameHeatmap) << " (red is " << mLastHeatmapMax << ")   ";
+    }
+    if (mScene.pages != nullptr)
+    {
+        const ClusterCache::statistics paging = mScene.pages->getStatistics();
+        log         << "\tResident: " << paging.residentBytes / 1024 << "/" << paging.budget / 1024 << " KB ("
+                    << paging.residentClusters << "/" << paging.clusterCount << " clusters)"
+                    << "\tPaged In: " << paging.pageIns << " (" << paging.bytesPagedIn / 1024 << " KB in "
+                    << paging.batches << " batches, " << paging.pageInSeconds * 1000.0 << " ms)"
+                    << "\tEvicted: " << paging.evictions
+                    << "\tDeferred Rays: " << paging.deferredRays << "   ";
+        mScene.pages->resetStatistics();
+    }
+    if (mLastFrameRays.pruned > 0)
+    {
+        log         << "\tPruned Rays: " << mLastFrameRays.pruned << "   ";
+    }
+}
+
+void RenderCore::cancelFrame()
+{
+    if (mFrameJob.valid())
+    {
+        mCancelFrame = true;
+        mFrameJob.get();
+        mCancelFrame = false;
+    }
+    if (mUpdateJob.valid()) { mUpdateJob.get(); }
+}
+
+void RenderCore::update()
+{
+    A2_PROFILE_SCOPE(Update);
+    for (auto &entity : mScene.dynamicEntities)
+    {
+        entity->update(0.16f);  // Updates as if it was running at 60fps.
+    }
+}
+
+void RenderCore::commit()
+{
+    A2_PROFILE_SCOPE(Commit);
+    for (auto &entity : mScene.dynamicEntities)
+    {
+        entity->commit();
+    }
+
+    // Dynamic actors may have moved out of their old bounds.
+    if (!mScene.dynamicEntities.empty()) { refitActorTree(mScene); }
+}
+
+void RenderCore::render()
+{
+    // Nothing useful is on screen after a scene change, so start from a coarse preview and refine it.
+    // Every other frame already has the previous image on screen, so it can be traced in a single pass.
+    const int startBlockSize = mFrameCount == 0 ? mProgressiveBlockSize : 1;
+    if (mIsFrameRasterizing) { renderVisibility(); }
+    for (int blockSize = startBlockSize; blockSize >= 1; blockSize /= 2)
+    {
+        renderPass(blockSize, blockSize == startBlockSize);
+        if (mScene.pages != nullptr) { renderDeferred(blockSize); }
+        if (mCancelFrame) { return; }
+    }
+
+    // Super sampling would only smear the costs.
+    if (mFrameHeatmap != NoHeatmap)
+    {
+        showHeatmap();
+        return;
+    }
+    if (mAntiAliasing) { antiAlias(); }
+}
+
+void RenderCore::renderVisibility()
+{
+    A2_PROFILE_SCOPE(Visibility);
+    for (std::size_t view = 0; view < mViews.size(); ++view)
+    {
+        if (mCancelFrame) { return; }
+        mVisibilityBuffers[view].render(*mViews[view], mScene.actors, mThreadPool, mCancelFrame);
+    }
+}
+
+void RenderCore::renderPass(int blockSize, bool isFirstPass)
+{
+    A2_PROFILE_SCOPE(RenderPass);
+    // Each view only changes which camera the rays come from, so they all share the one set of jobs.
+    mThreadPool.parallelFor(static_cast<int>(mViews.size()) * mTileCount.x * mTileCount.y, [&](int tileIndex)
+    {
+        if (mCancelFrame) { return; }
+        renderTile(tileIndex, blockSize, isFirstPass);
+    });
+}
+
+void RenderCore::renderTile(int tileIndex, int blockSize, bool isFirstPass)
+{
+    A2_PROFILE_SCOPE(Tile);
+    const int coarseBlockSize = blockSize * 2;
+    const unsigned int view = tileIndex % mViews.size();
+    tileIndex /= static_cast<int>(mViews.size());
+    const glm::ivec2 tileStart = glm::ivec2(tileIndex % mTileCount.x, tileIndex / mTileCount.x) * mTileSize;
+    const glm::ivec2 tileEnd = glm::min(tileStart + mTileSize, mWindowSize);
+
+    // Rows of single pixels only go to the frame buffer as they're traced. Then the whole row is packed for the
+    // display at once by the widest kernels the CPU has.
+    const bool isPackingRows = blockSize == 1 && mFrameHeatmap == NoHeatmap;
+    std::vector<std::uint32_t> packedRow(isPackingRows ? mTileSize : 0);
+
+    // Loop through the top left pixel of each block in the tile, generating the rays a row at a time.
+    std::vector<int> deferredPixels;
+    std::vector<Ray> rays((mTileSize + blockSize - 1) / blockSize);
+    for (int y = tileStart.y; y < tileEnd.y; y += blockSize)
+    {
+        const int rayCount = (tileEnd.x - tileStart.x + blockSize - 1) / blockSize;
+        {
+            A2_PROFILE_SCOPE(RayGeneration);
+            mViews[view]->generateRow({ tileStart.x, y }, rayCount, blockSize, rays.data());
+        }
+
+        const std::size_t firstDeferred = deferredPixels.size();
+        for (int i = 0; i < rayCount; ++i)
+        {
+            const int x = tileStart.x + i * blockSize;
+
+            // This pixel was the top left of a block in the previous pass. It's already traced and drawn.
+            if (!isFirstPass && x % coarseBlockSize == 0 && y % coarseBlockSize == 0) { continue; }
+
+            if (!renderPixel(view, { x, y }, isPackingRows ? 0 : blockSize, rays[i]))
+            {
+                deferredPixels.push_back(getPixelIndex(view, { x, y }));
+            }
+        }
+
+        if (isPackingRows)
+        {
+            // Pixels that were skipped pack to what's already on the display. Deferred ones (which are in order) are
+            // left alone until they're traced.
+            static_assert(sizeof(glm::vec3) == 3 * sizeof(float), "The kernels read colours as plain floats");
+            const int rowStart = getPixelIndex(view, { tileStart.x, y });
+            kernels::get().packColours(&mFrameBuffer[rowStart].x, packedRow.data(), rayCount);
+            auto deferred = deferredPixels.cbegin() + static_cast<std::ptrdiff_t>(firstDeferred);
+            for (int i = 0; i < rayCount; ++i)
+            {
+                if (deferred != deferredPixels.cend() && *deferred == rowStart + i)
+                {
+                    ++deferred;
+                    continue;
+                }
+                mDisplayBuffer[rowStart + i].store(packedRow[i], std::memory_order_relaxed);
+            }
+        }
+    }
+    markDirty(view, tileStart);
+    flushRayCounts();
+
+    if (!deferredPixels.empty())
+    {
+        std::lock_guard<std::mutex> lock(mDeferredPixelsLock);
+        mDeferredPixels.insert(mDeferredPixels.end(), deferredPixels.begin(), deferredPixels.end());
+    }
+}
+
+bool RenderCore::renderPixel(unsigned int view, const glm::ivec2 &pixelPosition, int blockSize)
+{
+    Ray ray = [&]() {
+        A2_PROFILE_SCOPE(RayGeneration);
+        return mViews[view]->generateSingleRay(pixelPosition);
+    }();
+    return renderPixel(view, pixelPosition, blockSize, ray);
+}
+
+bool RenderCore::renderPixel(unsigned int view, const glm::ivec2 &pixelPosition, int blockSize, Ray ray)
+{
+    // Cast the ray from our camera into the world to get our colour.
+    ClusterCache::beginRay();
+    const costSample start = mFrameHeatmap != NoHeatmap ? sampleCost() : costSample();
+    ++threadRays.primary;
+    glm::vec3 colour;
+    if (mIsFrameRasterizing)
+    {
+        // Rebuild the hit from the one primitive the pixel can see, unless rounding might have picked the wrong one.
+        hitInfo hit { false };
+        colour = isVisibleHit(view, pixelPosition, ray, hit) ? trace(ray, hit) : trace(ray);
+    }
+    else
+    {
+        colour = trace(ray);
+    }
+    if (mScene.pages != nullptr && ClusterCache::isRayDeferred()) { return false; }
+
+    mFrameBuffer[getPixelIndex(view, pixelPosition)] = colour;
+
+    // The heatmap replaces the whole display once the frame has been traced.
+    if (mFrameHeatmap != NoHeatmap)
+    {
+        fillCost(view, pixelPosition, blockSize, measureCost(mFrameHeatmap, start));
+        return true;
+    }
+
+    // Write the pixel (and the rest of its block) to the display buffer.
+    fillBlock(view, pixelPosition, blockSize, colour);
+    return true;
+}
+
+bool RenderCore::isVisibleHit(unsigned int view, const glm::ivec2 &pixelPosition, const Ray &ray, hitInfo &hit) const
+{
+    const VisibilityBuffer &visibility = mVisibilityBuffers[view];
+    const VisibilityBuffer::texel visible = visibility.get(pixelPosition);
+    VisibilityBuffer::texel neighbours[4];
+    const int neighbourCount = visibility.getNeighbours(pixelPosition, neighbours);
+
+    // A pixel centre right on an edge shared by two triangles can be left out by both, so a gap next to anything
+    // might be a crack rather than the sky.
+    if (visible.actor == VisibilityBuffer::noActor)
+    {
+        return std::none_of(neighbours, neighbours + neighbourCount, [](const VisibilityBuffer::texel &neighbour) {
+            return neighbour.actor != VisibilityBuffer::noActor;
+        });
+    }
+
+    // The ray only misses the primitive right on its edge, and only hits it somewhere else if it was the wrong one.
+    hit = mScene.actors[visible.actor]->isIntersectingPrimitive(ray, visible.primitive);
+    if (!hit.hit || !visibility.isNearestAt(pixelPosition, hit.hitPosition)) { return false; }
+
+    // A nearer surface that the pixel rounded out of is under one of its neighbours, so check the ray against them.
+    const float distance = glm::distance(ray.mPosition, hit.hitPosition);
+    for (int i = 0; i < neighbourCount; ++i)
+    {
+        const VisibilityBuffer::texel &neighbour = neighbours[i];
+        if (neighbour.actor == VisibilityBuffer::noActor) { continue; }
+        if (neighbour.actor == visible.actor && neighbour.primitive == visible.primitive) { continue; }
+
+        const hitInfo neighbourHit = mScene.actors[neighbour.actor]->isIntersectingPrimitive(ray, neighbour.primitive);
+        if (neighbourHit.hit && glm::distance(ray.mPosition, neighbourHit.hitPosition) < distance) { return false; }
+    }
+    return true;
+}
+
+void RenderCore::renderDeferred(int blockSize)
+{
+    while (!mDeferredPixels.empty() && !mCancelFrame)
+    {
+        std::vector<int> pixels;
+        std::swap(pixels, mDeferredPixels);
+        mScene.pages->countDeferredRays(pixels.size());
+        mScene.pages->pageIn();
+
+        const int pixelsPerJob = 64;
+        const int jobCount = (static_cast<int>(pixels.size()) + pixelsPerJob - 1) / pixelsPerJob;
+        mThreadPool.parallelFor(jobCount, [&](int job)
+        {
+            if (mCancelFrame) { return; }
+
+            std::vector<int> deferredPixels;
+            const int end = glm::min(static_cast<int>(pixels.size()), (job + 1) * pixelsPerJob);
+            for (int i = job * pixelsPerJob; i < end; ++i)
+            {
+                const unsigned int view = pixels[i] / mPixelsPerView;
+                const int index = pixels[i] % mPixelsPerView;
+                const glm::ivec2 pixelPosition(index % mWindowSize.x, index / mWindowSize.x);
+                if (renderPixel(view, pixelPosition, blockSize))    { markDirty(view, pixelPosition); }
+                else                                                { deferredPixels.push_back(pixels[i]); }
+            }
+            flushRayCounts();
+
+            if (!deferredPixels.empty())
+            {
+                std::lock_guard<std::mutex> lock(mDeferredPixelsLock);
+                mDeferredPixels.insert(mDeferredPixels.end(), deferredPixels.begin(), deferredPixels.end());
+            }
+        });
+    }
+    mDeferredPixels.clear();  // Only left over if the frame was cancelled.
+}
+
+void RenderCore::fillBlock(unsigned int view, const glm::ivec2 &pixelPosition, int blockSize, const glm::vec3 &colour)
+{
+    const std::uint32_t packedColour = packColour(colour);
+    const int yEnd = glm::min(pixelPosition.y + blockSize, mWindowSize.y);
+    const int xEnd = glm::min(pixelPosition.x + blockSize, mWindowSize.x);
+    for (int y = pixelPosition.y; y < yEnd; ++y)
+    {
+        for (int x = pixelPosition.x; x < xEnd; ++x)
+        {
+            mDisplayBuffer[getPixelIndex(view, { x, y })].store(packedColour, std::memory_order_relaxed);
+        }
+    }
+}
+
+void RenderCore::fillCost(unsigned int view, const glm::ivec2 &pixelPosition, int blockSize, float cost)
+{
+    const int yEnd = glm::min(pixelPosition.y + blockSize, mWindowSize.y);
+    const int xEnd = glm::min(pixelPosition.x + blockSize, mWindowSize.x);
+    for (int y = pixelPosition.y; y < yEnd; ++y)
+    {
+        std::fill(mCostBuffer.begin() + getPixelIndex(view, { pixelPosition.x, y }),
+                  mCostBuffer.begin() + getPixelIndex(view, { xEnd, y }), cost);
+    }
+}
+
+void RenderCore::showHeatmap()
+{
+    // Bounces have a fixed range. Everything else is scaled to the 99th percentile of the frame, otherwise a few
+    // pixels that were interrupted part way through would push everything else down to blue.
+    if (mFrameHeatmap == BounceDepth)
+    {
+        mHeatmapMax = static_cast<float>(mBounceLimit);
+    }
+    else
+    {
+        std::vector<float> costs = mCostBuffer;
+        const auto percentile = costs.begin() + static_cast<std::ptrdiff_t>(costs.size() * 99 / 100);
+        std::nth_element(costs.begin(), percentile, costs.end());
+        mHeatmapMax = *percentile;
+    }
+    const float scale = mHeatmapMax > 0.f ? 1.f / mHeatmapMax : 0.f;
+
+    mThreadPool.parallelFor(static_cast<int>(mViews.size()) * mTileCount.x * mTileCount.y, [&](int tileIndex)
+    {
+        const unsigned int view = tileIndex % mViews.size();
+        tileIndex /= static_cast<int>(mViews.size());
+        const glm::ivec2 tileStart = glm::ivec2(tileIndex % mTileCount.x, tileIndex / mTileCount.x) * mTileSize;
+        const glm::ivec2 tileEnd = glm::min(tileStart + mTileSize, mWindowSize);
+        for (int y = tileStart.y; y < tileEnd.y; ++y)
+        {
+            for (int x = tileStart.x; x < tileEnd.x; ++x)
+            {
+                const int index = getPixelIndex(view, { x, y });
+                mDisplayBuffer[index].store(packColour(heatColour(mCostBuffer[index] * scale)), std::memory_order_relaxed);
+            }
+        }
+        markDirty(view, tileStart);
+    });
+}
+
+glm::vec3 RenderCore::heatColour(float value)
+{
+    const glm::vec3 colours[] = {
+            glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 1.f, 1.f), glm::vec3(0.f, 1.f, 0.f),
+            glm::vec3(1.f, 1.f, 0.f), glm::vec3(1.f, 0.f, 0.f)
+    };
+    const float position = glm::clamp(value, 0.f, 1.f) * 4.f;
+    const int below = glm::min(static_cast<int>(position), 3);
+    return glm::mix(colours[below], colours[below + 1], position - static_cast<float>(below));
+}
+
+void RenderCore::flushRayCounts()
+{
+    mPrimaryRays.fetch_add(threadRays.primary, std::memory_order_relaxed);
+    mShadowRays.fetch_add(threadRays.shadow, std::memory_order_relaxed);
+    mReflectionRays.fetch_add(threadRays.reflection, std::memory_order_relaxed);
+    mRefractionRays.fetch_add(threadRays.refraction, std::memory_order_relaxed);
+    mPrunedRays.fetch_add(threadRays.pruned, std::memory_order_relaxed);
+    threadRays = { 0, 0, 0, 0, 0 };
+}
+
+void RenderCore::markDirty(unsigned int view, const glm::ivec2 &pixelPosition)
+{
+    const glm::ivec2 tile = pixelPosition / mTileSize;
+    mDirtyTiles[(view * mTileCount.y + tile.y) * mTileCount.x + tile.x].store(true, std::memory_order_release);
+}
+
+void RenderCore::antiAlias()
+{
+    A2_PROFILE_SCOPE(AntiAliasing);
+    // Every view gets its own budget, then the pixels of all of them are super sampled together.
+    std::vector<std::pair<int, int>> pixels;
+    for (unsigned int view = 0; view < mViews.size(); ++view)
+    {
+        // Pair each pixel that needs super sampling with its contrast so that the worst edges get the budget first.
+        std::vector<std::pair<float, int>> candidates;
+        for (int y = 0; y < mWindowSize.y; ++y)
+        {
+            for (int x = 0; x < mWindowSize.x; ++x)
+            {
+                const int index = getPixelIndex(view, { x, y });
+                const glm::vec3 &colour = mFrameBuffer[index];
+
+                float contrast = 0.f;
+                if (x > 0)                  { contrast = glm::max(contrast, colourDifference(colour, mFrameBuffer[index - 1])); }
+                if (x < mWindowSize.x - 1)  { contrast = glm::max(contrast, colourDifference(colour, mFrameBuffer[index + 1])); }
+                if (y > 0)                  { contrast = glm::max(contrast, colourDifference(colour, mFrameBuffer[index - mWindowSize.x])); }
+                if (y < mWindowSize.y - 1)  { contrast = glm::max(contrast, colourDifference(colour, mFrameBuffer[index + mWindowSize.x])); }
+
+                if (contrast > mAaContrastThreshold) { candidates.emplace_back(contrast, index); }
+            }
+        }
+
+        std::sort(candidates.begin(), candidates.end(),
+                  [](const std::pair<float, int> &a, const std::pair<float, int> &b) { return a.first > b.first; });
+
+        // Hand out the budget up front. Each pixel can take up to a full grid of samples.
+        int sampleBudget = mAaSampleBudget;
+        for (std::size_t i = 0; i < candidates.size() && sampleBudget >= 4; ++i)
+        {
+            const int samples = glm::min(mAaGridSize * mAaGridSize, sampleBudget - sampleBudget % 4);
+            pixels.emplace_back(candidates[i].second, samples);
+            sampleBudget -= samples;
+        }
+    }
+
+    // Every pixel has already been compared with its neighbours, so it's safe to write straight back.
+    const int pixelsPerJob = 64;
+    const int jobCount = (static_cast<int>(pixels.size()) + pixelsPerJob - 1) / pixelsPerJob;
+    mThreadPool.parallelFor(jobCount, [&](int job)
+    {
+        if (mCancelFrame) { return; }
+
+        const int end = glm::min(static_cast<int>(pixels.size()), (job + 1) * pixelsPerJob);
+        for (int i = job * pixelsPerJob; i < end; ++i)
+        {
+            const int index = pixels[i].first;
+            const unsigned int view = index / mPixelsPerView;
+            const int viewIndex = index % mPixelsPerView;
+            const glm::ivec2 pixelPosition(viewIndex % mWindowSize.x, viewIndex / mWindowSize.x);
+
+            // Keep the single sample rather than wait for clusters. They're paged in with the next frame.
+            ClusterCache::beginRay();
+            const glm::vec3 colour = superSample(view, pixelPosition, mFrameBuffer[index], pixels[i].second);
+            if (mScene.pages != nullptr && ClusterCache::isRayDeferred()) { continue; }
+
+            mFrameBuffer[index] = colour;
+            mDisplayBuffer[index].store(packColour(colour), std::memory_order_relaxed);
+            markDirty(view, pixelPosition);
+        }
+        flushRayCounts();
+    });
+}
+
+glm::vec3 RenderCore::superSample(unsigned int view, const glm::ivec2 &pixelPosition, const glm::vec3 &pixelSample,
+                                  int maxSamples)
+{
+    const int halfGridSize = mAaGridSize / 2;
+    const unsigned int seed = pixelPosition.y * mWindowSize.x + pixelPosition.x;
+
+    // The pixel has already paid for the ray through its centre, so it starts off the mean.
+    const glm::vec3 centre = glm::clamp(pixelSample, 0.f, 1.f);
+    glm::vec3 sum = centre;
+    glm::vec3 sumSquared = centre * centre;
+    int count = 1;
+    int traced = 0;
+
+    // Each batch puts one sample into every quadrant so that the samples stay stratified if we stop early.
+    for (int batch = 0; batch < halfGridSize * halfGridSize && traced + 4 <= maxSamples; ++batch)
+    {
+        const glm::ivec2 subCell(batch % halfGridSize, batch / halfGridSize);
+        for (int quadrant = 0; quadrant < 4; ++quadrant)
+        {
+            const glm::ivec2 stratum = glm::ivec2(quadrant % 2, quadrant / 2) * halfGridSize + subCell;
+            const glm::vec2 jitter(randomFloat(seed, 2 * traced), randomFloat(seed, 2 * traced + 1));
+
+            // The single sample sits on the pixel's position, so the footprint is centred on it.
+            const glm::vec2 offset = (glm::vec2(stratum) + jitter) / static_cast<float>(mAaGridSize) - 0.5f;
+
+            Ray ray = [&]() {
+                A2_PROFILE_SCOPE(RayGeneration);
+                return mViews[view]->generateSingleRay(glm::vec2(pixelPosition) + offset);
+            }();
+            ++threadRays.primary;
+            const glm::vec3 colour = glm::clamp(trace(ray), 0.f, 1.f);
+            sum += colour;
+            sumSquared += colour * colour;
+            ++count;
+            ++traced;
+        }
+
+        // The variance of the mean shrinks by the number of samples taken.
+        const glm::vec3 mean = sum / static_cast<float>(count);
+        const glm::vec3 variance = (sumSquared / static_cast<float>(count) - mean * mean) / static_cast<float>(count);
+        if (glm::max(variance.x, glm::max(variance.y, variance.z)) < mAaVarianceThreshold) { break; }
+    }
+
+    return sum / static_cast<float>(count);
+}
+
+std::uint32_t RenderCore::packColour(const glm::vec3 &colour)
+{
+    // Truncates just like the implicit conversion to Uint8 within mcg::drawPixel().
+    const glm::uvec3 channels(glm::clamp(colour, 0.f, 1.f) * 255.f);
+    return channels.r << 16u | channels.g << 8u | channels.b;
+}
+
+float RenderCore::colourDifference(const glm::vec3 &a, const glm::vec3 &b)
+{
+    const glm::vec3 difference = glm::abs(glm::clamp(a, 0.f, 1.f) - glm::clamp(b, 0.f, 1.f));
+    return glm::max(difference.x, glm::max(difference.y, difference.z));
+}
+
+float RenderCore::randomFloat(unsigned int seed, unsigned int index)
+{
+    // Integer hash (lowbias32) of the seed combined with the index.
+    unsigned int x = seed * 0x9e3779b9u + index;
+    x ^= x >> 16u;
+    x *= 0x7feb352du;
+    x ^= x >> 15u;
+    x *= 0x846ca68bu;
+    x ^= x >> 16u;
+    return static_cast<float>(x >> 8u) / 16777216.f;
+}
+
+void RenderCore::changeScene(unsigned int index)
+{
+    mRequestedScene = index;
+}
+
+void RenderCore::updateScene()
+{
+    if (mSceneJob.valid())
+    {
+        if (mSceneJob.wait_for(std::chrono::seconds(0)) != std::future_status::ready) { return; }
+
+        scene level = mSceneJob.get();
+        if (!level.success)
+        {
+            if (mLog != nullptr) { *mLog << "\nCould not load scene " << mLoadingScene << ": " << level.error << "\n"; }
+            if (mLoadingScene == mRequestedScene) { mRequestedScene = mCurrentScene; }  // Don't keep trying.
+        }
+        else if (mLoadingScene == mRequestedScene)
+        {
+            swapScene(std::move(level));
+            mCurrentScene = mLoadingScene;
+        }
+        else
+        {
+            unloadInBackground(std::move(level));  // Another scene was asked for while this one was loading.
+        }
+    }
+
+    if (mRequestedScene != mCurrentScene)  // Already on the correct scene otherwise.
+    {
+        mLoadingScene = mRequestedScene;
+        const glm::ivec2 screenSize = mWindowSize;
+        const unsigned int index = mLoadingScene;
+        const std::string path = index >= lvl::NumberOfScenes ? mSceneFiles[index - lvl::NumberOfScenes] : "";
+        const loadOptions options = mLoadOptions;
+        mSceneJob = std::async(std::launch::async, [screenSize, index, path, options]() {
+            return loadSceneAt(screenSize, index, path, options);
+        });
+    }
+}
+
+scene RenderCore::loadSceneAt(const glm::ivec2 &screenSize, unsigned int index, const std::string &path,
+                             const loadOptions &options)
+{
+    // Scenes are loaded in the background, where nothing would catch a scene too big for memory.
+    try
+    {
+        if (path.empty()) { return loadScene(screenSize, index, options); }
+        if (!isStressDescription(path)) { return loadSceneFile(screenSize, path, options); }
+
+        stressParameters stress;
+        if (!parseStressParameters(path, stress)) { return failedScene("Invalid stress description " + path); }
+        return loadStressScene(screenSize, stress, options);
+    }
+    catch (const std::bad_alloc &)
+    {
+        return failedScene("Not enough memory to load " + (path.empty() ? "scene " + std::to_string(index) : path));
+    }
+}
+
+void RenderCore::swapScene(scene level)
+{
+    if (!level.success) { throw std::exception(); }  // The scene doesn't exits. Should never get here.
+
+    // The frame in flight is using the old scene.
+    cancelFrame();
+    mFrameCount = 0;
+    if (!mIsBounceLimitFixed) { mBounceLimit = 1; }
+
+    std::swap(mScene, level);
+    unloadInBackground(std::move(level));
+
+    if (mLog != nullptr)
+    {
+        *mLog << "\n";
+        printImports(mScene, *mLog);
+        printMemoryUsage(mScene, *mLog);
+    }
+}
+
+void RenderCore::unloadInBackground(scene level)
+{
+    if (mUnloadJob.valid()) { mUnloadJob.get(); }
+    mUnloadJob = std::async(std::launch::async, [](scene oldScene) { unloadScene(oldScene); }, std::move(level));
+}
+
+glm::vec3 RenderCore::trace(Ray &originRay)
+{
+    A2_PROFILE_SCOPE(Tracing);
+    return tracePath(originRay, getHitInWorld(originRay));
+}
+
+glm::vec3 RenderCore::trace(Ray &originRay, const hitInfo &firstHit)
+{
+    A2_PROFILE_SCOPE(Tracing);
+    return tracePath(originRay, firstHit);
+}
+
+glm::vec3 RenderCore::tracePath(Ray &originRay, const hitInfo &firstHit)
+{
+    glm::vec3 colour(0);
+    int deepestPath = 0;
+    int budget = mRayBudget;
+    std::vector<pathBranch> &branches = threadPathBranches;
+    branches.clear();
+
+    // Nothing more can reach the camera down a branch that has no energy left, so those aren't counted as pruned.
+    const auto addBranch = [&](const Ray &ray, int depth, std::uint64_t &counter) {
+        if (depth >= mBounceLimit || glm::dot(ray.mEnergy, ray.mEnergy) <= 0.f) { return; }
+        if (getBrightest(ray.mEnergy) < mEnergyThreshold || budget <= 0)
+        {
+            ++threadRays.pruned;
+            return;
+        }
+        --budget;
+        ++counter;
+        branches.push_back({ ray, depth });
+    };
+
+    pathBranch branch { originRay, 0 };
+    hitInfo hit = firstHit;
+    while (mBounceLimit > 0)
+    {
+        // Shadow tracing changes the energy value for the next ray so we take a copy now.
+        const glm::vec3 energy = branch.ray.mEnergy;
+        Ray transmitted = branch.ray;
+
+        // Trace shadow will also reflect the ray.
+        colour += energy * traceShadows(branch.ray, hit);
+        deepestPath = glm::max(deepestPath, hit.hit ? branch.depth + 1 : branch.depth);
+
+        // Light that can't get through the surface is reflected back instead.
+        if (hit.hit && getBrightest(hit.material.transmissionIntensity) > 0.f)
+        {
+            transmitted.mEnergy = energy * hit.material.transmissionIntensity;
+            if (!refractRay(transmitted, hit))
+            {
+                branch.ray.mEnergy += transmitted.mEnergy;
+                transmitted.mEnergy = glm::vec3(0.f);
+            }
+        }
+        else
+        {
+            transmitted.mEnergy = glm::vec3(0.f);
+        }
+
+        // The stack is last in, first out, so the brighter branch goes on last.
+        const bool isReflectionBrighter = getBrightest(branch.ray.mEnergy) >= getBrightest(transmitted.mEnergy);
+        if (isReflectionBrighter) { addBranch(transmitted, branch.depth + 1, threadRays.refraction); }
+        addBranch(branch.ray, branch.depth + 1, threadRays.reflection);
+        if (!isReflectionBrighter) { addBranch(transmitted, branch.depth + 1, threadRays.refraction); }
+
+        if (branches.empty()) { break; }
+        branch = branches.back();
+        branches.pop_back();
+        hit = getHitInWorld(branch.ray);
+    }
+    threadPathSurfaces = deepestPath;
+    A2_PROFILE_PATH(deepestPath);
+    return colour;
+}
+
+glm::vec3 RenderCore::traceShadows(Ray &ray, const hitInfo &hit)
+{
+    if (!hit.hit)
+    {
+        ray.mEnergy = glm::vec3(0.f);
+        return mShowSkybox ? sampleSkybox(ray.mDirection) : glm::vec3(0.f);
+    }
+
+    A2_PROFILE_SCOPE(Shading);
+
+    // Lighting Calculation.
+    glm::vec3 diffuseColour(0);
+    glm::vec3 specularColour(0);
+    for (auto &light : mScene.lights)
+    {
+        // Construct a rayToLight and fire it towards the light
+        Ray rayToLight = light->getRayToLight(hit.hitPosition);
+        rayToLight.mPosition += hit.hitNormal * 0.001f;  // Offset to avoid artifacts from floating point precision.
+        A2_PROFILE_SHADOW_RAY(static_cast<std::uint32_t>(&light - mScene.lights.data()));
+
+        if (traceToLightSource(rayToLight, light))
+        {
+            // Nothing was hit, so we can apply some shading.
+            shadeLight(ray, hit, rayToLight, light->getInfo(hit.hitPosition), diffuseColour, specularColour);
+        }
+    }
+
+    reflectRay(ray, hit);
+
+    // Times by booleans so that we can isolate channels
+    return  glm::vec3(mShowAmbient) * hit.material.ambientIntensity +
+            glm::vec3(mShowDiffuse) * diffuseColour +
+            glm::vec3(mShowSpecular) * specularColour;
+}
+
+void RenderCore::shadeLight(const Ray &ray, const hitInfo &hit, const Ray &rayToLight, const lightingMaterial &lightInfo,
+                           glm::vec3 &diffuseColour, glm::vec3 &specularColour)
+{
+    // Diffuse Colour
+    float dot = glm::dot(hit.hitNormal, rayToLight.mDirection);
+    if (dot > 0)
+    {
+        diffuseColour += dot * lightInfo.diffuseIntensity * hit.material.diffuseIntensity;
+    }
+
+    // specular
+    glm::vec3 halfDir = glm::normalize(rayToLight.mDirection - ray.mDirection);
+    dot = glm::pow(glm::dot(hit.hitNormal, halfDir), hit.material.shininessConstant);
+    if (dot > 0)
+    {
+        specularColour += dot * lightInfo.specularIntensity * hit.material.specularIntensity;
+    }
+}
+
+bool RenderCore::traceToLightSource(const Ray &ray, const LightSource *lightSource)
+{
+    ++threadRays.shadow;
+    if (lightSource->mType != lightSource->Directional)  // The light source is not infinitely far away.
+    {
+        hitInfo lightHit = getHitInWorld(ray);
+        if (lightHit.hit)
+        {
+            // Is the light source closer than the nearest hit?
+            return (glm::length(ray.mPosition - lightSource->getPosition()) <
+                    glm::length(ray.mPosition - lightHit.hitPosition));
+        }
+        return true;  // Nothing was hit. Therefore clear line of sight.
+    }
+    return !quickGetHitInWorld(ray);  // Directional Lights can use quick hit instead.
+}
+
+void RenderCore::reflectRay(Ray &ray, const hitInfo &hit)
+{
+    ray.mDirection = glm::reflect(ray.mDirection, hit.hitNormal);
+    ray.mPosition = hit.hitPosition + hit.hitNormal * 0.001f;  // Offset to avoid artifacts from floating point precision.
+    ray.mEnergy = ray.mEnergy * hit.material.reflectivityIntensity;
+}
+
+bool RenderCore::refractRay(Ray &ray, const hitInfo &hit)
+{
+    // The normal faces back along the ray, so the ray is going into the object unless it hit the inside.
+    // Snell's law, worked out here because glm::refract() gives NaNs rather than nothing on total internal reflection.
+    const float ratio = hit.isBackFace ? hit.material.refractiveIndex : 1.f / hit.material.refractiveIndex;
+    const float cosine = -glm::dot(ray.mDirection, hit.hitNormal);
+    const float k = 1.f - ratio * ratio * (1.f - cosine * cosine);
+    if (k < 0.f) { return false; }
+
+    ray.mDirection = glm::normalize(ratio * ray.mDirection + (ratio * cosine - glm::sqrt(k)) * hit.hitNormal);
+    ray.mPosition = hit.hitPosition - hit.hitNormal * 0.001f;  // Offset to the other side of the surface.
+    return true;
+}
+
+hitInfo RenderCore::getHitInWorld(const Ray &ray)
+{
+    // Only the actors whose bounds the ray passes through are tested, nearest first.
+    hitInfo closestHit{ false };
+    closestHit.hitPosition = glm::vec3 { 0.f };
+    mScene.actorTree.traverse(ray.mPosition, ray.mDirection, std::numeric_limits<float>::max(),
+                              [&](std::uint32_t actor, float &closestHitLength) {
+        hitInfo cur = mScene.actors[actor]->isIntersecting(ray);
+        A2_PROFILE_INTERSECTION(actor, cur.hit);
+        if (cur.hit)
+        {
+            // Compare to the previous hit to see if it is closer.
+            const float hitDistance = glm::length(cur.hitPosition - ray.mPosition);
+            if (hitDistance < closestHitLength)
+            {
+                closestHit = cur;
+                closestHitLength = hitDistance;
+            }
+        }
+        return false;
+    });
+    return closestHit;
+}
+
+bool RenderCore::quickGetHitInWorld(const Ray &ray)
+{
+    // Any obstruction will do, so stop at the first one.
+    return mScene.actorTree.traverse(ray.mPosition, ray.mDirection, std::numeric_limits<float>::max(),
+                                     [&](std::uint32_t actor, float &) {
+        const bool isHit = mScene.actors[actor]->quickIsIntersecting(ray);
+        A2_PROFILE_INTERSECTION(actor, isHit);
+        return isHit;
+    });
+}
+
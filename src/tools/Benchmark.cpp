@@ -0,0 +1,464 @@
+/**
+ * @file Benchmark.cpp
+ * @brief Renders scenes without a window and writes out how fast they rendered as JSON.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ *
+ * Usage: A2Benchmark [options] [scenes...]
+ *
+ *   --width <pixels>       Defaults to 640.
+ *   --height <pixels>      Defaults to 480.
+ *   --warmup <frames>      Frames rendered before any are measured. Defaults to 3.
+ *   --frames <frames>      Frames measured for each scene. Defaults to 10.
+ *   --bounces <limit>      The bounce limit of every frame. Defaults to 5.
+ *   --threads <count>      Defaults to one per hardware thread.
+ *   --compact              Loads scenes with compact geometry.
+ *   --raster               Finds what the camera rays hit first with the rasterised visibility pass.
+ *   --environment <path>   Surrounds every scene with an HDR image (a PFM file) in place of the sky.
+ *   --out-of-core <MB>     Pages mesh geometry in under the given budget.
+ *   --output <path>        Writes the results there rather than to the standard output.
+ *   --heatmap <cost>       Renders the cost of each pixel instead of the image. One of steps (tree nodes
+ *                          entered), tests (primitives tested), shadows (shadow rays), bounces or time.
+ *   --images <directory>   Writes the last frame of each scene there as a PPM image.
+ *   --views <cameras>      Renders several of each scene's cameras every frame. Either all or a comma separated
+ *                          list of camera indices. Defaults to only the main camera.
+ *   --isa <name>           Uses the row kernels of an instruction set: generic, sse4.2, avx2 or avx512. Defaults
+ *                          to the widest that the CPU supports.
+ *
+ * Scenes are compiled scene files, stress scene descriptions (e.g. stress:spheres:count=10000) or
+ * builtin:<index> for the built in scenes. Every built in scene and a few stress scenes are rendered
+ * if none are given.
+ *
+ * Frame times are measured from the start of the update to the end of anti-aliasing, with the update
+ * for the next frame running alongside, the same as the interactive renderer. Peak memory is for the
+ * whole process so far, so it only grows from one scene to the next. Heatmaps skip anti-aliasing and time
+ * every pixel, so their frame times can't be compared with normal renders. Frames with several views render
+ * all of them, so the rays per second are across every view.
+ */
+
+
+#include "RenderCore.h"
+#include "Kernels.h"
+#include "ProcessMemory.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct benchmarkSettings
+    {
+        glm::ivec2                  resolution { 640, 480 };
+        int                         warmupFrames { 3 };
+        int                         measuredFrames { 10 };
+        int                         bounceLimit { 5 };
+        unsigned int                threadCount { 0 };
+        loadOptions                 options;
+        bool                        isRasterizingVisibility { false };
+        std::string                 environmentPath;
+        std::string                 outputPath;
+        std::string                 imageDirectory;
+        RenderCore::heatmap         heatmap { RenderCore::NoHeatmap };
+        bool                        isRenderingAllViews { false };
+        std::vector<unsigned int>   views;
+        std::vector<std::string>    scenes;
+    };
+
+    struct sceneResult
+    {
+        std::string         name;
+        bool                success;
+        double              loadSeconds;
+        std::vector<double> frameSeconds;
+        std::uint64_t       primaryRays;
+        std::uint64_t       shadowRays;
+        std::uint64_t       reflectionRays;
+        std::uint64_t       refractionRays;
+        std::uint64_t       prunedRays;
+        std::size_t         peakMemory;
+        float               heatmapMax;
+        unsigned int        viewCount;
+    };
+
+    /** The scenes rendered when none are asked for. Large enough to be worth measuring, small enough to be quick. */
+    const char *defaultStressScenes[] = {
+            "stress:spheres:count=2000",
+            "stress:grid:count=250",
+            "stress:mirrors:count=4,depth=3",
+            "stress:mixed:count=2000"
+    };
+
+    const char *builtinNames[lvl::NumberOfScenes] = { "TheDefaultScene", "Triangle", "MirrorRoom", "BasicBall" };
+
+    /** By RenderCore::heatmap. */
+    const std::string heatmapOptions[RenderCore::NumberOfHeatmaps] = { "none", "steps", "tests", "shadows", "bounces", "time" };
+
+    bool readNumber(const char *text, double &value)
+    {
+        char *end;
+        value = std::strtod(text, &end);
+        return *text != '\0' && *end == '\0' && value >= 0.0;
+    }
+
+    /** @returns False if the text isn't all or a list of camera indices like 0,2,3. */
+    bool readViews(const std::string &text, benchmarkSettings &settings)
+    {
+        if (text == "all")
+        {
+            settings.isRenderingAllViews = true;
+            return true;
+        }
+
+        std::size_t start = 0;
+        while (start <= text.size())
+        {
+            const std::size_t end = std::min(text.find(',', start), text.size());
+            double value;
+            if (!readNumber(text.substr(start, end - start).c_str(), value)) { return false; }
+            settings.views.push_back(static_cast<unsigned int>(value));
+            start = end + 1;
+        }
+        return true;
+    }
+
+    /** @returns False (after saying why) if the arguments can't be read. */
+    bool readSettings(int argc, char *argv[], benchmarkSettings &settings)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (argument == "--compact")
+            {
+                settings.options.isCompactingGeometry = true;
+                continue;
+            }
+            if (argument == "--raster")
+            {
+                settings.isRasterizingVisibility = true;
+                continue;
+            }
+            if (argument.compare(0, 2, "--") != 0)
+            {
+                settings.scenes.push_back(argument);
+                continue;
+            }
+
+            double value;
+            if (i + 1 >= argc)
+            {
+                std::cerr << argument << " needs a value\n";
+                return false;
+            }
+            const char *text = argv[++i];
+            if (argument == "--output")
+            {
+                settings.outputPath = text;
+                continue;
+            }
+            if (argument == "--environment")
+            {
+                settings.environmentPath = text;
+                continue;
+            }
+            if (argument == "--images")
+            {
+                settings.imageDirectory = text;
+                continue;
+            }
+            if (argument == "--heatmap")
+            {
+                const std::string *option = std::find(std::begin(heatmapOptions), std::end(heatmapOptions), text);
+                if (option == std::end(heatmapOptions))
+                {
+                    std::cerr << "Unknown heatmap " << text << "\n";
+                    return false;
+                }
+                settings.heatmap = static_cast<RenderCore::heatmap>(option - std::begin(heatmapOptions));
+                continue;
+            }
+            if (argument == "--isa")
+            {
+                kernels::isa isa;
+                if (!kernels::readName(text, isa))
+                {
+                    std::cerr << "Unknown instruction set " << text << "\n";
+                    return false;
+                }
+                kernels::select(isa);
+                continue;
+            }
+            if (argument == "--views")
+            {
+                if (!readViews(text, settings))
+                {
+                    std::cerr << "--views needs all or a list of camera indices, not " << text << "\n";
+                    return false;
+                }
+                continue;
+            }
+            if (!readNumber(text, value))
+            {
+                std::cerr << argument << " needs a number, not " << text << "\n";
+                return false;
+            }
+
+            if (argument == "--width")              { settings.resolution.x = static_cast<int>(value); }
+            else if (argument == "--height")        { settings.resolution.y = static_cast<int>(value); }
+            else if (argument == "--warmup")        { settings.warmupFrames = static_cast<int>(value); }
+            else if (argument == "--frames")        { settings.measuredFrames = static_cast<int>(value); }
+            else if (argument == "--bounces")       { settings.bounceLimit = static_cast<int>(value); }
+            else if (argument == "--threads")       { settings.threadCount = static_cast<unsigned int>(value); }
+            else if (argument == "--out-of-core")
+            {
+                settings.options.residentBudget = static_cast<std::size_t>(value * 1024.0 * 1024.0);
+            }
+            else
+            {
+                std::cerr << "Unknown option " << argument << "\n";
+                return false;
+            }
+        }
+
+        if (settings.resolution.x <= 0 || settings.resolution.y <= 0 || settings.measuredFrames <= 0
+            || settings.bounceLimit <= 0)
+        {
+            std::cerr << "The resolution, frame count and bounce limit must be above 0\n";
+            return false;
+        }
+
+        if (settings.scenes.empty())
+        {
+            for (int i = 0; i < lvl::NumberOfScenes; ++i)
+            {
+                settings.scenes.push_back("builtin:" + std::to_string(i));
+            }
+            settings.scenes.insert(settings.scenes.end(), std::begin(defaultStressScenes),
+                                   std::end(defaultStressScenes));
+        }
+        return true;
+    }
+
+    /** @returns The p-th percentile (0 to 1) of sorted values, interpolating between the closest two. */
+    double percentile(const std::vector<double> &sorted, double p)
+    {
+        const double position = p * static_cast<double>(sorted.size() - 1);
+        const auto below = static_cast<std::size_t>(position);
+        const std::size_t above = std::min(below + 1, sorted.size() - 1);
+        return sorted[below] + (sorted[above] - sorted[below]) * (position - static_cast<double>(below));
+    }
+
+    /** @returns The name with anything that might not be allowed in a file name replaced. */
+    std::string toFileName(const std::string &name)
+    {
+        std::string fileName = name;
+        for (char &c : fileName)
+        {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '.') { c = '_'; }
+        }
+        return fileName;
+    }
+
+    std::string escapeJson(const std::string &text)
+    {
+        std::string escaped;
+        for (const char c : text)
+        {
+            switch (c)
+            {
+                case '"':   escaped += "\\\""; break;
+                case '\\':  escaped += "\\\\"; break;
+                case '\n':  escaped += "\\n"; break;
+                case '\t':  escaped += "\\t"; break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) { escaped += ' '; }
+                    else                                      { escaped += c; }
+                    break;
+            }
+        }
+        return escaped;
+    }
+
+    void writeResults(std::ostream &out, const benchmarkSettings &settings, unsigned int threadCount,
+                      const std::vector<sceneResult> &results)
+    {
+        out << "{\n"
+            << "  \"settings\": {\n"
+            << "    \"width\": " << settings.resolution.x << ",\n"
+            << "    \"height\": " << settings.resolution.y << ",\n"
+            << "    \"warmupFrames\": " << settings.warmupFrames << ",\n"
+            << "    \"measuredFrames\": " << settings.measuredFrames << ",\n"
+            << "    \"bounceLimit\": " << settings.bounceLimit << ",\n"
+            << "    \"threads\": " << threadCount << ",\n"
+            << "    \"compact\": " << (settings.options.isCompactingGeometry ? "true" : "false") << ",\n"
+            << "    \"residentBudgetBytes\": " << settings.options.residentBudget << ",\n"
+            << "    \"raster\": " << (settings.isRasterizingVisibility ? "true" : "false") << ",\n"
+            << "    \"isa\": \"" << kernels::getName(kernels::getSelected()) << "\",\n"
+            << "    \"heatmap\": \"" << heatmapOptions[settings.heatmap] << "\"\n"
+            << "  },\n"
+            << "  \"scenes\": [";
+
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const sceneResult &result = results[i];
+            out << (i == 0 ? "\n" : ",\n")
+                << "    {\n"
+                << "      \"name\": \"" << escapeJson(result.name) << "\",\n"
+                << "      \"success\": " << (result.success ? "true" : "false");
+            if (!result.success)
+            {
+                out << "\n    }";
+                continue;
+            }
+
+            std::vector<double> sorted = result.frameSeconds;
+            std::sort(sorted.begin(), sorted.end());
+            double total = 0.0;
+            for (const double seconds : sorted) { total += seconds; }
+            const double mean = total / static_cast<double>(sorted.size());
+
+            out << ",\n"
+                << "      \"loadMs\": " << result.loadSeconds * 1000.0 << ",\n"
+                << "      \"meanFrameMs\": " << mean * 1000.0 << ",\n"
+                << "      \"medianFrameMs\": " << percentile(sorted, 0.5) * 1000.0 << ",\n"
+                << "      \"p99FrameMs\": " << percentile(sorted, 0.99) * 1000.0 << ",\n"
+                << "      \"minFrameMs\": " << sorted.front() * 1000.0 << ",\n"
+                << "      \"maxFrameMs\": " << sorted.back() * 1000.0 << ",\n"
+                << "      \"primaryRaysPerSecond\": " << static_cast<double>(result.primaryRays) / total << ",\n"
+                << "      \"shadowRaysPerSecond\": " << static_cast<double>(result.shadowRays) / total << ",\n"
+                << "      \"reflectionRaysPerSecond\": " << static_cast<double>(result.reflectionRays) / total << ",\n"
+                << "      \"refractionRaysPerSecond\": " << static_cast<double>(result.refractionRays) / total << ",\n"
+                << "      \"prunedRaysPerFrame\": "
+                << static_cast<double>(result.prunedRays) / static_cast<double>(sorted.size()) << ",\n"
+                << "      \"peakMemoryBytes\": " << result.peakMemory << ",\n"
+                << "      \"views\": " << result.viewCount;
+            if (settings.heatmap != RenderCore::NoHeatmap)
+            {
+                out << ",\n      \"heatmapMax\": " << result.heatmapMax;
+            }
+            out << "\n    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    benchmarkSettings settings;
+    if (!readSettings(argc, argv, settings)) { return 1; }
+
+    // Built in scenes are picked by index, everything else is added to the renderer's scene files as it's loaded.
+    std::vector<unsigned int> sceneIndices;
+    for (const std::string &name : settings.scenes)
+    {
+        const std::string builtin = "builtin:";
+        if (name.compare(0, builtin.size(), builtin) == 0)
+        {
+            const unsigned int index = static_cast<unsigned int>(std::strtoul(name.c_str() + builtin.size(), nullptr, 10));
+            if (index >= lvl::NumberOfScenes)
+            {
+                std::cerr << "There is no built in scene " << index << "\n";
+                return 1;
+            }
+            sceneIndices.push_back(index);
+        }
+        else
+        {
+            sceneIndices.push_back(lvl::NumberOfScenes);
+        }
+    }
+
+    std::cerr << "Kernels: " << kernels::describeSelection() << "\n";
+
+    rendererOptions renderer;
+    renderer.threadCount = settings.threadCount;
+    renderer.isRasterizingVisibility = settings.isRasterizingVisibility;
+    RenderCore renderCore(settings.resolution, {}, settings.options, renderer);
+    renderCore.setBounceLimit(settings.bounceLimit);
+    if (!settings.environmentPath.empty())
+    {
+        std::string error;
+        if (!renderCore.setEnvironment(settings.environmentPath, &error)) { std::cerr << error << "\n"; }
+    }
+    renderCore.setHeatmap(settings.heatmap);
+    if (settings.isRenderingAllViews)   { renderCore.setAllViews(); }
+    else                                { renderCore.setViews(settings.views); }
+
+    std::vector<sceneResult> results;
+    for (std::size_t i = 0; i < sceneIndices.size(); ++i)
+    {
+        const unsigned int index = sceneIndices[i];
+        sceneResult result { index < lvl::NumberOfScenes ? builtinNames[index] : settings.scenes[i] };
+        std::cerr << "Benchmarking " << result.name << "\n";
+
+        // Loading is the only time the renderer has anything to say (what it imported or why it couldn't), and
+        // it goes beside the progress rather than into the results.
+        renderCore.setLog(&std::cerr);
+        const auto loadStart = std::chrono::steady_clock::now();
+        result.success = index < lvl::NumberOfScenes ? renderCore.loadSceneNow(index)
+                                                     : renderCore.loadSceneNow(settings.scenes[i]);
+        result.loadSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count();
+        renderCore.setLog(nullptr);
+        if (!result.success)
+        {
+            std::cerr << "Could not load " << result.name << "\n";
+            results.push_back(result);
+            continue;
+        }
+
+        for (int frame = 0; frame < settings.warmupFrames; ++frame)
+        {
+            renderCore.renderFrame();
+        }
+
+        for (int frame = 0; frame < settings.measuredFrames; ++frame)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            renderCore.renderFrame();
+            result.frameSeconds.push_back(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+            const RenderCore::rayCounts rays = renderCore.getLastFrameRays();
+            result.primaryRays += rays.primary;
+            result.shadowRays += rays.shadow;
+            result.reflectionRays += rays.reflection;
+            result.refractionRays += rays.refraction;
+            result.prunedRays += rays.pruned;
+        }
+        result.peakMemory = getPeakMemoryUsage();
+        result.heatmapMax = renderCore.getLastHeatmapMax();
+        result.viewCount = renderCore.getViewCount();
+        results.push_back(result);
+
+        // Only the views after the first are numbered, so single view runs keep the same file names.
+        for (unsigned int view = 0; !settings.imageDirectory.empty() && view < result.viewCount; ++view)
+        {
+            const std::string path = settings.imageDirectory + "/" + std::to_string(i) + "-" + toFileName(result.name)
+                                     + (view > 0 ? "-view" + std::to_string(view) : "") + ".ppm";
+            if (!renderCore.writeImage(path, view)) { std::cerr << "Could not write " << path << "\n"; }
+        }
+    }
+
+    const unsigned int threadCount = renderCore.getThreadCount();
+    if (settings.outputPath.empty())
+    {
+        writeResults(std::cout, settings, threadCount, results);
+    }
+    else
+    {
+        std::ofstream output(settings.outputPath);
+        writeResults(output, settings, threadCount, results);
+        if (!output)
+        {
+            std::cerr << "Could not write " << settings.outputPath << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,456 @@
+/**
+ * @file MicroBenchmark.cpp
+ * @brief Times the kernels that every ray goes through in isolation from the rest of the renderer.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ *
+ * Usage: A2MicroBenchmark [--baseline <path>] [--save <path>] [--tolerance <percent>] [--seconds <seconds>]
+ *                         [--isa <name>]
+ *
+ *   --baseline <path>      Compares every kernel against the results saved there.
+ *   --save <path>          Saves the results so that later runs can be compared against them.
+ *   --tolerance <percent>  How much slower than the baseline a kernel can be before it counts as a regression.
+ *                          Defaults to 10.
+ *   --seconds <seconds>    How long each kernel is run for. Defaults to 0.25.
+ *   --isa <name>           Uses the row kernels of an instruction set: generic, sse4.2, avx2 or avx512. Defaults
+ *                          to the widest that the CPU supports.
+ *
+ * Every kernel runs over a fixed set of inputs made from the same seed each time, with a mix of hits and
+ * misses where it matters. Exits with 1 if any kernel regressed against the baseline.
+ * Cycles are read from the time stamp counter, so they're reference cycles rather than core cycles and
+ * are only reported on x86.
+ */
+
+
+#include "RenderCore.h"
+#include "Kernels.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define A2_HAS_CYCLE_COUNTER
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define A2_HAS_CYCLE_COUNTER
+#endif
+
+namespace
+{
+    /** The number of inputs in each set. Small enough to stay in the cache so that only the kernel is timed. */
+    const std::size_t inputCount = 4096;
+
+    /** Where every kernel's results end up, so that the compiler can't throw them away along with their work. */
+    volatile std::size_t resultSink = 0;
+
+    struct kernelResult
+    {
+        std::string name;
+        double      nsPerOp;
+        double      cyclesPerOp;
+
+        /** The fraction of inputs that hit, or negative if the kernel doesn't hit anything. */
+        double      hitRate;
+    };
+
+    /** The same seed always gives the same inputs on every platform, unlike the standard distributions. */
+    struct random
+    {
+        std::mt19937 engine { 20261019u };
+
+        float range(float min, float max)
+        {
+            return min + (max - min) * static_cast<float>(engine() >> 8) / 16777216.f;
+        }
+
+        glm::vec3 direction()
+        {
+            // Rejection sampling inside the unit sphere gives directions without any bias.
+            while (true)
+            {
+                const glm::vec3 point(range(-1.f, 1.f), range(-1.f, 1.f), range(-1.f, 1.f));
+                const float length = glm::length(point);
+                if (length > 0.01f && length <= 1.f) { return point / length; }
+            }
+        }
+    };
+
+    std::uint64_t readCycles()
+    {
+#ifdef A2_HAS_CYCLE_COUNTER
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    /** Rays that start around the target and point roughly at it. About half of them hit a target of this size. */
+    std::vector<Ray> makeRays(random &generator, const glm::vec3 &target, float targetSize)
+    {
+        std::vector<Ray> rays;
+        rays.reserve(inputCount);
+        for (std::size_t i = 0; i < inputCount; ++i)
+        {
+            const glm::vec3 origin = target + generator.direction() * 10.f;
+            const glm::vec3 aim = target + generator.direction() * targetSize * generator.range(0.f, 2.f);
+            rays.emplace_back(origin, glm::normalize(aim - origin), glm::vec3(1.f));
+        }
+        return rays;
+    }
+
+    /** The time for each kernel is split into this many trials. Only the fastest counts, which filters out noise. */
+    const int trialCount = 5;
+
+    /**
+     * Calls kernel(i) for every input again and again until the time is up.
+     * @param kernel Returns whether input i hit. Kernels that don't hit anything return false.
+     */
+    template<typename Kernel>
+    kernelResult measure(const std::string &name, double seconds, bool isHitting, Kernel kernel)
+    {
+        // One pass to warm the caches and count the hits, which are the same on every pass.
+        std::size_t hits = 0;
+        for (std::size_t i = 0; i < inputCount; ++i)
+        {
+            hits += kernel(i) ? 1 : 0;
+        }
+
+        kernelResult best { name, std::numeric_limits<double>::max(), 0.0,
+                            isHitting ? static_cast<double>(hits) / inputCount : -1.0 };
+        std::size_t sink = 0;
+        for (int trial = 0; trial < trialCount; ++trial)
+        {
+            std::uint64_t operations = 0;
+            const auto start = std::chrono::steady_clock::now();
+            const std::uint64_t startCycles = readCycles();
+            double elapsed = 0.0;
+            while (elapsed < seconds / trialCount)
+            {
+                for (std::size_t i = 0; i < inputCount; ++i)
+                {
+                    sink += kernel(i) ? 1 : 0;
+                }
+                operations += inputCount;
+                elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            }
+            const std::uint64_t cycles = readCycles() - startCycles;
+
+            const double nsPerOp = elapsed * 1e9 / static_cast<double>(operations);
+            if (nsPerOp < best.nsPerOp)
+            {
+                best.nsPerOp = nsPerOp;
+                best.cyclesPerOp = static_cast<double>(cycles) / static_cast<double>(operations);
+            }
+        }
+
+        resultSink = resultSink + sink;
+        return best;
+    }
+
+    /** Makes the kernels that are protected in the renderer reachable. */
+    class KernelRenderer : public RenderCore
+    {
+    public:
+        KernelRenderer() : RenderCore({ 64, 64 }, {}, {}, singleThreaded()) {}
+
+        using RenderCore::sampleSkybox;
+        using RenderCore::shadeLight;
+
+    private:
+        static rendererOptions singleThreaded()
+        {
+            rendererOptions options;
+            options.threadCount = 1;
+            return options;
+        }
+    };
+
+    /** A camera that has just moved, so it generates rays without its cache like a dynamic camera does. */
+    class MovingCamera : public Camera
+    {
+    public:
+        explicit MovingCamera(const glm::ivec2 &resolution) :
+            Camera(glm::vec3(0.f, 1.5f, 6.f), glm::vec3(-0.1f, 0.3f, 0.f), glm::vec3(1.f), resolution, 22.5f)
+        {
+            setStatic(false);
+            mPosition.x += 0.1f;
+            updateMat();
+            commit();
+        }
+    };
+
+    /** The number of rays generated by each row kernel, the same as the width of a tile. */
+    const int rowLength = 32;
+
+    /** Accumulates the output of kernels that return colours so that it can't be optimised away. */
+    bool consume(const glm::vec3 &colour)
+    {
+        return colour.x + colour.y + colour.z > 1e30f;
+    }
+
+    std::vector<kernelResult> runKernels(double seconds)
+    {
+        random generator;
+        std::vector<kernelResult> results;
+
+        const actorLightingMaterial material(glm::vec3(0.5f), glm::vec3(1.f), glm::vec3(0.2f), 50.f);
+
+        Sphere sphere(glm::vec3(0.f), material, 1.f);
+        const std::vector<Ray> sphereRays = makeRays(generator, glm::vec3(0.f), 1.f);
+        results.push_back(measure("Sphere::isIntersecting", seconds, true, [&](std::size_t i) {
+            return sphere.isIntersecting(sphereRays[i]).hit;
+        }));
+        results.push_back(measure("Sphere::quickIsIntersecting", seconds, true, [&](std::size_t i) {
+            return sphere.quickIsIntersecting(sphereRays[i]);
+        }));
+
+        // Each orientation uses a different pair of axes for the point in triangle test.
+        struct triCase
+        {
+            const char  *name;
+            glm::vec3   corners[3];
+        };
+        const triCase triCases[] = {
+                { "Tri::isIntersecting (Xy)", { glm::vec3(-1.f, -1.f, 0.f), glm::vec3(1.f, -1.f, 0.f), glm::vec3(0.f, 1.f, 0.f) } },
+                { "Tri::isIntersecting (Xz)", { glm::vec3(-1.f, 0.f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(1.f, 0.f, -1.f) } },
+                { "Tri::isIntersecting (Yz)", { glm::vec3(0.f, -1.f, -1.f), glm::vec3(0.f, 1.f, 0.f), glm::vec3(0.f, -1.f, 1.f) } }
+        };
+        for (const triCase &triangle : triCases)
+        {
+            vertex vertices[3] = { vertex(triangle.corners[0]), vertex(triangle.corners[1]), vertex(triangle.corners[2]) };
+            Tri tri(glm::vec3(0.f), glm::vec3(0.f), glm::vec3(1.f), material, vertices);
+            const std::vector<Ray> triRays = makeRays(generator, glm::vec3(0.f), 0.6f);
+            results.push_back(measure(triangle.name, seconds, true, [&](std::size_t i) {
+                return tri.isIntersecting(triRays[i]).hit;
+            }));
+        }
+
+        const glm::ivec2 resolution(640, 480);
+        Camera camera(glm::vec3(0.f, 1.5f, 6.f), glm::vec3(-0.1f, 0.3f, 0.f), glm::vec3(1.f), resolution, 22.5f);
+        std::vector<glm::ivec2> pixels;
+        for (std::size_t i = 0; i < inputCount; ++i)
+        {
+            pixels.emplace_back(generator.range(0.f, resolution.x), generator.range(0.f, resolution.y));
+        }
+        results.push_back(measure("Camera::generateSingleRay (cached)", seconds, false, [&](std::size_t i) {
+            return consume(camera.generateSingleRay(pixels[i]).mDirection);
+        }));
+
+        // A camera that moved in its last commit has nothing cached.
+        MovingCamera movingCamera(resolution);
+        results.push_back(measure("Camera::generateSingleRay (moving)", seconds, false, [&](std::size_t i) {
+            return consume(movingCamera.generateSingleRay(pixels[i]).mDirection);
+        }));
+        Ray row[rowLength];
+        results.push_back(measure("Camera::generateRow x32 (moving)", seconds, false, [&](std::size_t i) {
+            movingCamera.generateRow({ glm::min(pixels[i].x, resolution.x - rowLength), pixels[i].y }, rowLength, 1, row);
+            return consume(row[rowLength - 1].mDirection);
+        }));
+
+        // A row of colours either side of [0, 1], and a row of a triangle that covers most of it over a half full row.
+        std::vector<glm::vec3> colours;
+        for (std::size_t i = 0; i < inputCount; ++i)
+        {
+            colours.emplace_back(generator.range(-0.2f, 1.2f), generator.range(-0.2f, 1.2f), generator.range(-0.2f, 1.2f));
+        }
+        std::uint32_t packed[rowLength];
+        const kernels::table &kernel = kernels::get();
+        results.push_back(measure("kernels::packColours x32", seconds, false, [&](std::size_t i) {
+            kernel.packColours(&colours[i & ~static_cast<std::size_t>(rowLength - 1)].x, packed, rowLength);
+            return packed[rowLength - 1] == 0xFFFFFFFFu;
+        }));
+
+        std::vector<float> inverseDepths;
+        for (std::size_t i = 0; i < inputCount; ++i)
+        {
+            inverseDepths.push_back(generator.range(0.f, 1.f));
+        }
+        std::vector<std::uint32_t> actors(inputCount, 0);
+        std::vector<std::uint32_t> primitives(inputCount, 0);
+        const kernels::rasterSpan span { { 0.01f, -0.01f, 0.f }, { 0.f, 0.3f, 0.7f }, 0.f, 0.5f, 0, rowLength, 1, 2 };
+        results.push_back(measure("kernels::rasteriseSpan x32", seconds, false, [&](std::size_t i) {
+            const std::size_t row = i & ~static_cast<std::size_t>(rowLength - 1);
+            kernel.rasteriseSpan(span, &inverseDepths[row], &actors[row], &primitives[row]);
+            return actors[row] == 0xFFFFFFFFu;
+        }));
+
+        // A full leaf of a mesh's tree: the three triangles above and one facing along Z that's further back. Its rays
+        // come from a generator of their own so that the inputs of everything else stay the same.
+        const glm::vec3 leaf[12] = {
+                glm::vec3(-1.f, -1.f, 0.f), glm::vec3(1.f, -1.f, 0.f), glm::vec3(0.f, 1.f, 0.f),
+                glm::vec3(-1.f, 0.f, -1.f), glm::vec3(0.f, 0.f, 1.f), glm::vec3(1.f, 0.f, -1.f),
+                glm::vec3(0.f, -1.f, -1.f), glm::vec3(0.f, 1.f, 0.f), glm::vec3(0.f, -1.f, 1.f),
+                glm::vec3(-1.f, -1.f, -0.5f), glm::vec3(0.f, 1.f, -0.5f), glm::vec3(1.f, -1.f, -0.5f)
+        };
+        random leafGenerator;
+        const std::vector<Ray> leafRays = makeRays(leafGenerator, glm::vec3(0.f), 0.6f);
+        float leafDistances[4];
+        results.push_back(measure("kernels::intersectTriangles x4", seconds, true, [&](std::size_t i) {
+            return kernel.intersectTriangles(&leaf[0].x, 4, &leafRays[i].mPosition.x, &leafRays[i].mDirection.x,
+                                             std::numeric_limits<float>::max(), leafDistances) != 0;
+        }));
+
+        KernelRenderer renderer;
+        std::vector<glm::vec3> directions;
+        for (std::size_t i = 0; i < inputCount; ++i)
+        {
+            directions.push_back(generator.direction());
+        }
+        results.push_back(measure("RenderCore::sampleSkybox", seconds, false, [&](std::size_t i) {
+            return consume(renderer.sampleSkybox(directions[i]));
+        }));
+
+        std::vector<glm::vec3> positions;
+        for (std::size_t i = 0; i < inputCount; ++i)
+        {
+            positions.push_back(generator.direction() * generator.range(0.5f, 5.f));
+        }
+        LightSource pointLight(glm::vec3(0.f, 4.f, 0.f), glm::vec3(1.f), 75.f);
+        LightSource directionalLight(glm::vec3(1.f), glm::vec3(1.f));
+        results.push_back(measure("LightSource::getInfo (Point)", seconds, false, [&](std::size_t i) {
+            return consume(pointLight.getInfo(positions[i]).diffuseIntensity);
+        }));
+        results.push_back(measure("LightSource::getInfo (Directional)", seconds, false, [&](std::size_t i) {
+            return consume(directionalLight.getInfo(positions[i]).diffuseIntensity);
+        }));
+
+        // Hits on the sphere facing in every direction, so about half of them face away from the light.
+        std::vector<hitInfo> hits;
+        std::vector<Ray> lightRays;
+        std::vector<lightingMaterial> lightInfos;
+        for (std::size_t i = 0; i < inputCount; ++i)
+        {
+            const glm::vec3 normal = generator.direction();
+            hits.push_back({ true, normal, normal, material });
+            lightRays.push_back(pointLight.getRayToLight(normal));
+            lightInfos.push_back(pointLight.getInfo(normal));
+        }
+        results.push_back(measure("RenderCore::shadeLight (Blinn-Phong)", seconds, false, [&](std::size_t i) {
+            glm::vec3 diffuse(0.f);
+            glm::vec3 specular(0.f);
+            KernelRenderer::shadeLight(sphereRays[i], hits[i], lightRays[i], lightInfos[i], diffuse, specular);
+            return consume(diffuse + specular);
+        }));
+
+        return results;
+    }
+
+    /** Reads results saved by saveBaseline(). One kernel per line: the ns/op, cycles/op and then the name. */
+    std::map<std::string, kernelResult> loadBaseline(const std::string &path, bool &success)
+    {
+        std::map<std::string, kernelResult> baseline;
+        std::ifstream input(path);
+        success = static_cast<bool>(input);
+
+        kernelResult result;
+        while (input >> result.nsPerOp >> result.cyclesPerOp >> std::ws && std::getline(input, result.name))
+        {
+            baseline[result.name] = result;
+        }
+        return baseline;
+    }
+
+    bool saveBaseline(const std::string &path, const std::vector<kernelResult> &results)
+    {
+        std::ofstream output(path);
+        for (const kernelResult &result : results)
+        {
+            output << result.nsPerOp << " " << result.cyclesPerOp << " " << result.name << "\n";
+        }
+        return static_cast<bool>(output);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    std::string baselinePath;
+    std::string savePath;
+    double tolerance = 10.0;
+    double seconds = 0.25;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string argument = argv[i];
+        if (i + 1 >= argc)
+        {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--baseline <path>] [--save <path>] [--tolerance <percent>] [--seconds <seconds>]"
+                         " [--isa <name>]\n";
+            return 1;
+        }
+        const char *value = argv[++i];
+        if (argument == "--isa")
+        {
+            kernels::isa isa;
+            if (!kernels::readName(value, isa))
+            {
+                std::cerr << "Unknown instruction set " << value << "\n";
+                return 1;
+            }
+            kernels::select(isa);
+        }
+        else if (argument == "--baseline")  { baselinePath = value; }
+        else if (argument == "--save")      { savePath = value; }
+        else if (argument == "--tolerance") { tolerance = std::atof(value); }
+        else if (argument == "--seconds")   { seconds = std::atof(value); }
+        else
+        {
+            std::cerr << "Unknown option " << argument << "\n";
+            return 1;
+        }
+    }
+
+    bool hasBaseline = false;
+    std::map<std::string, kernelResult> baseline;
+    if (!baselinePath.empty())
+    {
+        baseline = loadBaseline(baselinePath, hasBaseline);
+        if (!hasBaseline) { std::cerr << "Could not read " << baselinePath << "\n"; }
+    }
+
+    std::cerr << "Kernels: " << kernels::describeSelection() << "\n";
+    const std::vector<kernelResult> results = runKernels(seconds);
+
+    bool hasRegressed = false;
+    std::cout << std::fixed << std::setprecision(2)
+              << std::left << std::setw(40) << "Kernel" << std::right << std::setw(10) << "ns/op"
+              << std::setw(12) << "cycles/op" << std::setw(10) << "hits";
+    if (hasBaseline) { std::cout << std::setw(12) << "baseline" << std::setw(10) << "change"; }
+    std::cout << "\n";
+
+    for (const kernelResult &result : results)
+    {
+        std::cout << std::left << std::setw(40) << result.name << std::right << std::setw(10) << result.nsPerOp
+                  << std::setw(12) << result.cyclesPerOp;
+        if (result.hitRate >= 0.0)  { std::cout << std::setw(9) << result.hitRate * 100.0 << "%"; }
+        else                        { std::cout << std::setw(10) << "-"; }
+
+        const auto found = baseline.find(result.name);
+        if (found != baseline.end())
+        {
+            const double change = (result.nsPerOp / found->second.nsPerOp - 1.0) * 100.0;
+            const bool isRegression = change > tolerance;
+            hasRegressed = hasRegressed || isRegression;
+            std::cout << std::setw(12) << found->second.nsPerOp << std::setw(9) << std::showpos << change
+                      << std::noshowpos << "%" << (isRegression ? "  REGRESSED" : "");
+        }
+        std::cout << "\n";
+    }
+
+    if (!savePath.empty() && !saveBaseline(savePath, results))
+    {
+        std::cerr << "Could not write " << savePath << "\n";
+        return 1;
+    }
+    return hasRegressed ? 1 : 0;
+}
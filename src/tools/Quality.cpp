@@ -0,0 +1,767 @@
+/**
+ * @file Quality.cpp
+ * @brief Measures how much image quality each render configuration gives up for its speed.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ *
+ * Usage: A2Quality [options] [scenes...]
+ *
+ *   --references <directory>   Where the reference images are kept. Any that are missing are rendered first.
+ *                              Defaults to "references", which is created if it doesn't exist.
+ *   --rebuild                  Renders the reference images again even if they exist.
+ *   --width <pixels>           Defaults to 640.
+ *   --height <pixels>          Defaults to 480.
+ *   --frames <frames>          Frames rendered before the image is taken. Dynamic scenes move between frames, so
+ *                              references are only valid for the same count. Defaults to 1.
+ *   --threads <count>          Defaults to one per hardware thread.
+ *   --configs <a,b,...>        The configurations to measure. Defaults to all of them: default, no-aa,
+ *                              aa-full-budget, bounces-2, bounces-3, half-resolution, raster-visibility and compact.
+ *   --reference-grid <size>    The anti-aliasing grid that every reference pixel is sampled over. Defaults to 8.
+ *   --determinism              Also renders every exact configuration with 1, 2 and every hardware thread and
+ *                              checks that the images are bit for bit the same.
+ *   --output <path>            Writes the results there rather than to the standard output.
+ *   --plot <path>              Plots the mean error of each configuration against its mean frame time as an SVG.
+ *
+ * Scenes are given the same way as A2Benchmark, and every built in scene is measured if none are given.
+ *
+ * References are rendered at a bounce limit of 16 with every pixel super sampled over the whole reference grid.
+ * Each configuration is compared against them by PSNR over RGB, SSIM over luma (8x8 windows every 4 pixels)
+ * and the mean CIE76 colour difference in CIELAB as a rough perceptual measure, where about 2.3 is just noticeable.
+ * Configurations that render at a lower resolution are scaled back up bilinearly first. PSNR is null for images
+ * that are identical to the reference. Exits with 1 if a determinism check fails.
+ */
+
+
+#include "Kernels.h"
+#include "RenderCore.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    /** A render configuration that trades quality for speed (or doesn't, for the default). */
+    struct renderConfig
+    {
+        std::string     name;
+        std::string     description;
+        int             bounceLimit { 5 };
+
+        /** Rendered at this fraction of the resolution and scaled back up. */
+        float           resolutionScale { 1.f };
+        rendererOptions renderer;
+        loadOptions     options;
+
+        /**
+         * Must give the same image no matter how many threads render it. That doesn't make it the same image as
+         * the default configuration, which is what the error against the references shows.
+         */
+        bool            isExact { true };
+    };
+
+    struct image
+    {
+        glm::ivec2                  size { 0 };
+
+        /** Packed as 0xRRGGBB. Row major. */
+        std::vector<std::uint32_t>  pixels;
+    };
+
+    struct qualitySettings
+    {
+        glm::ivec2                  resolution { 640, 480 };
+        int                         frames { 1 };
+        unsigned int                threadCount { 0 };
+        int                         referenceGridSize { 8 };
+        bool                        isRebuilding { false };
+        bool                        isCheckingDeterminism { false };
+        std::string                 referenceDirectory { "references" };
+        std::string                 outputPath;
+        std::string                 plotPath;
+        std::vector<std::string>    configNames;
+        std::vector<std::string>    scenes;
+    };
+
+    struct sceneResult
+    {
+        std::string     name;
+        bool            success;
+        double          frameSeconds;
+        double          psnr;
+        double          ssim;
+        double          meanDeltaE;
+
+        /** Not checked unless asked for. */
+        bool            isChecked;
+        bool            isDeterministic;
+    };
+
+    struct configResult
+    {
+        const renderConfig          *config;
+        std::vector<sceneResult>    scenes;
+    };
+
+    const char *builtinNames[lvl::NumberOfScenes] = { "TheDefaultScene", "Triangle", "MirrorRoom", "BasicBall" };
+
+    std::vector<renderConfig> makeConfigs()
+    {
+        std::vector<renderConfig> configs;
+
+        renderConfig config;
+        config.name = "default";
+        config.description = "What the interactive renderer settles on";
+        configs.push_back(config);
+
+        config.name = "no-aa";
+        config.description = "Anti-aliasing off";
+        config.renderer.antiAliasing.isEnabled = false;
+        configs.push_back(config);
+        config.renderer.antiAliasing.isEnabled = true;
+
+        config.name = "aa-full-budget";
+        config.description = "Four times the anti-aliasing budget";
+        config.renderer.antiAliasing.sampleBudget = 1.f;
+        configs.push_back(config);
+        config.renderer.antiAliasing.sampleBudget = antiAliasingOptions().sampleBudget;
+
+        config.name = "bounces-2";
+        config.description = "Bounce limit of 2";
+        config.bounceLimit = 2;
+        configs.push_back(config);
+
+        config.name = "bounces-3";
+        config.description = "Bounce limit of 3";
+        config.bounceLimit = 3;
+        configs.push_back(config);
+        config.bounceLimit = renderConfig().bounceLimit;
+
+        config.name = "half-resolution";
+        config.description = "Half the resolution, scaled back up";
+        config.resolutionScale = 0.5f;
+        configs.push_back(config);
+        config.resolutionScale = 1.f;
+
+        config.name = "raster-visibility";
+        config.description = "Primary hits from the rasterised visibility buffer (a few edge pixels can differ)";
+        config.renderer.isRasterizingVisibility = true;
+        configs.push_back(config);
+        config.renderer.isRasterizingVisibility = false;
+
+        config.name = "compact";
+        config.description = "Compact mesh geometry";
+        config.options.isCompactingGeometry = true;
+        configs.push_back(config);
+        return configs;
+    }
+
+    bool readNumber(const char *text, double &value)
+    {
+        char *end;
+        value = std::strtod(text, &end);
+        return *text != '\0' && *end == '\0' && value >= 0.0;
+    }
+
+    /** @returns False (after saying why) if the arguments can't be read. */
+    bool readSettings(int argc, char *argv[], qualitySettings &settings)
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            const std::string argument = argv[i];
+            if (argument == "--rebuild")
+            {
+                settings.isRebuilding = true;
+                continue;
+            }
+            if (argument == "--determinism")
+            {
+                settings.isCheckingDeterminism = true;
+                continue;
+            }
+            if (argument.compare(0, 2, "--") != 0)
+            {
+                settings.scenes.push_back(argument);
+                continue;
+            }
+
+            if (i + 1 >= argc)
+            {
+                std::cerr << argument << " needs a value\n";
+                return false;
+            }
+            const char *text = argv[++i];
+            if (argument == "--references")     { settings.referenceDirectory = text; continue; }
+            if (argument == "--output")         { settings.outputPath = text; continue; }
+            if (argument == "--plot")           { settings.plotPath = text; continue; }
+            if (argument == "--configs")
+            {
+                std::stringstream names(text);
+                std::string name;
+                while (std::getline(names, name, ',')) { settings.configNames.push_back(name); }
+                continue;
+            }
+
+            double value;
+            if (!readNumber(text, value))
+            {
+                std::cerr << argument << " needs a number, not " << text << "\n";
+                return false;
+            }
+            if (argument == "--width")                  { settings.resolution.x = static_cast<int>(value); }
+            else if (argument == "--height")            { settings.resolution.y = static_cast<int>(value); }
+            else if (argument == "--frames")            { settings.frames = static_cast<int>(value); }
+            else if (argument == "--threads")           { settings.threadCount = static_cast<unsigned int>(value); }
+            else if (argument == "--reference-grid")    { settings.referenceGridSize = static_cast<int>(value); }
+            else
+            {
+                std::cerr << "Unknown option " << argument << "\n";
+                return false;
+            }
+        }
+
+        if (settings.resolution.x <= 0 || settings.resolution.y <= 0 || settings.frames <= 0)
+        {
+            std::cerr << "The resolution and frame count must be above 0\n";
+            return false;
+        }
+        if (settings.referenceGridSize < 2 || settings.referenceGridSize % 2 != 0)
+        {
+            std::cerr << "The reference grid must be even\n";
+            return false;
+        }
+
+        if (settings.scenes.empty())
+        {
+            for (int i = 0; i < lvl::NumberOfScenes; ++i)
+            {
+                settings.scenes.push_back("builtin:" + std::to_string(i));
+            }
+        }
+        return true;
+    }
+
+    /** @returns The name with anything that might not be allowed in a file name replaced. */
+    std::string toFileName(const std::string &name)
+    {
+        std::string fileName = name;
+        for (char &c : fileName)
+        {
+            if (!std::isalnum(static_cast<unsigned char>(c)) && c != '-' && c != '.') { c = '_'; }
+        }
+        return fileName;
+    }
+
+    std::string getDisplayName(const std::string &scene)
+    {
+        const std::string builtin = "builtin:";
+        if (scene.compare(0, builtin.size(), builtin) != 0) { return scene; }
+        const unsigned long index = std::strtoul(scene.c_str() + builtin.size(), nullptr, 10);
+        return index < lvl::NumberOfScenes ? builtinNames[index] : scene;
+    }
+
+    /**
+     * Renders frames of a scene from a new renderer, timing each one.
+     * @param seconds Set to the mean time of a frame.
+     * @returns The last frame, or an empty image if the scene couldn't be loaded.
+     */
+    image render(const std::string &scene, const glm::ivec2 &resolution, const renderConfig &config,
+                 unsigned int threadCount, int frames, double &seconds)
+    {
+        const glm::ivec2 size = glm::max(glm::ivec2(glm::vec2(resolution) * config.resolutionScale), glm::ivec2(1));
+        rendererOptions renderer = config.renderer;
+        renderer.threadCount = threadCount;
+        RenderCore renderCore(size, {}, config.options, renderer);
+        renderCore.setBounceLimit(config.bounceLimit);
+
+        const std::string builtin = "builtin:";
+        if (scene.compare(0, builtin.size(), builtin) == 0)
+        {
+            const unsigned int index = static_cast<unsigned int>(std::strtoul(scene.c_str() + builtin.size(), nullptr, 10));
+            if (!renderCore.loadSceneNow(index)) { return {}; }
+        }
+        else if (!renderCore.loadSceneNow(scene))
+        {
+            return {};
+        }
+
+        seconds = 0.0;
+        for (int frame = 0; frame < frames; ++frame)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            renderCore.renderFrame();
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        }
+        seconds /= frames;
+        return { size, renderCore.getImage() };
+    }
+
+    glm::vec3 unpack(std::uint32_t colour)
+    {
+        return glm::vec3((colour >> 16u) & 0xffu, (colour >> 8u) & 0xffu, colour & 0xffu);
+    }
+
+    std::uint32_t pack(const glm::vec3 &colour)
+    {
+        const glm::uvec3 channels(glm::clamp(colour + 0.5f, 0.f, 255.f));
+        return channels.r << 16u | channels.g << 8u | channels.b;
+    }
+
+    /** Bilinear, with pixel centres lined up between the two sizes. */
+    image resize(const image &source, const glm::ivec2 &size)
+    {
+        if (source.size == size) { return source; }
+
+        image resized { size, std::vector<std::uint32_t>(size.x * size.y) };
+        const glm::vec2 scale = glm::vec2(source.size) / glm::vec2(size);
+        for (int y = 0; y < size.y; ++y)
+        {
+            for (int x = 0; x < size.x; ++x)
+            {
+                const glm::vec2 position = glm::clamp((glm::vec2(x, y) + 0.5f) * scale - 0.5f, glm::vec2(0.f),
+                                                      glm::vec2(source.size - 1));
+                const glm::ivec2 low(position);
+                const glm::ivec2 high = glm::min(low + 1, source.size - 1);
+                const glm::vec2 t = position - glm::vec2(low);
+                auto at = [&source](int px, int py) { return unpack(source.pixels[py * source.size.x + px]); };
+                const glm::vec3 top = glm::mix(at(low.x, low.y), at(high.x, low.y), t.x);
+                const glm::vec3 bottom = glm::mix(at(low.x, high.y), at(high.x, high.y), t.x);
+                resized.pixels[y * size.x + x] = pack(glm::mix(top, bottom, t.y));
+            }
+        }
+        return resized;
+    }
+
+    bool writeImage(const std::string &path, const image &written)
+    {
+        std::ofstream file(path, std::ios::binary);
+        file << "P6\n" << written.size.x << " " << written.size.y << "\n255\n";
+        for (const std::uint32_t colour : written.pixels)
+        {
+            const char rgb[3] = { static_cast<char>(colour >> 16u), static_cast<char>(colour >> 8u), static_cast<char>(colour) };
+            file.write(rgb, 3);
+        }
+        return static_cast<bool>(file);
+    }
+
+    /** Reads the binary PPM images that writeImage() (and RenderCore::writeImage()) write. */
+    bool readImage(const std::string &path, image &read)
+    {
+        std::ifstream file(path, std::ios::binary);
+        std::string magic;
+        int maxValue;
+        file >> magic >> read.size.x >> read.size.y >> maxValue;
+        file.get();  // The single whitespace character before the pixels.
+        if (!file || magic != "P6" || maxValue != 255 || read.size.x <= 0 || read.size.y <= 0) { return false; }
+
+        std::vector<unsigned char> rgb(static_cast<std::size_t>(read.size.x * read.size.y) * 3);
+        file.read(reinterpret_cast<char*>(rgb.data()), static_cast<std::streamsize>(rgb.size()));
+        if (!file) { return false; }
+
+        read.pixels.resize(read.size.x * read.size.y);
+        for (std::size_t i = 0; i < read.pixels.size(); ++i)
+        {
+            read.pixels[i] = rgb[i * 3] << 16u | rgb[i * 3 + 1] << 8u | rgb[i * 3 + 2];
+        }
+        return true;
+    }
+
+    /** @returns Infinity if the images are identical. */
+    double measurePsnr(const image &a, const image &b)
+    {
+        double squaredError = 0.0;
+        for (std::size_t i = 0; i < a.pixels.size(); ++i)
+        {
+            const glm::dvec3 difference = glm::dvec3(unpack(a.pixels[i])) - glm::dvec3(unpack(b.pixels[i]));
+            squaredError += glm::dot(difference, difference);
+        }
+        const double meanSquaredError = squaredError / static_cast<double>(a.pixels.size() * 3);
+        if (meanSquaredError == 0.0) { return std::numeric_limits<double>::infinity(); }
+        return 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+    }
+
+    double measureSsim(const image &a, const image &b)
+    {
+        const int window = 8;
+        const int step = 4;
+        const double c1 = (0.01 * 255.0) * (0.01 * 255.0);
+        const double c2 = (0.03 * 255.0) * (0.03 * 255.0);
+        auto luma = [](std::uint32_t colour) { return glm::dot(glm::dvec3(unpack(colour)), glm::dvec3(0.299, 0.587, 0.114)); };
+
+        double total = 0.0;
+        int windows = 0;
+        for (int y = 0; y + window <= a.size.y; y += step)
+        {
+            for (int x = 0; x + window <= a.size.x; x += step)
+            {
+                double sumA = 0.0, sumB = 0.0, sumAA = 0.0, sumBB = 0.0, sumAB = 0.0;
+                for (int wy = y; wy < y + window; ++wy)
+                {
+                    for (int wx = x; wx < x + window; ++wx)
+                    {
+                        const double la = luma(a.pixels[wy * a.size.x + wx]);
+                        const double lb = luma(b.pixels[wy * a.size.x + wx]);
+                        sumA += la;
+                        sumB += lb;
+                        sumAA += la * la;
+                        sumBB += lb * lb;
+                        sumAB += la * lb;
+                    }
+                }
+                const double n = window * window;
+                const double meanA = sumA / n, meanB = sumB / n;
+                const double varianceA = sumAA / n - meanA * meanA;
+                const double varianceB = sumBB / n - meanB * meanB;
+                const double covariance = sumAB / n - meanA * meanB;
+                total += (2.0 * meanA * meanB + c1) * (2.0 * covariance + c2)
+                         / ((meanA * meanA + meanB * meanB + c1) * (varianceA + varianceB + c2));
+                ++windows;
+            }
+        }
+        return windows > 0 ? total / windows : 1.0;
+    }
+
+    /** sRGB to CIELAB under D65. */
+    glm::dvec3 toLab(std::uint32_t colour)
+    {
+        glm::dvec3 linear = glm::dvec3(unpack(colour)) / 255.0;
+        for (int i = 0; i < 3; ++i)
+        {
+            linear[i] = linear[i] <= 0.04045 ? linear[i] / 12.92 : std::pow((linear[i] + 0.055) / 1.055, 2.4);
+        }
+        const glm::dvec3 xyz(
+                (0.4124 * linear.r + 0.3576 * linear.g + 0.1805 * linear.b) / 0.95047,
+                (0.2126 * linear.r + 0.7152 * linear.g + 0.0722 * linear.b),
+                (0.0193 * linear.r + 0.1192 * linear.g + 0.9505 * linear.b) / 1.08883);
+        glm::dvec3 f;
+        for (int i = 0; i < 3; ++i)
+        {
+            f[i] = xyz[i] > 0.008856 ? std::cbrt(xyz[i]) : 7.787 * xyz[i] + 16.0 / 116.0;
+        }
+        return { 116.0 * f.y - 16.0, 500.0 * (f.x - f.y), 200.0 * (f.y - f.z) };
+    }
+
+    double measureMeanDeltaE(const image &a, const image &b)
+    {
+        double total = 0.0;
+        for (std::size_t i = 0; i < a.pixels.size(); ++i)
+        {
+            total += glm::length(toLab(a.pixels[i]) - toLab(b.pixels[i]));
+        }
+        return total / static_cast<double>(a.pixels.size());
+    }
+
+    /** Does nothing if the directory already exists. */
+    void makeDirectory(const std::string &path)
+    {
+#ifdef _WIN32
+        _mkdir(path.c_str());
+#else
+        mkdir(path.c_str(), 0755);
+#endif
+    }
+
+    /** @returns The reference for the scene, rendering it first if it isn't there or is out of date. */
+    bool getReference(const qualitySettings &settings, const std::string &scene, image &reference)
+    {
+        const std::string path = settings.referenceDirectory + "/" + toFileName(scene) + "-"
+                                 + std::to_string(settings.resolution.x) + "x" + std::to_string(settings.resolution.y)
+                                 + "-" + std::to_string(settings.frames) + "f-grid"
+                                 + std::to_string(settings.referenceGridSize) + ".ppm";
+        if (!settings.isRebuilding && readImage(path, reference) && reference.size == settings.resolution) { return true; }
+
+        // Every pixel gets the whole grid, however little it differs from its neighbours.
+        renderConfig config;
+        config.bounceLimit = 16;
+        config.renderer.antiAliasing.gridSize = settings.referenceGridSize;
+        config.renderer.antiAliasing.sampleBudget = static_cast<float>(settings.referenceGridSize * settings.referenceGridSize);
+        config.renderer.antiAliasing.contrastThreshold = -1.f;
+        config.renderer.antiAliasing.varianceThreshold = 0.f;
+
+        std::cerr << "Rendering the reference for " << getDisplayName(scene) << "\n";
+        double seconds;
+        reference = render(scene, settings.resolution, config, settings.threadCount, settings.frames, seconds);
+        if (reference.pixels.empty()) { return false; }
+        if (!writeImage(path, reference)) { std::cerr << "Could not save " << path << "\n"; }
+        return true;
+    }
+
+    /** Writes a number that JSON can hold, using null for infinity. */
+    std::string toJson(double value)
+    {
+        if (!std::isfinite(value)) { return "null"; }
+        std::ostringstream text;
+        text << value;
+        return text.str();
+    }
+
+    std::string escapeJson(const std::string &text)
+    {
+        std::string escaped;
+        for (const char c : text)
+        {
+            if (c == '"' || c == '\\')                      { escaped += '\\'; escaped += c; }
+            else if (static_cast<unsigned char>(c) < 0x20)  { escaped += ' '; }
+            else                                            { escaped += c; }
+        }
+        return escaped;
+    }
+
+    /** The means over every scene that succeeded. PSNR only counts the finite ones. */
+    struct configSummary
+    {
+        double frameSeconds;
+        double psnr;
+        double ssim;
+        double meanDeltaE;
+    };
+
+    configSummary summarise(const configResult &result)
+    {
+        configSummary summary { 0.0, 0.0, 0.0, 0.0 };
+        int count = 0;
+        int finitePsnrCount = 0;
+        for (const sceneResult &scene : result.scenes)
+        {
+            if (!scene.success) { continue; }
+            summary.frameSeconds += scene.frameSeconds;
+            summary.ssim += scene.ssim;
+            summary.meanDeltaE += scene.meanDeltaE;
+            if (std::isfinite(scene.psnr))
+            {
+                summary.psnr += scene.psnr;
+                ++finitePsnrCount;
+            }
+            ++count;
+        }
+        if (count > 0)
+        {
+            summary.frameSeconds /= count;
+            summary.ssim /= count;
+            summary.meanDeltaE /= count;
+        }
+        summary.psnr = finitePsnrCount > 0 ? summary.psnr / finitePsnrCount : std::numeric_limits<double>::infinity();
+        return summary;
+    }
+
+    void writeResults(std::ostream &out, const qualitySettings &settings, const std::vector<configResult> &results)
+    {
+        out << "{\n"
+            << "  \"settings\": {\n"
+            << "    \"width\": " << settings.resolution.x << ",\n"
+            << "    \"height\": " << settings.resolution.y << ",\n"
+            << "    \"frames\": " << settings.frames << ",\n"
+            << "    \"referenceGridSize\": " << settings.referenceGridSize << "\n"
+            << "  },\n"
+            << "  \"configs\": [";
+
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const configResult &result = results[i];
+            const configSummary summary = summarise(result);
+            out << (i == 0 ? "\n" : ",\n")
+                << "    {\n"
+                << "      \"name\": \"" << escapeJson(result.config->name) << "\",\n"
+                << "      \"description\": \"" << escapeJson(result.config->description) << "\",\n"
+                << "      \"exact\": " << (result.config->isExact ? "true" : "false") << ",\n"
+                << "      \"meanFrameMs\": " << summary.frameSeconds * 1000.0 << ",\n"
+                << "      \"meanPsnr\": " << toJson(summary.psnr) << ",\n"
+                << "      \"meanSsim\": " << summary.ssim << ",\n"
+                << "      \"meanDeltaE\": " << summary.meanDeltaE << ",\n"
+                << "      \"scenes\": [";
+
+            for (std::size_t j = 0; j < result.scenes.size(); ++j)
+            {
+                const sceneResult &scene = result.scenes[j];
+                out << (j == 0 ? "\n" : ",\n")
+                    << "        { \"name\": \"" << escapeJson(scene.name) << "\", \"success\": "
+                    << (scene.success ? "true" : "false");
+                if (scene.success)
+                {
+                    out << ", \"frameMs\": " << scene.frameSeconds * 1000.0
+                        << ", \"psnr\": " << toJson(scene.psnr)
+                        << ", \"ssim\": " << scene.ssim
+                        << ", \"meanDeltaE\": " << scene.meanDeltaE;
+                }
+                if (scene.isChecked) { out << ", \"deterministic\": " << (scene.isDeterministic ? "true" : "false"); }
+                out << " }";
+            }
+            out << "\n      ]\n    }";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    /** A scatter plot of the mean colour difference of each configuration against its mean frame time. */
+    void writePlot(std::ostream &out, const std::vector<configResult> &results)
+    {
+        const double width = 640.0, height = 480.0, margin = 60.0;
+        std::vector<configSummary> summaries;
+        double maxSeconds = 0.0, maxDeltaE = 0.0;
+        for (const configResult &result : results)
+        {
+            summaries.push_back(summarise(result));
+            maxSeconds = std::max(maxSeconds, summaries.back().frameSeconds);
+            maxDeltaE = std::max(maxDeltaE, summaries.back().meanDeltaE);
+        }
+        maxSeconds = maxSeconds > 0.0 ? maxSeconds * 1.1 : 1.0;
+        maxDeltaE = maxDeltaE > 0.0 ? maxDeltaE * 1.1 : 1.0;
+        auto toX = [&](double seconds) { return margin + seconds / maxSeconds * (width - 2.0 * margin); };
+        auto toY = [&](double deltaE) { return height - margin - deltaE / maxDeltaE * (height - 2.0 * margin); };
+
+        out << std::fixed << std::setprecision(1)
+            << "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" << width << "\" height=\"" << height
+            << "\" font-family=\"sans-serif\" font-size=\"12\">\n"
+            << "<rect width=\"100%\" height=\"100%\" fill=\"white\"/>\n"
+            << "<line x1=\"" << margin << "\" y1=\"" << height - margin << "\" x2=\"" << width - margin
+            << "\" y2=\"" << height - margin << "\" stroke=\"black\"/>\n"
+            << "<line x1=\"" << margin << "\" y1=\"" << margin << "\" x2=\"" << margin
+            << "\" y2=\"" << height - margin << "\" stroke=\"black\"/>\n"
+            << "<text x=\"" << width / 2.0 << "\" y=\"" << height - 20.0
+            << "\" text-anchor=\"middle\">Mean frame time (ms)</text>\n"
+            << "<text x=\"20\" y=\"" << height / 2.0 << "\" text-anchor=\"middle\" transform=\"rotate(-90 20 "
+            << height / 2.0 << ")\">Mean colour difference (CIE76)</text>\n"
+            << "<text x=\"" << margin << "\" y=\"" << height - margin + 16.0 << "\" text-anchor=\"middle\">0</text>\n"
+            << "<text x=\"" << width - margin << "\" y=\"" << height - margin + 16.0 << "\" text-anchor=\"middle\">"
+            << maxSeconds * 1000.0 << "</text>\n"
+            << "<text x=\"" << margin - 6.0 << "\" y=\"" << margin + 4.0 << "\" text-anchor=\"end\">"
+            << maxDeltaE << "</text>\n";
+
+        for (std::size_t i = 0; i < results.size(); ++i)
+        {
+            const double x = toX(summaries[i].frameSeconds);
+            const double y = toY(summaries[i].meanDeltaE);
+            out << "<circle cx=\"" << x << "\" cy=\"" << y << "\" r=\"4\" fill=\"steelblue\"/>\n"
+                << "<text x=\"" << x + 7.0 << "\" y=\"" << y - 7.0 << "\">" << results[i].config->name << "</text>\n";
+        }
+        out << "</svg>\n";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    qualitySettings settings;
+    if (!readSettings(argc, argv, settings)) { return 1; }
+
+    const std::vector<renderConfig> allConfigs = makeConfigs();
+    std::vector<const renderConfig*> configs;
+    for (const renderConfig &config : allConfigs)
+    {
+        if (settings.configNames.empty() || std::find(settings.configNames.begin(), settings.configNames.end(),
+                                                      config.name) != settings.configNames.end())
+        {
+            configs.push_back(&config);
+        }
+    }
+    if (configs.size() != (settings.configNames.empty() ? allConfigs.size() : settings.configNames.size()))
+    {
+        std::cerr << "Unknown configuration. The configurations are:\n";
+        for (const renderConfig &config : allConfigs) { std::cerr << "  " << config.name << ": " << config.description << "\n"; }
+        return 1;
+    }
+
+    std::cerr << "Kernels: " << kernels::describeSelection() << "\n";
+
+    const unsigned int hardwareThreads = glm::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned int> checkedThreadCounts = { 1 };
+    if (hardwareThreads >= 2) { checkedThreadCounts.push_back(2); }
+    if (hardwareThreads > 2)  { checkedThreadCounts.push_back(hardwareThreads); }
+
+    makeDirectory(settings.referenceDirectory);
+    std::vector<image> references;
+    for (const std::string &scene : settings.scenes)
+    {
+        references.emplace_back();
+        if (!getReference(settings, scene, references.back()))
+        {
+            std::cerr << "Could not render the reference for " << getDisplayName(scene) << "\n";
+        }
+    }
+
+    bool isDeterministic = true;
+    std::vector<configResult> results;
+    for (const renderConfig *config : configs)
+    {
+        configResult result { config, {} };
+        for (std::size_t i = 0; i < settings.scenes.size(); ++i)
+        {
+            const std::string &scene = settings.scenes[i];
+            sceneResult measured { getDisplayName(scene), false, 0.0, 0.0, 0.0, 0.0, false, false };
+            std::cerr << "Measuring " << config->name << " on " << measured.name << "\n";
+
+            const image rendered = render(scene, settings.resolution, *config, settings.threadCount,
+                                          settings.frames, measured.frameSeconds);
+            if (rendered.pixels.empty() || references[i].pixels.empty())
+            {
+                result.scenes.push_back(measured);
+                continue;
+            }
+
+            const image compared = resize(rendered, settings.resolution);
+            measured.success = true;
+            measured.psnr = measurePsnr(compared, references[i]);
+            measured.ssim = measureSsim(compared, references[i]);
+            measured.meanDeltaE = measureMeanDeltaE(compared, references[i]);
+
+            if (settings.isCheckingDeterminism && config->isExact)
+            {
+                measured.isChecked = true;
+                measured.isDeterministic = true;
+                for (const unsigned int threadCount : checkedThreadCounts)
+                {
+                    double seconds;
+                    const image again = render(scene, settings.resolution, *config, threadCount, settings.frames, seconds);
+                    if (again.pixels != rendered.pixels)
+                    {
+                        std::cerr << config->name << " on " << measured.name << " differs with " << threadCount
+                                  << " threads\n";
+                        measured.isDeterministic = false;
+                    }
+                }
+                isDeterministic = isDeterministic && measured.isDeterministic;
+            }
+            result.scenes.push_back(measured);
+        }
+        results.push_back(result);
+    }
+
+    if (!settings.plotPath.empty())
+    {
+        std::ofstream plot(settings.plotPath);
+        writePlot(plot, results);
+        if (!plot) { std::cerr << "Could not write " << settings.plotPath << "\n"; }
+    }
+
+    if (settings.outputPath.empty())
+    {
+        writeResults(std::cout, settings, results);
+    }
+    else
+    {
+        std::ofstream output(settings.outputPath);
+        writeResults(output, settings, results);
+        if (!output)
+        {
+            std::cerr << "Could not write " << settings.outputPath << "\n";
+            return 1;
+        }
+    }
+    return isDeterministic ? 0 : 1;
+}
@@ -0,0 +1,461 @@
+/**
+ * @file SceneCompiler.cpp
+ * @brief Compiles a text scene description into the binary format that the ray tracer maps into memory.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ *
+ * Usage: A2SceneCompiler <input.scene> <output.cscene>
+ *
+ * The text format has one statement per line. Anything after a '#' is a comment. Vectors are three
+ * numbers, rotations are euler angles in radians and materials must be declared before they're used.
+ * The first camera is the one the scene is rendered from.
+ *
+ *   material <name> <baseColour> <specular> <reflectivity> <shininess>
+ *   material <name> <baseColour> <ambient> <diffuse> <specular> <transmission> <reflectivity> <shininess>
+ *            [<refractiveIndex>]
+ *   camera <position> <rotation> <fovHalfAngle>
+ *   light directional <direction> <colour>
+ *   light point <position> <colour> <fallOff>
+ *   sphere <position> <radius> <material>
+ *   tri <position> <rotation> <scale> <material> <v0> <v1> <v2> [<material0> <material1> <material2>]
+ *   mesh <name>
+ *       v <position>
+ *       f <index> <index> <index> [<index>...]
+ *   end
+ *   import <name> <path>
+ *   instance <name> <position> <rotation> <scale> <material> [override]
+ *
+ * Meshes and imports only declare an asset, nothing is placed in the scene until an instance of it is.
+ * Face indices start at 1 from the first vertex of the mesh, the same as OBJ files. Faces with more than
+ * three vertices are split into a fan of triangles. Imported .obj and binary .ply files are read when the scene is
+ * loaded, relative paths start from the compiled scene file. The material of an instance is used for faces that
+ * the file doesn't give a material, or for every face with 'override'.
+ */
+
+
+#include "SceneFormat.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /** Everything that is written to the compiled scene file. */
+    struct compiledScene
+    {
+        std::map<std::string, std::uint32_t>    materialNames;
+        std::vector<sceneFile::material>        materials;
+        std::vector<sceneFile::camera>          cameras;
+        std::vector<sceneFile::light>           lights;
+        std::vector<sceneFile::sphere>          spheres;
+        std::vector<sceneFile::tri>             tris;
+        std::vector<sceneFile::mesh>            meshes;
+        std::vector<sceneFile::vertexPosition>  vertices;
+        std::vector<std::uint32_t>              indices;
+        std::vector<sceneFile::meshFile>        meshFiles;
+        std::vector<char>                       strings;
+        std::vector<sceneFile::instance>        instances;
+
+        /** The section index of each mesh asset along with whether it's in the mesh file section. */
+        std::map<std::string, std::pair<std::uint32_t, bool>> assetNames;
+    };
+
+    /** Thrown with a message that describes what's wrong with the current line. */
+    struct compileError
+    {
+        std::string message;
+    };
+
+    float readFloat(std::istream &line, const char *what)
+    {
+        float value;
+        if (!(line >> value)) { throw compileError { std::string("expected a number for the ") + what }; }
+        return value;
+    }
+
+    void readVec3(std::istream &line, float (&values)[3], const char *what)
+    {
+        for (float &value : values)
+        {
+            value = readFloat(line, what);
+        }
+    }
+
+    std::string readWord(std::istream &line, const char *what)
+    {
+        std::string word;
+        if (!(line >> word)) { throw compileError { std::string("expected a ") + what }; }
+        return word;
+    }
+
+    std::uint32_t readMaterial(std::istream &line, const compiledScene &scene)
+    {
+        const std::string name = readWord(line, "material name");
+        const auto material = scene.materialNames.find(name);
+        if (material == scene.materialNames.end()) { throw compileError { "unknown material '" + name + "'" }; }
+        return material->second;
+    }
+
+    void expectEnd(std::istream &line)
+    {
+        std::string extra;
+        if (line >> extra) { throw compileError { "unexpected '" + extra + "'" }; }
+    }
+
+    void compileMaterial(std::istream &line, compiledScene &scene)
+    {
+        const std::string name = readWord(line, "material name");
+        if (scene.materialNames.count(name) != 0) { throw compileError { "material '" + name + "' already exists" }; }
+
+        std::vector<float> values;
+        float value;
+        while (line >> value)
+        {
+            values.push_back(value);
+        }
+        if (!line.eof()) { throw compileError { "expected a number for the material" }; }
+
+        sceneFile::material material {};
+        if (values.size() == 10)
+        {
+            // The same as the short actorLightingMaterial constructor.
+            for (int i = 0; i < 3; ++i)
+            {
+                material.baseColour[i] = values[i];
+                material.ambientIntensity[i] = values[i] * 0.05f;
+                material.diffuseIntensity[i] = values[i];
+                material.specularIntensity[i] = values[3 + i];
+                material.transmissionIntensity[i] = 0.f;
+                material.reflectivityIntensity[i] = values[6 + i];
+            }
+            material.shininessConstant = values[9];
+            material.refractiveIndex = 1.5f;
+        }
+        else if (values.size() == 19 || values.size() == 20)
+        {
+            float *fields[] = { material.baseColour, material.ambientIntensity, material.diffuseIntensity,
+                                material.specularIntensity, material.transmissionIntensity,
+                                material.reflectivityIntensity };
+            for (int field = 0; field < 6; ++field)
+            {
+                std::memcpy(fields[field], &values[field * 3], sizeof(float) * 3);
+            }
+            material.shininessConstant = values[18];
+            material.refractiveIndex = values.size() == 20 ? values[19] : 1.5f;
+        }
+        else
+        {
+            throw compileError { "materials take either 10, 19 or 20 numbers" };
+        }
+
+        scene.materialNames[name] = static_cast<std::uint32_t>(scene.materials.size());
+        scene.materials.push_back(material);
+    }
+
+    void compileCamera(std::istream &line, compiledScene &scene)
+    {
+        sceneFile::camera camera {};
+        readVec3(line, camera.position, "camera position");
+        readVec3(line, camera.rotation, "camera rotation");
+        camera.fovHalfAngle = readFloat(line, "camera field of view");
+        expectEnd(line);
+        scene.cameras.push_back(camera);
+    }
+
+    void compileLight(std::istream &line, compiledScene &scene)
+    {
+        const std::string type = readWord(line, "light type");
+        sceneFile::light light {};
+        if (type == "directional")
+        {
+            light.type = sceneFile::Directional;
+            readVec3(line, light.position, "light direction");
+            readVec3(line, light.colour, "light colour");
+        }
+        else if (type == "point")
+        {
+            light.type = sceneFile::Point;
+            readVec3(line, light.position, "light position");
+            readVec3(line, light.colour, "light colour");
+            light.fallOff = readFloat(line, "light fall off");
+        }
+        else
+        {
+            throw compileError { "unknown light type '" + type + "'" };
+        }
+        expectEnd(line);
+        scene.lights.push_back(light);
+    }
+
+    void compileSphere(std::istream &line, compiledScene &scene)
+    {
+        sceneFile::sphere sphere {};
+        readVec3(line, sphere.position, "sphere position");
+        sphere.radius = readFloat(line, "sphere radius");
+        sphere.material = readMaterial(line, scene);
+        expectEnd(line);
+        scene.spheres.push_back(sphere);
+    }
+
+    void compileTri(std::istream &line, compiledScene &scene)
+    {
+        sceneFile::tri tri {};
+        readVec3(line, tri.position, "tri position");
+        readVec3(line, tri.rotation, "tri rotation");
+        readVec3(line, tri.scale, "tri scale");
+        tri.material = readMaterial(line, scene);
+        for (auto &vertex : tri.vertices)
+        {
+            readVec3(line, vertex, "tri vertex");
+        }
+
+        std::string name;
+        if (line >> name)
+        {
+            std::istringstream names(name);
+            tri.vertexMaterials[0] = readMaterial(names, scene);
+            tri.vertexMaterials[1] = readMaterial(line, scene);
+            tri.vertexMaterials[2] = readMaterial(line, scene);
+            expectEnd(line);
+        }
+        else
+        {
+            for (auto &vertexMaterial : tri.vertexMaterials)
+            {
+                vertexMaterial = sceneFile::noMaterial;
+            }
+        }
+        scene.tris.push_back(tri);
+    }
+
+    void addAssetName(const std::string &name, std::uint32_t index, bool isImported, compiledScene &scene)
+    {
+        if (scene.assetNames.count(name) != 0) { throw compileError { "mesh '" + name + "' already exists" }; }
+        scene.assetNames[name] = { index, isImported };
+    }
+
+    void compileMeshHeader(std::istream &line, compiledScene &scene)
+    {
+        const std::string name = readWord(line, "mesh name");
+        expectEnd(line);
+        addAssetName(name, static_cast<std::uint32_t>(scene.meshes.size()), false, scene);
+
+        sceneFile::mesh mesh {};
+
+        mesh.firstVertex = static_cast<std::uint32_t>(scene.vertices.size());
+        mesh.firstIndex = static_cast<std::uint32_t>(scene.indices.size());
+        scene.meshes.push_back(mesh);
+    }
+
+    void compileMeshVertex(std::istream &line, compiledScene &scene)
+    {
+        float position[3];
+        readVec3(line, position, "vertex position");
+        expectEnd(line);
+        scene.vertices.push_back({ position[0], position[1], position[2] });
+        ++scene.meshes.back().vertexCount;
+    }
+
+    void compileMeshFace(std::istream &line, compiledScene &scene)
+    {
+        sceneFile::mesh &mesh = scene.meshes.back();
+        std::vector<std::uint32_t> face;
+        long long index;
+        while (line >> index)
+        {
+            if (index < 1 || index > mesh.vertexCount)
+            {
+                throw compileError { "face index " + std::to_string(index) + " is out of range" };
+            }
+            face.push_back(static_cast<std::uint32_t>(index - 1));
+        }
+        if (!line.eof()) { throw compileError { "expected a vertex index" }; }
+        if (face.size() < 3) { throw compileError { "faces need at least three vertices" }; }
+
+        for (std::size_t i = 1; i + 1 < face.size(); ++i)
+        {
+            scene.indices.push_back(face[0]);
+            scene.indices.push_back(face[i]);
+            scene.indices.push_back(face[i + 1]);
+            ++mesh.triangleCount;
+        }
+    }
+
+    void compileImport(std::istream &line, compiledScene &scene)
+    {
+        const std::string name = readWord(line, "mesh name");
+        const std::string path = readWord(line, "mesh file path");
+        expectEnd(line);
+        addAssetName(name, static_cast<std::uint32_t>(scene.meshFiles.size()), true, scene);
+
+        sceneFile::meshFile meshFile {};
+        meshFile.pathOffset = static_cast<std::uint32_t>(scene.strings.size());
+        meshFile.pathLength = static_cast<std::uint32_t>(path.size());
+        scene.strings.insert(scene.strings.end(), path.begin(), path.end());
+        scene.meshFiles.push_back(meshFile);
+    }
+
+    void compileInstance(std::istream &line, compiledScene &scene)
+    {
+        const std::string name = readWord(line, "mesh name");
+        const auto asset = scene.assetNames.find(name);
+        if (asset == scene.assetNames.end()) { throw compileError { "unknown mesh '" + name + "'" }; }
+
+        sceneFile::instance instance {};
+        instance.asset = asset->second.first;
+        instance.flags = asset->second.second ? sceneFile::Imported : 0;
+        readVec3(line, instance.position, "instance position");
+        readVec3(line, instance.rotation, "instance rotation");
+        readVec3(line, instance.scale, "instance scale");
+        instance.material = readMaterial(line, scene);
+
+        std::string option;
+        if (line >> option)
+        {
+            if (option != "override") { throw compileError { "unexpected '" + option + "'" }; }
+            instance.flags |= sceneFile::OverrideMaterials;
+            expectEnd(line);
+        }
+        scene.instances.push_back(instance);
+    }
+
+    /** @returns False and prints what went wrong if the file can't be compiled. */
+    bool compile(std::istream &input, const std::string &inputName, compiledScene &scene)
+    {
+        bool isInMesh = false;
+        std::string text;
+        for (int lineNumber = 1; std::getline(input, text); ++lineNumber)
+        {
+            const std::size_t comment = text.find('#');
+            if (comment != std::string::npos) { text.erase(comment); }
+
+            std::istringstream line(text);
+            std::string statement;
+            if (!(line >> statement)) { continue; }  // Blank line.
+
+            try
+            {
+                if (isInMesh)
+                {
+                    if      (statement == "v")      { compileMeshVertex(line, scene); }
+                    else if (statement == "f")      { compileMeshFace(line, scene); }
+                    else if (statement == "end")    { expectEnd(line); isInMesh = false; }
+                    else    { throw compileError { "expected 'v', 'f' or 'end' inside a mesh" }; }
+                    continue;
+                }
+
+                if      (statement == "material")   { compileMaterial(line, scene); }
+                else if (statement == "camera")     { compileCamera(line, scene); }
+                else if (statement == "light")      { compileLight(line, scene); }
+                else if (statement == "sphere")     { compileSphere(line, scene); }
+                else if (statement == "tri")        { compileTri(line, scene); }
+                else if (statement == "mesh")       { compileMeshHeader(line, scene); isInMesh = true; }
+                else if (statement == "import")     { compileImport(line, scene); }
+                else if (statement == "instance")   { compileInstance(line, scene); }
+                else    { throw compileError { "unknown statement '" + statement + "'" }; }
+            }
+            catch (const compileError &error)
+            {
+                std::cerr << inputName << ":" << lineNumber << ": " << error.message << "\n";
+                return false;
+            }
+        }
+
+        if (isInMesh)
+        {
+            std::cerr << inputName << ": the last mesh is missing an 'end'\n";
+            return false;
+        }
+        if (scene.cameras.empty())
+        {
+            std::cerr << inputName << ": a scene needs at least one camera\n";
+            return false;
+        }
+        return true;
+    }
+
+    template<typename T>
+    void writeSection(std::ostream &output, const std::vector<T> &records, sceneFile::section &section)
+    {
+        // Pad up to the start of the section.
+        const std::uint64_t position = static_cast<std::uint64_t>(output.tellp());
+        const std::uint64_t offset = (position + sceneFile::sectionAlignment - 1)
+                                     / sceneFile::sectionAlignment * sceneFile::sectionAlignment;
+        const char padding[sceneFile::sectionAlignment] {};
+        output.write(padding, static_cast<std::streamsize>(offset - position));
+
+        section.offset = offset;
+        section.count = records.size();
+        if (!records.empty())
+        {
+            output.write(reinterpret_cast<const char*>(records.data()),
+                         static_cast<std::streamsize>(records.size() * sizeof(T)));
+        }
+    }
+
+    bool write(std::ostream &output, const compiledScene &scene)
+    {
+        sceneFile::header header {};
+        std::memcpy(header.magic, sceneFile::magic, sizeof(header.magic));
+        header.version = sceneFile::version;
+        header.mainCamera = 0;
+
+        // The header is written again once the offsets are known.
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        writeSection(output, scene.materials, header.sections[sceneFile::Materials]);
+        writeSection(output, scene.cameras, header.sections[sceneFile::Cameras]);
+        writeSection(output, scene.lights, header.sections[sceneFile::Lights]);
+        writeSection(output, scene.spheres, header.sections[sceneFile::Spheres]);
+        writeSection(output, scene.tris, header.sections[sceneFile::Tris]);
+        writeSection(output, scene.meshes, header.sections[sceneFile::Meshes]);
+        writeSection(output, scene.vertices, header.sections[sceneFile::Vertices]);
+        writeSection(output, scene.indices, header.sections[sceneFile::Indices]);
+        writeSection(output, scene.meshFiles, header.sections[sceneFile::MeshFiles]);
+        writeSection(output, scene.strings, header.sections[sceneFile::Strings]);
+        writeSection(output, scene.instances, header.sections[sceneFile::Instances]);
+
+        output.seekp(0);
+        output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        return static_cast<bool>(output);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input.scene> <output.cscene>\n";
+        return 1;
+    }
+
+    std::ifstream input(argv[1]);
+    if (!input)
+    {
+        std::cerr << "Could not open " << argv[1] << "\n";
+        return 1;
+    }
+
+    compiledScene scene;
+    if (!compile(input, argv[1], scene)) { return 1; }
+
+    std::ofstream output(argv[2], std::ios::binary);
+    if (!output || !write(output, scene))
+    {
+        std::cerr << "Could not write " << argv[2] << "\n";
+        return 1;
+    }
+
+    std::cout << argv[2] << ": " << scene.materials.size() << " materials, " << scene.cameras.size()
+              << " cameras, " << scene.lights.size() << " lights, " << scene.spheres.size() << " spheres, "
+              << scene.tris.size() << " tris, " << scene.meshes.size() << " meshes ("
+              << scene.indices.size() / 3 << " triangles), " << scene.meshFiles.size() << " imported meshes, "
+              << scene.instances.size() << " mesh instances\n";
+    return 0;
+}
@@ -9,6 +9,15 @@
 
 
 #include "SceneGenerator.h"
+#include "SceneFormat.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
 
 namespace scenes
 {
@@ -22,17 +31,17 @@ namespace scenes
         scene level { true };
 
         // Create the main camera
-        level.mainCamera = new Camera({ 0.f, 1.5f, 6.f },
-                                      { 0.f, 0.f, 0.f },
-                                      { 1.f, 1.f, 1.f },
-                                      screenSize,
-                                      22.5
+        level.mainCamera = level.arena.make<Camera>(glm::vec3(0.f, 1.5f, 6.f),
+                                                    glm::vec3(0.f, 0.f, 0.f),
+                                                    glm::vec3(1.f, 1.f, 1.f),
+                                                    screenSize,
+                                                    22.5
                                       );
         level.cameras.push_back(level.mainCamera);
         level.entities.push_back(level.mainCamera);
 
         // Lighting
-        auto *light = new LightSource(glm::vec3(1.f, 1.f, 1.f),glm::vec3(1));
+        auto *light = level.arena.make<LightSource>(glm::vec3(1.f, 1.f, 1.f),glm::vec3(1));
         level.lights.push_back(light);
         level.entities.push_back(light);
 
@@ -42,9 +51,9 @@ namespace scenes
                                       glm::vec3(0.8f),
                                       50.f);
 
-        auto *ball = new Sphere({ 0.f, 1.f, 0.f },
-                                 metallic,
-                                 1.f);
+        auto *ball = level.arena.make<Sphere>(glm::vec3(0.f, 1.f, 0.f),
+                                              metallic,
+                                              1.f);
         level.actors.push_back(ball);
         level.entities.push_back(ball);
 
@@ -59,11 +68,11 @@ namespace scenes
                 vertex({ 0.f, 0.f, 1.f }),
                 vertex({ 1.f, 0.f, 0.f })
         };
-        auto *floor1 = new Tri(glm::vec3(-20.f, 0.f, -20.f),
-                               glm::vec3(0.f),
-                               { 40.f, 1.f, 40.f },
-                               white,
-                               vert);
+        auto *floor1 = level.arena.make<Tri>(glm::vec3(-20.f, 0.f, -20.f),
+                                             glm::vec3(0.f),
+                                             glm::vec3(40.f, 1.f, 40.f),
+                                             white,
+                                             vert);
         level.actors.push_back(floor1);
         level.entities.push_back(floor1);
 
@@ -72,11 +81,11 @@ namespace scenes
                 vertex({ 1.f, 0.f, 0.f }),
                 vertex({ 0.f, 0.f, 1.f }),
         };
-        auto *floor2 = new Tri({ -20.f, 0.f, -20.f },
-                               { 0.f, 0.f, 0.f },
-                               { 40.f, 1.f, 40.f },
-                               white,
-                               vert2);
+        auto *floor2 = level.arena.make<Tri>(glm::vec3(-20.f, 0.f, -20.f),
+                                             glm::vec3(0.f, 0.f, 0.f),
+                                             glm::vec3(40.f, 1.f, 40.f),
+                                             white,
+                                             vert2);
         level.actors.push_back(floor2);
         level.entities.push_back(floor2);
 
@@ -93,17 +102,17 @@ namespace scenes
     {
         scene level { true };
         // Create the main camera
-        level.mainCamera = new Camera({ 2.f, 1.f, 2.f },
-                                      { -0.05f, 0.79f, 0.f },
-                                      { 1.f, 1.f, 1.f },
-                                      screenSize,
-                                      22.5
+        level.mainCamera = level.arena.make<Camera>(glm::vec3(2.f, 1.f, 2.f),
+                                                    glm::vec3(-0.05f, 0.79f, 0.f),
+                                                    glm::vec3(1.f, 1.f, 1.f),
+                                                    screenSize,
+                                                    22.5
         );
         level.cameras.push_back(level.mainCamera);
         level.entities.push_back(level.mainCamera);
 
         // Lighting
-        auto *light = new LightSource(glm::vec3(1.f, 1.f, 1.f), glm::vec3(1));
+        auto *light = level.arena.make<LightSource>(glm::vec3(1.f, 1.f, 1.f), glm::vec3(1));
         level.lights.push_back(light);
         level.entities.push_back(light);
 
@@ -128,11 +137,11 @@ namespace scenes
                 vertex({ 0.5f, -0.289f, 0.f }, blue)
         };
 
-        auto *triangle = new Tri( { 0.f, 0.3f, 0.f },
-                                  glm::vec3(0.f),
-                                  glm::vec3(1.f),
-                                  red,
-                                  verts, true);
+        auto *triangle = level.arena.make<Tri>( glm::vec3(0.f, 0.3f, 0.f),
+                                                glm::vec3(0.f),
+                                                glm::vec3(1.f),
+                                                red,
+                                                verts, true);
         level.actors.push_back(triangle);
         level.entities.push_back(triangle);
 
@@ -147,11 +156,11 @@ namespace scenes
                 vertex({ 0.f, 0.f, 1.f }),
                 vertex({ 1.f, 0.f, 0.f })
         };
-        auto *floor1 = new Tri(glm::vec3(-5.f, 0.f, -20.f),
-                               glm::vec3(0.f),
-                               { 10.f, 1.f, 40.f },
-                               white,
-                               vert);
+        auto *floor1 = level.arena.make<Tri>(glm::vec3(-5.f, 0.f, -20.f),
+                                             glm::vec3(0.f),
+                                             glm::vec3(10.f, 1.f, 40.f),
+                                             white,
+                                             vert);
         level.actors.push_back(floor1);
         level.entities.push_back(floor1);
 
@@ -160,11 +169,11 @@ namespace scenes
                 vertex({ 1.f, 0.f, 0.f }),
                 vertex({ 0.f, 0.f, 1.f }),
         };
-        auto *floor2 = new Tri({ -5.f, 0.f, -20.f },
-                               { 0.f, 0.f, 0.f },
-                               { 10.f, 1.f, 40.f },
-                               white,
-                               vert2);
+        auto *floor2 = level.arena.make<Tri>(glm::vec3(-5.f, 0.f, -20.f),
+                                             glm::vec3(0.f, 0.f, 0.f),
+                                             glm::vec3(10.f, 1.f, 40.f),
+                                             white,
+                                             vert2);
         level.actors.push_back(floor2);
         level.entities.push_back(floor2);
 
@@ -182,18 +191,18 @@ namespace scenes
         scene level { true };
 
         // Create the main camera
-        level.mainCamera = new Camera({ 4.5f, -1.5f, 4.5f },
-                                      { -0.3f, 0.785f, 0.f },
-                                      { 1.f, 1.f, 1.f },
-                                      screenSize,
-                                      22.5
+        level.mainCamera = level.arena.make<Camera>(glm::vec3(4.5f, -1.5f, 4.5f),
+                                                    glm::vec3(-0.3f, 0.785f, 0.f),
+                                                    glm::vec3(1.f, 1.f, 1.f),
+                                                    screenSize,
+                                                    22.5
         );
         level.cameras.push_back(level.mainCamera);
         level.entities.push_back(level.mainCamera);
 
-        auto *pointLight = new LightSource({0.f, 4.5f, 0.f},
-                                           { 0.961f, 0.933f, 0.725f },
-                                          75);
+        auto *pointLight = level.arena.make<LightSource>(glm::vec3(0.f, 4.5f, 0.f),
+                                                         glm::vec3(0.961f, 0.933f, 0.725f),
+                                                         75);
         level.lights.push_back(pointLight);
         level.entities.push_back(pointLight);
 
@@ -203,7 +212,7 @@ namespace scenes
                                     glm::vec3(0.1f),
                                     64.f);
 
-        auto *centerBall = new Sphere({0.f, -4.f, 0.f}, white, 1.f);
+        auto *centerBall = level.arena.make<Sphere>(glm::vec3(0.f, -4.f, 0.f), white, 1.f);
         level.actors.push_back(centerBall);
         level.entities.push_back(centerBall);
 
@@ -217,123 +226,35 @@ namespace scenes
                                    glm::vec3(0.f),
                                    64.f);
 
-        // Flooring
-        vertex cube[8] = {
-                vertex({ -1.f, 1.f, -1.f }),    // Top-back-left [0]
-                vertex({ -1.f, 1.f, 1.f }),     // Top-front-left [1]
-                vertex({ 1.f, 1.f, 1.f }),      // Top-front-right [2]
-                vertex({ 1.f, 1.f, -1.f }),     // Top-back-right [3]
-
-                vertex({ -1.f, -1.f, -1.f }),   // Bottom-back-left [4]
-                vertex({ -1.f, -1.f, 1.f }),    // Bottom-front-left [5]
-                vertex({ 1.f, -1.f, 1.f }),     // Bottom-front-right [6]
-                vertex({ 1.f, -1.f, -1.f })     // Bottom-back-right [7]
-        };
-
-        glm::vec3 cubeScale(5.f);
-
-        // Bottom Side
-        vertex a[3] = { cube[7], cube[4], cube[5] };
-        auto *floorLeft = new Tri(glm::vec3(0.f),
-                                  glm::vec3(0.f),
-                                  cubeScale,
-                                  grey, a);
-        level.actors.push_back(floorLeft);
-        level.entities.push_back(floorLeft);
-
-        vertex b[3] = { cube[5], cube[6], cube[7] };
-        auto *floorRight = new Tri(glm::vec3(0.f),
-                                   glm::vec3(0.f),
-                                   cubeScale,
-                                   grey, b);
-        level.actors.push_back(floorRight);
-        level.entities.push_back(floorRight);
-
-        // Left Side
-        vertex c[3] = { cube[4], cube[0], cube[5] };
-        auto *leftBottom = new Tri(glm::vec3(0.f),
-                                   glm::vec3(0.f),
-                                   cubeScale,
-                                   metallic, c);
-        level.actors.push_back(leftBottom);
-        level.entities.push_back(leftBottom);
-
-        vertex d[3] = { cube[0], cube[1], cube[5] };
-        auto *leftTop = new Tri(glm::vec3(0.f),
-                                glm::vec3(0.f),
-                                cubeScale,
-                                metallic, d);
-        level.actors.push_back(leftTop);
-        level.entities.push_back(leftTop);
-
-        // Front Side
-        vertex e[3] = { cube[5], cube[2], cube[6] };
-        auto *frontBottom = new Tri(glm::vec3(0.f),
-                                glm::vec3(0.f),
-                                    cubeScale,
-                                    metallic, e);
-        level.actors.push_back(frontBottom);
-        level.entities.push_back(frontBottom);
-
-        vertex f[3] = { cube[1], cube[2], cube[6] };
-        auto *frontTop = new Tri(glm::vec3(0.f),
-                                glm::vec3(0.f),
-                                 cubeScale,
-                                 metallic, f);
-        level.actors.push_back(frontTop);
-        level.entities.push_back(frontTop);
-
-        // Back side
-        vertex g[3] = { cube[4], cube[3], cube[7] };
-        auto *backBottom = new Tri(glm::vec3(0.f),
-                                glm::vec3(0.f),
-                                   cubeScale,
-                                   metallic, g);
-        level.actors.push_back(backBottom);
-        level.entities.push_back(backBottom);
-
-        vertex h[3] = { cube[0], cube[3], cube[7] };
-        auto *backTop = new Tri(glm::vec3(0.f),
-                                   glm::vec3(0.f),
-                                cubeScale,
-                                metallic, h);
-        level.actors.push_back(backTop);
-        level.entities.push_back(backTop);
-
-        // Right side
-        vertex i[3] = { cube[2], cube[6], cube[7] };
-        auto *rightBottom = new Tri(glm::vec3(0.f),
-                                    glm::vec3(0.f),
-                                    cubeScale,
-                                    metallic, i);
-        level.actors.push_back(rightBottom);
-        level.entities.push_back(rightBottom);
-
-        vertex j[3] = { cube[3], cube[6], cube[7] };
-        auto *rightTop = new Tri(glm::vec3(0.f),
-                                    glm::vec3(0.f),
-                                 cubeScale,
-                                 metallic, j);
-        level.actors.push_back(rightTop);
-        level.entities.push_back(rightTop);
-
-        // Top side
-        vertex k[3] = { cube[1], cube[2], cube[3] };
-        auto *topRight = new Tri(glm::vec3(0.f),
-                                 glm::vec3(0.f),
-                                 cubeScale,
-                                 metallic, k);
-        level.actors.push_back(topRight);
-        level.entities.push_back(topRight);
-
-        vertex l[3] = { cube[0], cube[1], cube[3] };
-        auto *topLeft = new Tri(glm::vec3(0.f),
-                                glm::vec3(0.f),
-                                cubeScale,
-                                metallic, l);
-        level.actors.push_back(topLeft);
-        level.entities.push_back(topLeft);
+        // Every side of the room is an instance of the same quad, which lies flat in the XZ plane.
+        level.meshes.positions = { glm::vec3(-1.f, 0.f, -1.f), glm::vec3(-1.f, 0.f, 1.f),
+                                   glm::vec3(1.f, 0.f, 1.f), glm::vec3(1.f, 0.f, -1.f) };
+        level.meshes.indices = { 0, 1, 2, 2, 3, 0 };
+        const meshView quadView { level.meshes.positions.data(), 4, level.meshes.indices.data(), 2, nullptr };
+        auto *quad = level.arena.make<MeshAsset>(quadView);
+        level.meshAssets.push_back(quad);
 
+        struct side
+        {
+            glm::vec3                   position;
+            glm::vec3                   rotation;
+            const actorLightingMaterial &material;
+        };
+        const float quarterTurn = glm::half_pi<float>();
+        const side sides[] = {
+                { glm::vec3(0.f, -5.f, 0.f), glm::vec3(0.f),                     grey },      // Floor
+                { glm::vec3(0.f, 5.f, 0.f),  glm::vec3(0.f),                     metallic },  // Top
+                { glm::vec3(-5.f, 0.f, 0.f), glm::vec3(0.f, 0.f, quarterTurn),   metallic },  // Left
+                { glm::vec3(5.f, 0.f, 0.f),  glm::vec3(0.f, 0.f, quarterTurn),   metallic },  // Right
+                { glm::vec3(0.f, 0.f, 5.f),  glm::vec3(quarterTurn, 0.f, 0.f),   metallic },  // Front
+                { glm::vec3(0.f, 0.f, -5.f), glm::vec3(quarterTurn, 0.f, 0.f),   metallic }   // Back
+        };
+        for (const side &wall : sides)
+        {
+            auto *mesh = level.arena.make<Mesh>(wall.position, wall.rotation, glm::vec3(5.f), wall.material, *quad);
+            level.actors.push_back(mesh);
+            level.entities.push_back(mesh);
+        }
 
         return level;
     }
@@ -343,25 +264,25 @@ namespace scenes
         scene level { true };
 
         // Create the main camera
-        level.mainCamera = new Camera({ 0.f, 0.f, 6.f },
-                                      { 0.f, 0.f, 0.f },
-                                      { 1.f, 1.f, 1.f },
-                                      screenSize,
-                                      22.5
+        level.mainCamera = level.arena.make<Camera>(glm::vec3(0.f, 0.f, 6.f),
+                                                    glm::vec3(0.f, 0.f, 0.f),
+                                                    glm::vec3(1.f, 1.f, 1.f),
+                                                    screenSize,
+                                                    22.5
         );
         level.cameras.push_back(level.mainCamera);
         level.entities.push_back(level.mainCamera);
 
         // Lighting
-//        auto *light = new LightSource(glm::vec3(1.f, 1.f, 1.f),glm::vec3(1));
+//        auto *light = level.arena.make<LightSource>(glm::vec3(1.f, 1.f, 1.f),glm::vec3(1));
 //        level.lights.push_back(light);
 //        level.entities.push_back(light);
 
-        auto *light1 = new LightSource(glm::vec3(3.5f, 0.f, 3.f), glm::vec3(1.f, 0.f, 0.f), 32);
+        auto *light1 = level.arena.make<LightSource>(glm::vec3(3.5f, 0.f, 3.f), glm::vec3(1.f, 0.f, 0.f), 32);
         level.lights.push_back(light1);
         level.entities.push_back(light1);
 
-        auto *light2 = new LightSource(glm::vec3(-3.5f, 0.f, 3.f), glm::vec3(0.f, 0.f, 1.f), 32);
+        auto *light2 = level.arena.make<LightSource>(glm::vec3(-3.5f, 0.f, 3.f), glm::vec3(0.f, 0.f, 1.f), 32);
         level.lights.push_back(light2);
         level.entities.push_back(light2);
 
@@ -371,29 +292,866 @@ namespace scenes
                                        glm::vec3(0.f),
                                        50.f);
 
-        auto *ball = new Sphere({ 0.f, 0.f, 0.f },
-                                material,
-                                2.f);
+        auto *ball = level.arena.make<Sphere>(glm::vec3(0.f, 0.f, 0.f),
+                                              material,
+                                              2.f);
+        level.actors.push_back(ball);
+        level.entities.push_back(ball);
+
+        return level;
+    }
+}
+
+namespace stress
+{
+    /**
+     * @returns The largest value that a key of a stress description can have, so that every scene fits in memory
+     * and the indices of its meshes in 32 bits. Negative for keys that don't exist.
+     */
+    double getLimit(const std::string &key, lvl::stressSceneName name)
+    {
+        if (key == "count")     { return name == lvl::TriangleGrid ? 4096.0 : 1000000.0; }  // 33.5 million triangles.
+        if (key == "depth")     { return 64.0; }
+        if (key == "dynamic")   { return 1.0; }
+        if (key == "seed")      { return static_cast<double>(std::numeric_limits<std::uint32_t>::max()); }
+        if (key == "views")     { return 64.0; }
+        return -1.0;
+    }
+
+    /**
+     * Every random choice is made through this. The engine's output is the same everywhere, unlike the
+     * standard distributions, so a seed generates the same scene on every platform.
+     */
+    struct random
+    {
+        std::mt19937 engine;
+
+        explicit random(std::uint32_t seed) : engine(seed) {}
+
+        /** @returns A number in [0, 1). */
+        float next()
+        {
+            return static_cast<float>(engine() >> 8) / 16777216.f;
+        }
+
+        float range(float min, float max)
+        {
+            return min + (max - min) * next();
+        }
+
+        actorLightingMaterial material()
+        {
+            const glm::vec3 colour(range(0.1f, 1.f), range(0.1f, 1.f), range(0.1f, 1.f));
+            if (next() < 0.2f)  // Some mirrors so that rays bounce around.
+            {
+                return { glm::vec3(0.f), glm::vec3(1.f), glm::vec3(0.8f), 50.f };
+            }
+            return { colour, glm::vec3(0.1f), glm::vec3(0.f), range(8.f, 64.f) };
+        }
+    };
+
+    /**
+     * Adds the main camera, then views - 1 more spread evenly around the vertical axis through the origin.
+     * Each one sees the origin from the same height and distance as the main camera.
+     */
+    void addCamera(scene &level, const glm::ivec2 &screenSize, const glm::vec3 &position, const glm::vec3 &rotation,
+                   unsigned int views)
+    {
+        level.mainCamera = level.arena.make<Camera>(position, rotation, glm::vec3(1.f), screenSize, 22.5);
+        level.cameras.push_back(level.mainCamera);
+        level.entities.push_back(level.mainCamera);
+
+        for (unsigned int i = 1; i < views; ++i)
+        {
+            const float angle = glm::two_pi<float>() * static_cast<float>(i) / static_cast<float>(views);
+            const glm::vec3 orbitPosition(position.x * glm::cos(angle) + position.z * glm::sin(angle), position.y,
+                                          position.z * glm::cos(angle) - position.x * glm::sin(angle));
+            auto *camera = level.arena.make<Camera>(orbitPosition, rotation + glm::vec3(0.f, angle, 0.f),
+                                                    glm::vec3(1.f), screenSize, 22.5);
+            level.cameras.push_back(camera);
+            level.entities.push_back(camera);
+        }
+    }
+
+    /** @returns How far from the centre objects are scattered so that count of them aren't too crowded. */
+    float getScatterSize(unsigned int count)
+    {
+        return 2.f + 1.5f * glm::sqrt(static_cast<float>(count));
+    }
+
+    /** A camera that looks down at everything scattered across the floor. */
+    void addScatterCamera(scene &level, const glm::ivec2 &screenSize, float scatterSize, unsigned int views)
+    {
+        addCamera(level, screenSize, glm::vec3(0.f, 0.6f * scatterSize + 1.f, 1.4f * scatterSize + 2.f),
+                  glm::vec3(-0.4f, 0.f, 0.f), views);
+    }
+
+    /** The meshes that scattered scenes are made from. Both live in the scene's mesh buffer. */
+    struct scatterAssets
+    {
+        /** Lies flat in the XZ plane from -1 to 1. */
+        MeshAsset *quad;
+
+        /** Fits in a unit sphere, so that mesh instances can be scattered like spheres. */
+        MeshAsset *octahedron;
+    };
+
+    scatterAssets addScatterAssets(scene &level)
+    {
+        level.meshes.positions = { glm::vec3(-1.f, 0.f, -1.f), glm::vec3(-1.f, 0.f, 1.f),
+                                   glm::vec3(1.f, 0.f, 1.f), glm::vec3(1.f, 0.f, -1.f),
+                                   glm::vec3(1.f, 0.f, 0.f), glm::vec3(-1.f, 0.f, 0.f),
+                                   glm::vec3(0.f, 1.f, 0.f), glm::vec3(0.f, -1.f, 0.f),
+                                   glm::vec3(0.f, 0.f, 1.f), glm::vec3(0.f, 0.f, -1.f) };
+        level.meshes.indices = { 0, 1, 2,  2, 3, 0,
+                                 0, 2, 4,  4, 2, 1,  1, 2, 5,  5, 2, 0,
+                                 4, 3, 0,  1, 3, 4,  5, 3, 1,  0, 3, 5 };
+
+        const meshView quadView { level.meshes.positions.data(), 4, level.meshes.indices.data(), 2, nullptr };
+        const meshView octahedronView { level.meshes.positions.data() + 4, 6, level.meshes.indices.data() + 6, 8,
+                                        nullptr };
+        const scatterAssets assets { level.arena.make<MeshAsset>(quadView),
+                                     level.arena.make<MeshAsset>(octahedronView) };
+        level.meshAssets.push_back(assets.quad);
+        level.meshAssets.push_back(assets.octahedron);
+        return assets;
+    }
+
+    /** A white floor centred on the origin. */
+    void addFloor(scene &level, const scatterAssets &assets, float halfSize)
+    {
+        actorLightingMaterial white(glm::vec3(0.9f),
+                                    glm::vec3(0.1),
+                                    glm::vec3(0.1f),
+                                    50.f);
+
+        auto *floor = level.arena.make<Mesh>(glm::vec3(0.f), glm::vec3(0.f), glm::vec3(halfSize, 1.f, halfSize),
+                                             white, *assets.quad);
+        level.actors.push_back(floor);
+        level.entities.push_back(floor);
+    }
+
+    /** count spheres of random sizes and materials scattered across a floor. */
+    scene randomSpheres(const glm::ivec2 &screenSize, const stressParameters &parameters)
+    {
+        scene level { true };
+        random generator(parameters.seed);
+
+        const float size = getScatterSize(parameters.count);
+        addScatterCamera(level, screenSize, size, parameters.views);
+
+        auto *light = level.arena.make<LightSource>(glm::vec3(1.f, 1.f, 1.f), glm::vec3(1));
+        level.lights.push_back(light);
+        level.entities.push_back(light);
+
+        addFloor(level, addScatterAssets(level), 2.f * size);
+        for (unsigned int i = 0; i < parameters.count; ++i)
+        {
+            const float radius = generator.range(0.2f, 0.6f);
+            const glm::vec3 position(generator.range(-size, size), radius, generator.range(-size, size));
+            const actorLightingMaterial material = generator.material();
+            auto *ball = generator.next() < parameters.dynamic ?
+                    level.arena.make<Sphere>(position, material, radius, radius, generator.range(0.5f, 2.f)) :
+                    level.arena.make<Sphere>(position, material, radius);
+            level.actors.push_back(ball);
+            level.entities.push_back(ball);
+        }
+
+        return level;
+    }
+
+    /** A count by count grid of quads with random rolling hills, as a single mesh. */
+    scene triangleGrid(const glm::ivec2 &screenSize, const stressParameters &parameters)
+    {
+        scene level { true };
+        random generator(parameters.seed);
+        addCamera(level, screenSize, glm::vec3(0.f, 8.f, 16.f), glm::vec3(-0.45f, 0.f, 0.f), parameters.views);
+
+        auto *light = level.arena.make<LightSource>(glm::vec3(1.f, 1.f, 1.f), glm::vec3(1));
+        level.lights.push_back(light);
+        level.entities.push_back(light);
+
+        // A few waves with random directions give hills that are smooth at any resolution.
+        struct wave
+        {
+            glm::vec2   direction;
+            float       phase;
+            float       height;
+        };
+        wave waves[4];
+        for (wave &w : waves)
+        {
+            const float angle = generator.range(0.f, glm::two_pi<float>());
+            w.direction = glm::vec2(glm::cos(angle), glm::sin(angle)) * generator.range(0.2f, 1.f);
+            w.phase = generator.range(0.f, glm::two_pi<float>());
+            w.height = generator.range(0.1f, 0.4f);
+        }
+
+        const unsigned int quads = std::max(parameters.count, 1u);
+        const std::uint32_t side = quads + 1;
+        const float halfSize = 10.f;
+        level.meshes.positions.reserve(static_cast<std::size_t>(side) * side);
+        for (std::uint32_t z = 0; z < side; ++z)
+        {
+            for (std::uint32_t x = 0; x < side; ++x)
+            {
+                const glm::vec2 point = glm::vec2(x, z) / static_cast<float>(quads) * 2.f * halfSize - halfSize;
+                float height = 0.f;
+                for (const wave &w : waves)
+                {
+                    height += w.height * glm::sin(glm::dot(point, w.direction) + w.phase);
+                }
+                level.meshes.positions.emplace_back(point.x, height, point.y);
+            }
+        }
+
+        level.meshes.indices.reserve(static_cast<std::size_t>(quads) * quads * 6);
+        for (std::uint32_t z = 0; z < quads; ++z)
+        {
+            for (std::uint32_t x = 0; x < quads; ++x)
+            {
+                const std::uint32_t corner = z * side + x;
+                level.meshes.indices.insert(level.meshes.indices.end(), { corner, corner + side, corner + 1,
+                                                                          corner + 1, corner + side, corner + side + 1 });
+            }
+        }
+
+        const meshView view {
+                level.meshes.positions.data(),
+                level.meshes.positions.size(),
+                level.meshes.indices.data(),
+                level.meshes.indices.size() / 3,
+                nullptr
+        };
+        auto *asset = level.arena.make<MeshAsset>(view);
+        level.meshAssets.push_back(asset);
+
+        actorLightingMaterial grass(glm::vec3(0.3f, 0.6f, 0.2f),
+                                    glm::vec3(0.1f),
+                                    glm::vec3(0.f),
+                                    16.f);
+        auto *ground = level.arena.make<Mesh>(glm::vec3(0.f), glm::vec3(0.f), glm::vec3(1.f), grass, *asset);
+        level.actors.push_back(ground);
+        level.entities.push_back(ground);
+
+        actorLightingMaterial metallic(glm::vec3(0.f),
+                                       glm::vec3(1.f),
+                                       glm::vec3(0.8f),
+                                       50.f);
+        auto *ball = level.arena.make<Sphere>(glm::vec3(0.f, 2.f, 0.f), metallic, 1.f);
         level.actors.push_back(ball);
         level.entities.push_back(ball);
 
         return level;
     }
+
+    /** The mirror room lit by count lights, with depth rings of mirror panels nested inside each other. */
+    scene nestedMirrors(const glm::ivec2 &screenSize, const stressParameters &parameters)
+    {
+        scene level { true };
+        random generator(parameters.seed);
+        addCamera(level, screenSize, glm::vec3(4.5f, -1.5f, 4.5f), glm::vec3(-0.3f, 0.785f, 0.f), parameters.views);
+
+        for (unsigned int i = 0; i < parameters.count; ++i)
+        {
+            const glm::vec3 position(generator.range(-4.f, 4.f), generator.range(3.f, 4.5f), generator.range(-4.f, 4.f));
+            const glm::vec3 colour(generator.range(0.5f, 1.f), generator.range(0.5f, 1.f), generator.range(0.5f, 1.f));
+            const float share = 1.f / glm::sqrt(static_cast<float>(parameters.count));  // Keeps the room from washing out.
+            auto *light = level.arena.make<LightSource>(position, colour * share, 75);
+            level.lights.push_back(light);
+            level.entities.push_back(light);
+        }
+
+        actorLightingMaterial red(glm::vec3(0.58f, 0.f, 0.f),
+                                  glm::vec3(0.1),
+                                  glm::vec3(0.1f),
+                                  64.f);
+        auto *centerBall = level.arena.make<Sphere>(glm::vec3(0.f, -4.f, 0.f), red, 1.f);
+        level.actors.push_back(centerBall);
+        level.entities.push_back(centerBall);
+
+        actorLightingMaterial metallic(glm::vec3(0.f),
+                                       glm::vec3(1.f),
+                                       glm::vec3(0.8f),
+                                       50.f);
+        actorLightingMaterial grey(glm::vec3(0.5f),
+                                   glm::vec3(0.1f),
+                                   glm::vec3(0.f),
+                                   64.f);
+
+        // Every wall and panel is an instance of the same quad, which lies flat in the XZ plane.
+        level.meshes.positions = { glm::vec3(-1.f, 0.f, -1.f), glm::vec3(-1.f, 0.f, 1.f),
+                                   glm::vec3(1.f, 0.f, 1.f), glm::vec3(1.f, 0.f, -1.f) };
+        level.meshes.indices = { 0, 1, 2, 2, 3, 0 };
+        const meshView quadView { level.meshes.positions.data(), 4, level.meshes.indices.data(), 2, nullptr };
+        auto *quad = level.arena.make<MeshAsset>(quadView);
+        level.meshAssets.push_back(quad);
+
+        const float quarterTurn = glm::half_pi<float>();
+        auto addQuad = [&](const glm::vec3 &position, const glm::vec3 &rotation, const glm::vec3 &scale,
+                           const actorLightingMaterial &material) {
+            auto *mesh = level.arena.make<Mesh>(position, rotation, scale, material, *quad);
+            level.actors.push_back(mesh);
+            level.entities.push_back(mesh);
+        };
+        addQuad(glm::vec3(0.f, -5.f, 0.f), glm::vec3(0.f), glm::vec3(5.f), grey);
+        addQuad(glm::vec3(0.f, 5.f, 0.f), glm::vec3(0.f), glm::vec3(5.f), metallic);
+        addQuad(glm::vec3(-5.f, 0.f, 0.f), glm::vec3(0.f, 0.f, quarterTurn), glm::vec3(5.f), metallic);
+        addQuad(glm::vec3(5.f, 0.f, 0.f), glm::vec3(0.f, 0.f, quarterTurn), glm::vec3(5.f), metallic);
+        addQuad(glm::vec3(0.f, 0.f, 5.f), glm::vec3(quarterTurn, 0.f, 0.f), glm::vec3(5.f), metallic);
+        addQuad(glm::vec3(0.f, 0.f, -5.f), glm::vec3(quarterTurn, 0.f, 0.f), glm::vec3(5.f), metallic);
+
+        // Each ring is smaller than the one outside it and has gaps between its panels to see through.
+        const int panelsPerRing = 8;
+        for (unsigned int ring = 0; ring < parameters.depth; ++ring)
+        {
+            const float radius = 4.f * static_cast<float>(parameters.depth - ring) / (parameters.depth + 1) + 1.5f;
+            const float halfWidth = 0.7f * radius * glm::sin(glm::pi<float>() / panelsPerRing);
+            const float halfHeight = 2.f - 1.5f * static_cast<float>(ring) / parameters.depth;
+            const float offset = generator.range(0.f, glm::two_pi<float>());
+            for (int panel = 0; panel < panelsPerRing; ++panel)
+            {
+                const float angle = offset + glm::two_pi<float>() * panel / panelsPerRing;
+                addQuad(glm::vec3(radius * glm::sin(angle), halfHeight - 5.f, radius * glm::cos(angle)),
+                        glm::vec3(quarterTurn, angle, 0.f), glm::vec3(halfWidth, 1.f, halfHeight), metallic);
+            }
+        }
+
+        return level;
+    }
+
+    /** count spheres and mesh instances where a dynamic fraction of them are bobbing spheres. */
+    scene mixedPopulation(const glm::ivec2 &screenSize, const stressParameters &parameters)
+    {
+        scene level { true };
+        random generator(parameters.seed);
+
+        const float size = getScatterSize(parameters.count);
+        addScatterCamera(level, screenSize, size, parameters.views);
+
+        auto *light = level.arena.make<LightSource>(glm::vec3(1.f, 1.f, 1.f), glm::vec3(1));
+        level.lights.push_back(light);
+        level.entities.push_back(light);
+
+        const scatterAssets assets = addScatterAssets(level);
+        addFloor(level, assets, 2.f * size);
+        for (unsigned int i = 0; i < parameters.count; ++i)
+        {
+            const float radius = generator.range(0.2f, 0.6f);
+            const glm::vec3 position(generator.range(-size, size), radius, generator.range(-size, size));
+            const actorLightingMaterial material = generator.material();
+
+            Actor *actor;
+            if (generator.next() < parameters.dynamic)
+            {
+                actor = level.arena.make<Sphere>(position, material, radius, radius, generator.range(0.5f, 2.f));
+            }
+            else if (generator.next() < 0.5f)
+            {
+                actor = level.arena.make<Sphere>(position, material, radius);
+            }
+            else
+            {
+                const glm::vec3 rotation(0.f, generator.range(0.f, glm::two_pi<float>()), 0.f);
+                actor = level.arena.make<Mesh>(position, rotation, glm::vec3(radius), material, *assets.octahedron);
+            }
+            level.actors.push_back(actor);
+            level.entities.push_back(actor);
+        }
+
+        return level;
+    }
 }
 
-scene loadScene(const glm::ivec2 &screenSize, unsigned int index)
+namespace
 {
-    if (index > lvl::NumberOfScenes) { return { false }; }  // No scene exist with given index.
+    glm::vec3 toVec3(const float (&values)[3])
+    {
+        return { values[0], values[1], values[2] };
+    }
+
+    actorLightingMaterial toMaterial(const sceneFile::material &material)
+    {
+        return {
+                toVec3(material.baseColour),
+                toVec3(material.ambientIntensity),
+                toVec3(material.diffuseIntensity),
+                toVec3(material.specularIntensity),
+                toVec3(material.transmissionIntensity),
+                toVec3(material.reflectivityIntensity),
+                material.shininessConstant,
+                material.refractiveIndex
+        };
+    }
+
+    /** @returns Everything in the path up to and including the last slash. */
+    std::string getDirectory(const std::string &path)
+    {
+        const std::size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+    }
+
+    bool isAbsolutePath(const std::string &path)
+    {
+        return !path.empty() && (path[0] == '/' || path[0] == '\\' || (path.size() > 1 && path[1] == ':'));
+    }
+
+    template<typename T>
+    const T *getSection(const MappedFile &file, sceneFile::sectionType type)
+    {
+        const auto *header = reinterpret_cast<const sceneFile::header*>(file.getData());
+        return reinterpret_cast<const T*>(file.getData() + header->sections[type].offset);
+    }
+
+    /**
+     * Checks that the header and every section fits in the file, and that every record that refers to other
+     * records (including each index of a mesh) stays within them. Vertices are trusted to be correct by the compiler.
+     */
+    bool isValidSceneFile(const MappedFile &file)
+    {
+        if (file.getSize() < sizeof(sceneFile::header)) { return false; }
+
+        const auto *header = reinterpret_cast<const sceneFile::header*>(file.getData());
+        if (std::memcmp(header->magic, sceneFile::magic, sizeof(sceneFile::magic)) != 0) { return false; }
+        if (header->version != sceneFile::version) { return false; }
+
+        for (int i = 0; i < sceneFile::NumberOfSections; ++i)
+        {
+            const sceneFile::section &section = header->sections[i];
+            const std::uint64_t recordSize = sceneFile::recordSize(static_cast<sceneFile::sectionType>(i));
+            if (section.offset % sceneFile::sectionAlignment != 0) { return false; }
+            if (section.offset > file.getSize()) { return false; }
+            if (section.count > (file.getSize() - section.offset) / recordSize) { return false; }
+        }
+
+        const std::uint64_t materialCount = header->sections[sceneFile::Materials].count;
+        if (header->mainCamera >= header->sections[sceneFile::Cameras].count) { return false; }
+
+        const auto *spheres = getSection<sceneFile::sphere>(file, sceneFile::Spheres);
+        for (std::uint64_t i = 0; i < header->sections[sceneFile::Spheres].count; ++i)
+        {
+            if (spheres[i].material >= materialCount) { return false; }
+        }
+
+        const auto *tris = getSection<sceneFile::tri>(file, sceneFile::Tris);
+        for (std::uint64_t i = 0; i < header->sections[sceneFile::Tris].count; ++i)
+        {
+            if (tris[i].material >= materialCount) { return false; }
+            for (const std::uint32_t vertexMaterial : tris[i].vertexMaterials)
+            {
+                if (vertexMaterial != sceneFile::noMaterial && vertexMaterial >= materialCount) { return false; }
+            }
+        }
+
+        const auto *meshes = getSection<sceneFile::mesh>(file, sceneFile::Meshes);
+        const auto *indices = getSection<std::uint32_t>(file, sceneFile::Indices);
+        for (std::uint64_t i = 0; i < header->sections[sceneFile::Meshes].count; ++i)
+        {
+            const sceneFile::mesh &mesh = meshes[i];
+            if (std::uint64_t(mesh.firstVertex) + mesh.vertexCount > header->sections[sceneFile::Vertices].count)
+            {
+                return false;
+            }
+            if (std::uint64_t(mesh.firstIndex) + std::uint64_t(mesh.triangleCount) * 3
+                > header->sections[sceneFile::Indices].count)
+            {
+                return false;
+            }
+
+            // The mesh asset reads its vertices through these without checking them.
+            const std::uint32_t *first = indices + mesh.firstIndex;
+            const std::uint32_t *last = first + std::uint64_t(mesh.triangleCount) * 3;
+            if (std::any_of(first, last, [&mesh](std::uint32_t index) { return index >= mesh.vertexCount; }))
+            {
+                return false;
+            }
+        }
+
+        const auto *meshFiles = getSection<sceneFile::meshFile>(file, sceneFile::MeshFiles);
+        for (std::uint64_t i = 0; i < header->sections[sceneFile::MeshFiles].count; ++i)
+        {
+            const sceneFile::meshFile &meshFile = meshFiles[i];
+            if (std::uint64_t(meshFile.pathOffset) + meshFile.pathLength > header->sections[sceneFile::Strings].count)
+            {
+                return false;
+            }
+        }
+
+        const auto *instances = getSection<sceneFile::instance>(file, sceneFile::Instances);
+        for (std::uint64_t i = 0; i < header->sections[sceneFile::Instances].count; ++i)
+        {
+            const sceneFile::instance &instance = instances[i];
+            const sceneFile::sectionType assets = instance.flags & sceneFile::Imported ? sceneFile::MeshFiles
+                                                                                       : sceneFile::Meshes;
+            if (instance.material >= materialCount) { return false; }
+            if (instance.asset >= header->sections[assets].count) { return false; }
+        }
+
+        return true;
+    }
+
+    std::vector<aabb> getActorBounds(const scene &level)
+    {
+        std::vector<aabb> actorBounds;
+        actorBounds.reserve(level.actors.size());
+        for (const Actor *actor : level.actors)
+        {
+            actorBounds.push_back(actor->getBounds());
+        }
+        return actorBounds;
+    }
+
+    /**
+     * Does everything that is the same for every scene once its entities have been created.
+     * @returns False (with the scene's error set) if the mesh assets couldn't be paged out.
+     */
+    bool finishScene(scene &level, const loadOptions &options)
+    {
+        bool isEveryAssetCompact = true;
+        if (options.isCompactingGeometry)
+        {
+            for (MeshAsset *asset : level.meshAssets)
+            {
+                isEveryAssetCompact = asset->compact() && isEveryAssetCompact;
+            }
+        }
+
+        if (options.residentBudget > 0 && !level.meshAssets.empty())
+        {
+            level.pages = level.arena.make<ClusterCache>(ClusterCache::makeTemporaryPath(), options.residentBudget);
+            for (MeshAsset *asset : level.meshAssets)
+            {
+                asset->pageOut(*level.pages);
+            }
+            if (!level.pages->finish())
+            {
+                level.error = "Could not write the page file";
+                return false;
+            }
+        }
+
+        // Nothing points into the imported meshes anymore.
+        if ((options.isCompactingGeometry && isEveryAssetCompact) || level.pages != nullptr)
+        {
+            level.meshes = meshBuffer();
+        }
+
+        // Static entities were baked when they were created.
+        for (auto &entity : level.entities)
+        {
+            if (!entity->isStatic()) { level.dynamicEntities.push_back(entity); }
+        }
+
+        level.actorTree.build(getActorBounds(level), 1);
+        return true;
+    }
+}
+
+scene loadScene(const glm::ivec2 &screenSize, unsigned int index, const loadOptions &options)
+{
+    if (index > lvl::NumberOfScenes) { return failedScene("There is no built in scene " + std::to_string(index)); }
+    scene level;
     switch (index)
     {
         case 0:
         default:
-            return scenes::level1(screenSize);
+            level = scenes::level1(screenSize);
+            break;
         case 1:
-            return scenes::level2(screenSize);
+            level = scenes::level2(screenSize);
+            break;
         case 2:
-            return scenes::level3(screenSize);
+            level = scenes::level3(screenSize);
+            break;
         case 3:
-            return scenes::level4(screenSize);
+            level = scenes::level4(screenSize);
+            break;
+    }
+
+    if (!finishScene(level, options)) { return failedScene(level.error); }
+    return level;
+}
+
+scene failedScene(const std::string &error)
+{
+    scene level { false };
+    level.error = error;
+    return level;
+}
+
+bool isStressDescription(const std::string &path)
+{
+    const std::string prefix = "stress:";
+    return path.compare(0, prefix.size(), prefix) == 0;
+}
+
+bool parseStressParameters(const std::string &description, stressParameters &parameters)
+{
+    const std::string prefix = "stress:";
+    if (!isStressDescription(description)) { return false; }
+
+    const std::string names[lvl::NumberOfStressScenes] = { "spheres", "grid", "mirrors", "mixed" };
+    const std::size_t nameEnd = std::min(description.find(':', prefix.size()), description.size());
+    const std::string name = description.substr(prefix.size(), nameEnd - prefix.size());
+    const auto found = std::find(std::begin(names), std::end(names), name);
+    if (found == std::end(names)) { return false; }
+
+    parameters = stressParameters();
+    parameters.name = static_cast<lvl::stressSceneName>(found - std::begin(names));
+    if (parameters.name == lvl::MixedPopulation) { parameters.dynamic = 0.5f; }
+
+    std::size_t start = nameEnd + 1;
+    while (start < description.size())
+    {
+        const std::size_t end = std::min(description.find(',', start), description.size());
+        const std::string pair = description.substr(start, end - start);
+        start = end + 1;
+
+        const std::size_t equals = pair.find('=');
+        if (equals == std::string::npos) { return false; }
+        const std::string key = pair.substr(0, equals);
+        const std::string text = pair.substr(equals + 1);
+
+        char *parsedEnd;
+        const double value = std::strtod(text.c_str(), &parsedEnd);
+        if (text.empty() || *parsedEnd != '\0' || !std::isfinite(value) || value < 0.0) { return false; }
+
+        // Checked before the value is narrowed. Everything but dynamic is a whole number.
+        if (value > stress::getLimit(key, parameters.name))     { return false; }
+        if (key != "dynamic" && value != std::floor(value))     { return false; }
+
+        if (key == "count")         { parameters.count = static_cast<unsigned int>(value); }
+        else if (key == "depth")    { parameters.depth = static_cast<unsigned int>(value); }
+        else if (key == "dynamic")  { parameters.dynamic = static_cast<float>(value); }
+        else if (key == "seed")     { parameters.seed = static_cast<std::uint32_t>(value); }
+        else if (key == "views")    { parameters.views = glm::max(1u, static_cast<unsigned int>(value)); }
+    }
+    return true;
+}
+
+scene loadStressScene(const glm::ivec2 &screenSize, const stressParameters &parameters, const loadOptions &options)
+{
+    scene level;
+    switch (parameters.name)
+    {
+        case lvl::RandomSpheres:
+        default:
+            level = stress::randomSpheres(screenSize, parameters);
+            break;
+        case lvl::TriangleGrid:
+            level = stress::triangleGrid(screenSize, parameters);
+            break;
+        case lvl::NestedMirrors:
+            level = stress::nestedMirrors(screenSize, parameters);
+            break;
+        case lvl::MixedPopulation:
+            level = stress::mixedPopulation(screenSize, parameters);
+            break;
+    }
+
+    if (!finishScene(level, options)) { return failedScene(level.error); }
+    return level;
+}
+
+scene loadSceneFile(const glm::ivec2 &screenSize, const std::string &path, const loadOptions &options)
+{
+    static_assert(sizeof(glm::vec3) == sizeof(sceneFile::vertexPosition), "Mesh vertices are used in place.");
+
+    scene level { true };
+    if (!level.file.open(path))             { return failedScene("Could not open " + path); }
+    if (!isValidSceneFile(level.file))      { return failedScene(path + " isn't a valid compiled scene"); }
+
+    const MappedFile &file = level.file;
+    const auto *header = reinterpret_cast<const sceneFile::header*>(file.getData());
+    const auto *materials = getSection<sceneFile::material>(file, sceneFile::Materials);
+
+    const auto *cameras = getSection<sceneFile::camera>(file, sceneFile::Cameras);
+    for (std::uint64_t i = 0; i < header->sections[sceneFile::Cameras].count; ++i)
+    {
+        auto *camera = level.arena.make<Camera>(toVec3(cameras[i].position),
+                                                toVec3(cameras[i].rotation),
+                                                glm::vec3(1.f),
+                                                screenSize,
+                                                cameras[i].fovHalfAngle);
+        level.cameras.push_back(camera);
+        level.entities.push_back(camera);
+    }
+    level.mainCamera = level.cameras[header->mainCamera];
+
+    const auto *lights = getSection<sceneFile::light>(file, sceneFile::Lights);
+    for (std::uint64_t i = 0; i < header->sections[sceneFile::Lights].count; ++i)
+    {
+        const sceneFile::light &info = lights[i];
+        auto *light = info.type == sceneFile::Point ?
+                level.arena.make<LightSource>(toVec3(info.position), toVec3(info.colour), info.fallOff) :
+                level.arena.make<LightSource>(toVec3(info.position), toVec3(info.colour));
+        level.lights.push_back(light);
+        level.entities.push_back(light);
+    }
+
+    const auto *spheres = getSection<sceneFile::sphere>(file, sceneFile::Spheres);
+    for (std::uint64_t i = 0; i < header->sections[sceneFile::Spheres].count; ++i)
+    {
+        auto *sphere = level.arena.make<Sphere>(toVec3(spheres[i].position),
+                                                toMaterial(materials[spheres[i].material]),
+                                                spheres[i].radius);
+        level.actors.push_back(sphere);
+        level.entities.push_back(sphere);
+    }
+
+    const auto *tris = getSection<sceneFile::tri>(file, sceneFile::Tris);
+    for (std::uint64_t i = 0; i < header->sections[sceneFile::Tris].count; ++i)
+    {
+        const sceneFile::tri &info = tris[i];
+        const actorLightingMaterial material = toMaterial(materials[info.material]);
+        const bool useVertexMaterial = info.vertexMaterials[0] != sceneFile::noMaterial
+                                       && info.vertexMaterials[1] != sceneFile::noMaterial
+                                       && info.vertexMaterials[2] != sceneFile::noMaterial;
+
+        vertex vertices[3] = { vertex(toVec3(info.vertices[0])),
+                               vertex(toVec3(info.vertices[1])),
+                               vertex(toVec3(info.vertices[2])) };
+        for (int j = 0; j < 3 && useVertexMaterial; ++j)
+        {
+            vertices[j].material = toMaterial(materials[info.vertexMaterials[j]]);
+        }
+
+        auto *triangle = level.arena.make<Tri>(toVec3(info.position),
+                                               toVec3(info.rotation),
+                                               toVec3(info.scale),
+                                               material,
+                                               vertices,
+                                               useVertexMaterial);
+        level.actors.push_back(triangle);
+        level.entities.push_back(triangle);
+    }
+
+    const auto *positions = getSection<glm::vec3>(file, sceneFile::Vertices);
+    const auto *indices = getSection<std::uint32_t>(file, sceneFile::Indices);
+    const auto *meshes = getSection<sceneFile::mesh>(file, sceneFile::Meshes);
+    for (std::uint64_t i = 0; i < header->sections[sceneFile::Meshes].count; ++i)
+    {
+        const sceneFile::mesh &info = meshes[i];
+        const meshView view {
+                positions + info.firstVertex,
+                info.vertexCount,
+                indices + info.firstIndex,
+                info.triangleCount,
+                nullptr
+        };
+        level.meshAssets.push_back(level.arena.make<MeshAsset>(view));
+    }
+
+    const auto *meshFiles = getSection<sceneFile::meshFile>(file, sceneFile::MeshFiles);
+    const std::uint64_t meshFileCount = header->sections[sceneFile::MeshFiles].count;
+    const std::size_t firstImportedAsset = level.meshAssets.size();
+    if (meshFileCount > 0)
+    {
+        const char *strings = getSection<char>(file, sceneFile::Strings);
+        ThreadPool pool;  // The ray tracer's pool is busy rendering the current scene.
+
+        std::vector<importedMesh> imports;
+        for (std::uint64_t i = 0; i < meshFileCount; ++i)
+        {
+            std::string meshPath(strings + meshFiles[i].pathOffset, meshFiles[i].pathLength);
+            if (!isAbsolutePath(meshPath)) { meshPath = getDirectory(path) + meshPath; }
+
+            importedMesh imported = importMesh(meshPath, level.meshes, pool);
+            if (!imported.success) { return failedScene("Could not import " + meshPath + ": " + imported.error); }
+
+            level.imports.push_back({ meshPath, imported.triangleCount, imported.bytesRead, imported.seconds });
+            imports.push_back(std::move(imported));
+        }
+
+        // The buffer has finished growing, so the assets can point into it.
+        const meshBuffer &buffer = level.meshes;
+        for (const importedMesh &imported : imports)
+        {
+            const meshView view {
+                    buffer.positions.data() + imported.firstVertex,
+                    imported.vertexCount,
+                    buffer.indices.data() + imported.firstTriangle * 3,
+                    imported.triangleCount,
+                    buffer.materialIds.data() + imported.firstTriangle
+            };
+            level.meshAssets.push_back(level.arena.make<MeshAsset>(view, imported.materials));
+        }
+    }
+
+    const auto *instances = getSection<sceneFile::instance>(file, sceneFile::Instances);
+    for (std::uint64_t i = 0; i < header->sections[sceneFile::Instances].count; ++i)
+    {
+        const sceneFile::instance &info = instances[i];
+        const std::size_t asset = info.flags & sceneFile::Imported ? firstImportedAsset + info.asset : info.asset;
+        auto *mesh = level.arena.make<Mesh>(toVec3(info.position),
+                                            toVec3(info.rotation),
+                                            toVec3(info.scale),
+                                            toMaterial(materials[info.material]),
+                                            *level.meshAssets[asset],
+                                            (info.flags & sceneFile::OverrideMaterials) != 0);
+        level.actors.push_back(mesh);
+        level.entities.push_back(mesh);
+    }
+
+    if (!finishScene(level, options)) { return failedScene(level.error); }
+    return level;
+}
+
+void unloadScene(scene &level)
+{
+    level.arena.release();
+    level = { false };
+}
+
+void refitActorTree(scene &level)
+{
+    level.actorTree.refit(getActorBounds(level));
+}
+
+void printImports(const scene &level, std::ostream &out)
+{
+    for (const meshImport &imported : level.imports)
+    {
+        const double seconds = std::max(imported.seconds, 1e-9);
+        out << "Imported " << imported.path << ": " << imported.triangleCount << " triangles in "
+            << seconds * 1000.0 << " ms (" << static_cast<double>(imported.bytesRead) / 1e6 / seconds
+            << " MB/s, " << static_cast<double>(imported.triangleCount) / seconds << " triangles/s)\n";
+    }
+}
+
+void printMemoryUsage(const scene &level, std::ostream &out)
+{
+    out << "Scene Memory: " << level.arena.getBytesUsed() << " bytes used, "
+        << level.arena.getBytesReserved() << " bytes reserved";
+    if (level.file.isOpen()) { out << ", " << level.file.getSize() << " bytes mapped"; }
+    if (!level.meshes.positions.empty())
+    {
+        out << ", " << level.meshes.positions.size() * sizeof(glm::vec3)
+                       + level.meshes.indices.size() * sizeof(std::uint32_t)
+                       + level.meshes.materialIds.size() * sizeof(std::uint32_t) << " bytes of imported meshes";
+    }
+
+    std::size_t assetBytes = level.actorTree.getBytesUsed();
+    std::size_t geometryBytes = 0;
+    std::size_t triangleCount = 0;
+    std::size_t compactCount = 0;
+    for (const MeshAsset *asset : level.meshAssets)
+    {
+        assetBytes += asset->getBytesUsed();
+        geometryBytes += asset->getGeometryBytes();
+        triangleCount += asset->getTriangleCount();
+        compactCount += asset->isCompact() ? 1 : 0;
+    }
+    out << ", " << assetBytes << " bytes of mesh assets and acceleration structures\n";
+    if (triangleCount > 0)
+    {
+        out << "Mesh Geometry: " << triangleCount << " triangles in " << level.meshAssets.size() << " assets ("
+            << compactCount << " compact), " << static_cast<double>(geometryBytes) / triangleCount
+            << " bytes per triangle\n";
+    }
+    for (const auto &typeUsage : level.arena.getUsage())
+    {
+        out << "\t" << typeUsage.typeName << ": " << typeUsage.count
+            << " (" << typeUsage.bytesUsed << "/" << typeUsage.bytesReserved << " bytes)\n";
     }
 }
@@ -0,0 +1,159 @@
+/**
+ * @file Bvh.cpp
+ * @brief A bounding volume hierarchy that finds which items a ray might hit without testing all of them.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "Bvh.h"
+
+#include <algorithm>
+
+namespace
+{
+    /** The number of buckets that the centroids are sorted into when looking for the best split. */
+    const int binCount = 12;
+
+    struct bin
+    {
+        aabb            bounds;
+        std::uint32_t   count { 0 };
+    };
+}
+
+void Bvh::build(const std::vector<aabb> &itemBounds, unsigned int maxLeafSize)
+{
+    mNodes.clear();
+    mItems.resize(itemBounds.size());
+    for (std::uint32_t i = 0; i < mItems.size(); ++i)
+    {
+        mItems[i] = i;
+    }
+    if (itemBounds.empty()) { return; }
+
+    mNodes.reserve(itemBounds.size() * 2);
+    mNodes.push_back({ aabb(), 0, static_cast<std::uint32_t>(itemBounds.size()) });
+
+    struct pendingNode
+    {
+        std::uint32_t   index;
+        int             depth;
+    };
+    std::vector<pendingNode> pending { { 0, 0 } };
+    while (!pending.empty())
+    {
+        const pendingNode current = pending.back();
+        pending.pop_back();
+
+        // Work out the bounds of the node and of the centres of its items.
+        const std::uint32_t first = mNodes[current.index].leftOrFirst;
+        const std::uint32_t count = mNodes[current.index].itemCount;
+        aabb bounds;
+        aabb centroidBounds;
+        for (std::uint32_t i = first; i < first + count; ++i)
+        {
+            bounds.grow(itemBounds[mItems[i]]);
+            centroidBounds.grow(itemBounds[mItems[i]].getCentre());
+        }
+        mNodes[current.index].bounds = bounds;
+
+        if (count <= maxLeafSize || current.depth >= maxDepth - 1) { continue; }
+
+        // Find the split with the lowest surface area heuristic across every axis.
+        float bestCost = std::numeric_limits<float>::max();
+        int bestAxis = -1;
+        int bestSplit = 0;
+        const glm::vec3 extent = centroidBounds.max - centroidBounds.min;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (extent[axis] <= 0.f) { continue; }  // Every centre is in the same place.
+
+            bin bins[binCount];
+            const float scale = binCount / extent[axis];
+            for (std::uint32_t i = first; i < first + count; ++i)
+            {
+                const aabb &item = itemBounds[mItems[i]];
+                const int b = std::min(binCount - 1, static_cast<int>((item.getCentre()[axis] - centroidBounds.min[axis]) * scale));
+                bins[b].bounds.grow(item);
+                ++bins[b].count;
+            }
+
+            // Sweep from the right to get the cost of everything to the right of each split.
+            float rightCosts[binCount];
+            aabb rightBounds;
+            std::uint32_t rightCount = 0;
+            for (int b = binCount - 1; b > 0; --b)
+            {
+                rightBounds.grow(bins[b].bounds);
+                rightCount += bins[b].count;
+                rightCosts[b] = rightCount * rightBounds.getSurfaceArea();
+            }
+
+            aabb leftBounds;
+            std::uint32_t leftCount = 0;
+            for (int split = 1; split < binCount; ++split)
+            {
+                leftBounds.grow(bins[split - 1].bounds);
+                leftCount += bins[split - 1].count;
+                const float cost = leftCount * leftBounds.getSurfaceArea() + rightCosts[split];
+                if (leftCount > 0 && leftCount < count && cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = split;
+                }
+            }
+        }
+
+        std::uint32_t *items = mItems.data();
+        std::uint32_t *middle;
+        if (bestAxis >= 0)
+        {
+            const float scale = binCount / extent[bestAxis];
+            const float minimum = centroidBounds.min[bestAxis];
+            middle = std::partition(items + first, items + first + count, [&](std::uint32_t item) {
+                const int b = std::min(binCount - 1, static_cast<int>((itemBounds[item].getCentre()[bestAxis] - minimum) * scale));
+                return b < bestSplit;
+            });
+        }
+        else
+        {
+            middle = items + first + count / 2;  // Nothing to split on, so just halve the items.
+        }
+
+        const auto leftCount = static_cast<std::uint32_t>(middle - (items + first));
+        const auto left = static_cast<std::uint32_t>(mNodes.size());
+        mNodes.push_back({ aabb(), first, leftCount });
+        mNodes.push_back({ aabb(), first + leftCount, count - leftCount });
+        mNodes[current.index].leftOrFirst = left;
+        mNodes[current.index].itemCount = 0;
+
+        pending.push_back({ left, current.depth + 1 });
+        pending.push_back({ left + 1, current.depth + 1 });
+    }
+}
+
+void Bvh::refit(const std::vector<aabb> &itemBounds)
+{
+    // Children always come after their parents, so going backwards updates the children first.
+    for (std::size_t i = mNodes.size(); i > 0; --i)
+    {
+        node &n = mNodes[i - 1];
+        n.bounds = aabb();
+        if (n.itemCount > 0)
+        {
+            for (std::uint32_t item = n.leftOrFirst; item < n.leftOrFirst + n.itemCount; ++item)
+            {
+                n.bounds.grow(itemBounds[mItems[item]]);
+            }
+        }
+        else
+        {
+            n.bounds.grow(mNodes[n.leftOrFirst].bounds);
+            n.bounds.grow(mNodes[n.leftOrFirst + 1].bounds);
+        }
+    }
+}
@@ -0,0 +1,291 @@
+/**
+ * @file Kernels.cpp
+ * @brief The loops that run over whole rows of pixels or triangles, built for several instruction sets and picked
+ * at startup.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "Kernels.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <mutex>
+
+#ifdef A2_KERNELS_X86
+#if defined(_MSC_VER)
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+namespace
+{
+    const char *const isaNames[kernels::NumberOfIsas] = { "Generic", "SSE4.2", "AVX2", "AVX-512" };
+
+    std::mutex selectionLock;
+    std::atomic<const kernels::table *> selectedTable { nullptr };
+    kernels::isa selectedIsa { kernels::Generic };
+    kernels::isa requestedIsa { kernels::Generic };
+
+    /** The value of A2_ISA if it wasn't the name of an instruction set. */
+    std::string unknownEnvironmentIsa;
+
+    void normaliseDirections(const float *direction, const float *step, float x, float xStep, int count,
+                             float *xs, float *ys, float *zs)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            // The same operations in the same order as glm::normalize().
+            const float rayX = x + static_cast<float>(i) * xStep;
+            const float dx = direction[0] + rayX * step[0];
+            const float dy = direction[1] + rayX * step[1];
+            const float dz = direction[2] + rayX * step[2];
+            const float inverseLength = 1.f / std::sqrt(dx * dx + dy * dy + dz * dz);
+            xs[i] = dx * inverseLength;
+            ys[i] = dy * inverseLength;
+            zs[i] = dz * inverseLength;
+        }
+    }
+
+    std::uint32_t toChannel(float value)
+    {
+        return static_cast<std::uint32_t>(std::min(std::max(value, 0.f), 1.f) * 255.f);
+    }
+
+    void packColours(const float *colours, std::uint32_t *packed, int count)
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            const float *colour = colours + i * 3;
+            packed[i] = toChannel(colour[0]) << 16u | toChannel(colour[1]) << 8u | toChannel(colour[2]);
+        }
+    }
+
+    void rasteriseSpan(const kernels::rasterSpan &span, float *inverseDepths, std::uint32_t *actors,
+                       std::uint32_t *primitives)
+    {
+        for (int x = span.xStart; x < span.xEnd; ++x)
+        {
+            const auto fx = static_cast<float>(x);
+            const float weight0 = span.weightStep[0] * fx + span.weightRow[0];
+            const float weight1 = span.weightStep[1] * fx + span.weightRow[1];
+            const float weight2 = span.weightStep[2] * fx + span.weightRow[2];
+            const float depth = span.depthStep * fx + span.depthRow;
+            if (weight0 >= 0.f && weight1 >= 0.f && weight2 >= 0.f && depth > inverseDepths[x])
+            {
+                inverseDepths[x] = depth;
+                actors[x] = span.actor;
+                primitives[x] = span.primitive;
+            }
+        }
+    }
+
+    std::uint32_t intersectTriangles(const float *corners, int count, const float *origin, const float *direction,
+                                     float maxDistance, float *distances)
+    {
+        std::uint32_t hits = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            // The same operations in the same order as glm::cross() and glm::dot().
+            const float *v0 = corners + i * 9;
+            const float *v1 = v0 + 3;
+            const float *v2 = v0 + 6;
+            const float edge1[3] = { v1[0] - v0[0], v1[1] - v0[1], v1[2] - v0[2] };
+            const float edge2[3] = { v2[0] - v0[0], v2[1] - v0[1], v2[2] - v0[2] };
+
+            const float p[3] = { direction[1] * edge2[2] - edge2[1] * direction[2],
+                                 direction[2] * edge2[0] - edge2[2] * direction[0],
+                                 direction[0] * edge2[1] - edge2[0] * direction[1] };
+            const float determinant = edge1[0] * p[0] + edge1[1] * p[1] + edge1[2] * p[2];
+            if (determinant == 0.f) { continue; }  // Parallel with the triangle.
+
+            const float inverseDeterminant = 1.f / determinant;
+            const float toOrigin[3] = { origin[0] - v0[0], origin[1] - v0[1], origin[2] - v0[2] };
+            const float u = (toOrigin[0] * p[0] + toOrigin[1] * p[1] + toOrigin[2] * p[2]) * inverseDeterminant;
+            if (u < 0.f || u > 1.f) { continue; }
+
+            const float q[3] = { toOrigin[1] * edge1[2] - edge1[1] * toOrigin[2],
+                                 toOrigin[2] * edge1[0] - edge1[2] * toOrigin[0],
+                                 toOrigin[0] * edge1[1] - edge1[0] * toOrigin[1] };
+            const float v = (direction[0] * q[0] + direction[1] * q[1] + direction[2] * q[2]) * inverseDeterminant;
+            if (v < 0.f || u + v > 1.f) { continue; }
+
+            distances[i] = (edge2[0] * q[0] + edge2[1] * q[1] + edge2[2] * q[2]) * inverseDeterminant;
+            if (distances[i] > 0.f && distances[i] < maxDistance) { hits |= 1u << static_cast<unsigned int>(i); }
+        }
+        return hits;
+    }
+
+#ifdef A2_KERNELS_X86
+    void cpuid(unsigned int leaf, unsigned int subleaf, unsigned int (&registers)[4])
+    {
+#if defined(_MSC_VER)
+        int values[4];
+        __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+        std::copy(std::begin(values), std::end(values), std::begin(registers));
+#else
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+#endif
+    }
+
+    /** @returns XCR0, the register state that the OS saves between threads. Only valid when OSXSAVE is set. */
+    std::uint64_t getSavedState()
+    {
+#if defined(_MSC_VER)
+        return _xgetbv(0);
+#else
+        unsigned int low;
+        unsigned int high;
+        __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+        return static_cast<std::uint64_t>(high) << 32u | low;
+#endif
+    }
+
+    kernels::isa detect()
+    {
+        unsigned int registers[4];
+        cpuid(0, 0, registers);
+        const unsigned int maxLeaf = registers[0];
+        if (maxLeaf < 1) { return kernels::Generic; }
+
+        cpuid(1, 0, registers);
+        const unsigned int features = registers[2];
+        if ((features & 1u << 20u) == 0) { return kernels::Generic; }
+
+        // AVX registers are only usable if the OS saves them (XMM and YMM in XCR0) on top of the CPU having them.
+        const bool isAvxEnabled = (features & 1u << 27u) != 0 && (features & 1u << 28u) != 0
+                && (getSavedState() & 0x6u) == 0x6u;
+        if (!isAvxEnabled || maxLeaf < 7) { return kernels::Sse42; }
+
+        cpuid(7, 0, registers);
+        const unsigned int extendedFeatures = registers[1];
+        if ((extendedFeatures & 1u << 5u) == 0) { return kernels::Sse42; }
+
+        // AVX-512 adds the mask registers and the upper halves and top sixteen of the ZMM registers.
+        const bool isAvx512Enabled = (extendedFeatures & 1u << 16u) != 0 && (getSavedState() & 0xE6u) == 0xE6u;
+        return isAvx512Enabled ? kernels::Avx512 : kernels::Avx2;
+    }
+#else
+    kernels::isa detect()
+    {
+        return kernels::Generic;
+    }
+#endif
+
+    const kernels::table &getTable(kernels::isa value)
+    {
+        switch (value)
+        {
+#ifdef A2_KERNELS_X86
+            case kernels::Sse42:    return kernels::getSse42Table();
+            case kernels::Avx2:     return kernels::getAvx2Table();
+            case kernels::Avx512:   return kernels::getAvx512Table();
+#endif
+            default:                return kernels::getGenericTable();
+        }
+    }
+
+    /** selectionLock must be held. */
+    void selectLocked(kernels::isa requested)
+    {
+        requestedIsa = requested;
+        selectedIsa = std::min(requested, kernels::getSupported());
+        selectedTable.store(&getTable(selectedIsa), std::memory_order_release);
+    }
+}
+
+kernels::isa kernels::getSupported()
+{
+    static const isa supported = detect();
+    return supported;
+}
+
+kernels::isa kernels::getSelected()
+{
+    get();
+    std::lock_guard<std::mutex> lock(selectionLock);
+    return selectedIsa;
+}
+
+const kernels::table &kernels::get()
+{
+    const table *current = selectedTable.load(std::memory_order_acquire);
+    if (current != nullptr) { return *current; }
+
+    std::lock_guard<std::mutex> lock(selectionLock);
+    if (selectedTable.load(std::memory_order_relaxed) == nullptr)
+    {
+        isa requested = getSupported();
+        const char *name = std::getenv("A2_ISA");
+        if (name != nullptr && !readName(name, requested))
+        {
+            unknownEnvironmentIsa = name;
+            requested = getSupported();
+        }
+        selectLocked(requested);
+    }
+    return *selectedTable.load(std::memory_order_relaxed);
+}
+
+void kernels::select(isa requested)
+{
+    std::lock_guard<std::mutex> lock(selectionLock);
+    selectLocked(requested);
+}
+
+std::string kernels::describeSelection()
+{
+    get();
+    std::lock_guard<std::mutex> lock(selectionLock);
+    const isa supported = getSupported();
+    std::string description = isaNames[selectedIsa];
+    if (requestedIsa > supported)
+    {
+        description += std::string(" (") + isaNames[requestedIsa] + " isn't supported)";
+    }
+    else if (selectedIsa < supported)
+    {
+        description += std::string(" (up to ") + isaNames[supported] + " is supported)";
+    }
+    if (!unknownEnvironmentIsa.empty()) { description += ", ignoring the unknown A2_ISA " + unknownEnvironmentIsa; }
+    return description;
+}
+
+const char *kernels::getName(isa value)
+{
+    return isaNames[value];
+}
+
+bool kernels::readName(const std::string &name, isa &value)
+{
+    std::string lowered;
+    for (const char character : name)
+    {
+        if (character != '-' && character != '.')
+        {
+            lowered.push_back(static_cast<char>(std::tolower(static_cast<unsigned char>(character))));
+        }
+    }
+
+    const char *const names[NumberOfIsas] = { "generic", "sse42", "avx2", "avx512" };
+    const auto found = std::find_if(std::begin(names), std::end(names), [&](const char *option) {
+        return lowered == option;
+    });
+    if (found == std::end(names)) { return false; }
+    value = static_cast<isa>(found - std::begin(names));
+    return true;
+}
+
+const kernels::table &kernels::getGenericTable()
+{
+    static const table generic { normaliseDirections, packColours, rasteriseSpan, intersectTriangles };
+    return generic;
+}
@@ -0,0 +1,133 @@
+/**
+ * @file KernelsAvx2.cpp
+ * @brief The kernels eight pixels at a time with AVX2. Only built for x86, with -mavx2 or /arch:AVX2.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "Kernels.h"
+
+#include <immintrin.h>
+
+// Nothing here can call an inline function from a header (like std::sqrt()), since the linker could keep this
+// copy of it, built for AVX2, for everything else too. Whatever doesn't fill a whole group goes to SSE4.2.
+
+namespace
+{
+    void normaliseDirections(const float *direction, const float *step, float x, float xStep, int count,
+                             float *xs, float *ys, float *zs)
+    {
+        const __m256 lanes = _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+        const __m256 one = _mm256_set1_ps(1.f);
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const __m256 index = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(i)), lanes);
+            const __m256 rayX = _mm256_add_ps(_mm256_set1_ps(x), _mm256_mul_ps(index, _mm256_set1_ps(xStep)));
+            const __m256 dx = _mm256_add_ps(_mm256_set1_ps(direction[0]), _mm256_mul_ps(rayX, _mm256_set1_ps(step[0])));
+            const __m256 dy = _mm256_add_ps(_mm256_set1_ps(direction[1]), _mm256_mul_ps(rayX, _mm256_set1_ps(step[1])));
+            const __m256 dz = _mm256_add_ps(_mm256_set1_ps(direction[2]), _mm256_mul_ps(rayX, _mm256_set1_ps(step[2])));
+            const __m256 lengthSquared = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(dx, dx), _mm256_mul_ps(dy, dy)),
+                                                       _mm256_mul_ps(dz, dz));
+            const __m256 inverseLength = _mm256_div_ps(one, _mm256_sqrt_ps(lengthSquared));
+            _mm256_storeu_ps(xs + i, _mm256_mul_ps(dx, inverseLength));
+            _mm256_storeu_ps(ys + i, _mm256_mul_ps(dy, inverseLength));
+            _mm256_storeu_ps(zs + i, _mm256_mul_ps(dz, inverseLength));
+        }
+
+        if (i < count)
+        {
+            kernels::getSse42Table().normaliseDirections(direction, step, x + static_cast<float>(i) * xStep, xStep,
+                                                         count - i, xs + i, ys + i, zs + i);
+        }
+    }
+
+    __m256i toChannels(__m256 values)
+    {
+        const __m256 clamped = _mm256_min_ps(_mm256_max_ps(values, _mm256_setzero_ps()), _mm256_set1_ps(1.f));
+        return _mm256_cvttps_epi32(_mm256_mul_ps(clamped, _mm256_set1_ps(255.f)));
+    }
+
+    void packColours(const float *colours, std::uint32_t *packed, int count)
+    {
+        // Eight colours are 24 channels in three registers. Their 128 bit halves are swapped around so that each half
+        // has four whole colours, then they're narrowed to bytes in order and each colour's bytes are swapped around
+        // into 0x00RRGGBB, the same as SSE4.2 does for each half. It's quicker than gathering each channel.
+        const __m256i order = _mm256_setr_epi8(2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128,
+                                               2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128);
+        int i = 0;
+        for (; i + 8 <= count; i += 8)
+        {
+            const float *source = colours + i * 3;
+            const __m256i first = toChannels(_mm256_loadu_ps(source));
+            const __m256i second = toChannels(_mm256_loadu_ps(source + 8));
+            const __m256i third = toChannels(_mm256_loadu_ps(source + 16));
+            const __m256i low = _mm256_permute2x128_si256(first, second, 0x30);
+            const __m256i middle = _mm256_permute2x128_si256(first, third, 0x21);
+            const __m256i high = _mm256_permute2x128_si256(second, third, 0x30);
+            const __m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(low, middle), _mm256_packus_epi32(high, high));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(packed + i), _mm256_shuffle_epi8(bytes, order));
+        }
+
+        if (i < count) { kernels::getSse42Table().packColours(colours + i * 3, packed + i, count - i); }
+    }
+
+    void rasteriseSpan(const kernels::rasterSpan &span, float *inverseDepths, std::uint32_t *actors,
+                       std::uint32_t *primitives)
+    {
+        const __m256 lanes = _mm256_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f);
+        const __m256 zero = _mm256_setzero_ps();
+        const __m256i actor = _mm256_set1_epi32(static_cast<int>(span.actor));
+        const __m256i primitive = _mm256_set1_epi32(static_cast<int>(span.primitive));
+        int x = span.xStart;
+        for (; x + 8 <= span.xEnd; x += 8)
+        {
+            const __m256 fx = _mm256_add_ps(_mm256_set1_ps(static_cast<float>(x)), lanes);
+            const __m256 weight0 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(span.weightStep[0]), fx),
+                                                 _mm256_set1_ps(span.weightRow[0]));
+            const __m256 weight1 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(span.weightStep[1]), fx),
+                                                 _mm256_set1_ps(span.weightRow[1]));
+            const __m256 weight2 = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(span.weightStep[2]), fx),
+                                                 _mm256_set1_ps(span.weightRow[2]));
+            const __m256 depth = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(span.depthStep), fx),
+                                               _mm256_set1_ps(span.depthRow));
+            const __m256 oldDepth = _mm256_loadu_ps(inverseDepths + x);
+
+            const __m256 isInside = _mm256_and_ps(_mm256_and_ps(_mm256_cmp_ps(weight0, zero, _CMP_GE_OQ),
+                                                                _mm256_cmp_ps(weight1, zero, _CMP_GE_OQ)),
+                                                  _mm256_cmp_ps(weight2, zero, _CMP_GE_OQ));
+            const __m256 isWritten = _mm256_and_ps(isInside, _mm256_cmp_ps(depth, oldDepth, _CMP_GT_OQ));
+            if (_mm256_movemask_ps(isWritten) == 0) { continue; }
+
+            const __m256i mask = _mm256_castps_si256(isWritten);
+            const auto oldActors = reinterpret_cast<__m256i *>(actors + x);
+            const auto oldPrimitives = reinterpret_cast<__m256i *>(primitives + x);
+            _mm256_storeu_ps(inverseDepths + x, _mm256_blendv_ps(oldDepth, depth, isWritten));
+            _mm256_storeu_si256(oldActors, _mm256_blendv_epi8(_mm256_loadu_si256(oldActors), actor, mask));
+            _mm256_storeu_si256(oldPrimitives, _mm256_blendv_epi8(_mm256_loadu_si256(oldPrimitives), primitive, mask));
+        }
+
+        if (x < span.xEnd)
+        {
+            kernels::rasterSpan rest = span;
+            rest.xStart = x;
+            kernels::getSse42Table().rasteriseSpan(rest, inverseDepths, actors, primitives);
+        }
+    }
+
+    std::uint32_t intersectTriangles(const float *corners, int count, const float *origin, const float *direction,
+                                     float maxDistance, float *distances)
+    {
+        // A leaf rarely holds more than four triangles, so there's nothing to fill the wider registers with.
+        return kernels::getSse42Table().intersectTriangles(corners, count, origin, direction, maxDistance, distances);
+    }
+}
+
+const kernels::table &kernels::getAvx2Table()
+{
+    static const table avx2 { normaliseDirections, packColours, rasteriseSpan, intersectTriangles };
+    return avx2;
+}
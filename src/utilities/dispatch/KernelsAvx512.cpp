@@ -0,0 +1,104 @@
+/**
+ * @file KernelsAvx512.cpp
+ * @brief The kernels sixteen pixels at a time with AVX-512. Only built for x86, with -mavx512f or /arch:AVX512.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "Kernels.h"
+
+#include <immintrin.h>
+
+// Nothing here can call an inline function from a header (like std::sqrt()), since the linker could keep this
+// copy of it, built for AVX-512, for everything else too. The last group of each row is masked rather than handed
+// down to a narrower kernel. Masked off lanes are never loaded, so they can't fault past the end of a row.
+
+namespace
+{
+    /** @returns The lanes of a group starting at first that come before end. */
+    __mmask16 getLanes(int first, int end)
+    {
+        const int remaining = end - first;
+        return remaining >= 16 ? static_cast<__mmask16>(0xFFFF) : static_cast<__mmask16>((1u << remaining) - 1u);
+    }
+
+    void normaliseDirections(const float *direction, const float *step, float x, float xStep, int count,
+                             float *xs, float *ys, float *zs)
+    {
+        const __m512 lanes = _mm512_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f,
+                                            8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f);
+        const __m512 one = _mm512_set1_ps(1.f);
+        for (int i = 0; i < count; i += 16)
+        {
+            const __mmask16 isUsed = getLanes(i, count);
+            const __m512 index = _mm512_add_ps(_mm512_set1_ps(static_cast<float>(i)), lanes);
+            const __m512 rayX = _mm512_add_ps(_mm512_set1_ps(x), _mm512_mul_ps(index, _mm512_set1_ps(xStep)));
+            const __m512 dx = _mm512_add_ps(_mm512_set1_ps(direction[0]), _mm512_mul_ps(rayX, _mm512_set1_ps(step[0])));
+            const __m512 dy = _mm512_add_ps(_mm512_set1_ps(direction[1]), _mm512_mul_ps(rayX, _mm512_set1_ps(step[1])));
+            const __m512 dz = _mm512_add_ps(_mm512_set1_ps(direction[2]), _mm512_mul_ps(rayX, _mm512_set1_ps(step[2])));
+            const __m512 lengthSquared = _mm512_add_ps(_mm512_add_ps(_mm512_mul_ps(dx, dx), _mm512_mul_ps(dy, dy)),
+                                                       _mm512_mul_ps(dz, dz));
+            const __m512 inverseLength = _mm512_div_ps(one, _mm512_maskz_sqrt_ps(isUsed, lengthSquared));
+            _mm512_mask_storeu_ps(xs + i, isUsed, _mm512_mul_ps(dx, inverseLength));
+            _mm512_mask_storeu_ps(ys + i, isUsed, _mm512_mul_ps(dy, inverseLength));
+            _mm512_mask_storeu_ps(zs + i, isUsed, _mm512_mul_ps(dz, inverseLength));
+        }
+    }
+
+    void packColours(const float *colours, std::uint32_t *packed, int count)
+    {
+        // Narrowing and shuffling bytes across a whole register needs AVX-512BW, so this stays with AVX2.
+        kernels::getAvx2Table().packColours(colours, packed, count);
+    }
+
+    void rasteriseSpan(const kernels::rasterSpan &span, float *inverseDepths, std::uint32_t *actors,
+                       std::uint32_t *primitives)
+    {
+        const __m512 lanes = _mm512_setr_ps(0.f, 1.f, 2.f, 3.f, 4.f, 5.f, 6.f, 7.f,
+                                            8.f, 9.f, 10.f, 11.f, 12.f, 13.f, 14.f, 15.f);
+        const __m512 zero = _mm512_setzero_ps();
+        const __m512i actor = _mm512_set1_epi32(static_cast<int>(span.actor));
+        const __m512i primitive = _mm512_set1_epi32(static_cast<int>(span.primitive));
+        for (int x = span.xStart; x < span.xEnd; x += 16)
+        {
+            const __mmask16 isUsed = getLanes(x, span.xEnd);
+            const __m512 fx = _mm512_add_ps(_mm512_set1_ps(static_cast<float>(x)), lanes);
+            const __m512 weight0 = _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(span.weightStep[0]), fx),
+                                                 _mm512_set1_ps(span.weightRow[0]));
+            const __m512 weight1 = _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(span.weightStep[1]), fx),
+                                                 _mm512_set1_ps(span.weightRow[1]));
+            const __m512 weight2 = _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(span.weightStep[2]), fx),
+                                                 _mm512_set1_ps(span.weightRow[2]));
+            const __m512 depth = _mm512_add_ps(_mm512_mul_ps(_mm512_set1_ps(span.depthStep), fx),
+                                               _mm512_set1_ps(span.depthRow));
+            const __m512 oldDepth = _mm512_maskz_loadu_ps(isUsed, inverseDepths + x);
+
+            const __mmask16 isInside = _mm512_mask_cmp_ps_mask(
+                    _mm512_mask_cmp_ps_mask(_mm512_mask_cmp_ps_mask(isUsed, weight0, zero, _CMP_GE_OQ),
+                                            weight1, zero, _CMP_GE_OQ),
+                    weight2, zero, _CMP_GE_OQ);
+            const __mmask16 isWritten = _mm512_mask_cmp_ps_mask(isInside, depth, oldDepth, _CMP_GT_OQ);
+            if (isWritten == 0) { continue; }
+
+            _mm512_mask_storeu_ps(inverseDepths + x, isWritten, depth);
+            _mm512_mask_storeu_epi32(actors + x, isWritten, actor);
+            _mm512_mask_storeu_epi32(primitives + x, isWritten, primitive);
+        }
+    }
+
+    std::uint32_t intersectTriangles(const float *corners, int count, const float *origin, const float *direction,
+                                     float maxDistance, float *distances)
+    {
+        // The same as AVX2, which hands them to SSE4.2.
+        return kernels::getAvx2Table().intersectTriangles(corners, count, origin, direction, maxDistance, distances);
+    }
+}
+
+const kernels::table &kernels::getAvx512Table()
+{
+    static const table avx512 { normaliseDirections, packColours, rasteriseSpan, intersectTriangles };
+    return avx512;
+}
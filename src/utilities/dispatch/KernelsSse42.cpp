@@ -0,0 +1,187 @@
+/**
+ * @file KernelsSse42.cpp
+ * @brief The kernels four pixels or triangles at a time with SSE4.2. Only built for x86, with -msse4.2.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "Kernels.h"
+
+#include <nmmintrin.h>
+
+// Nothing here can call an inline function from a header (like std::sqrt()), since the linker could keep this
+// copy of it, built for SSE4.2, for everything else too. Whatever doesn't fill a whole group goes to Generic.
+
+namespace
+{
+    void normaliseDirections(const float *direction, const float *step, float x, float xStep, int count,
+                             float *xs, float *ys, float *zs)
+    {
+        const __m128 lanes = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+        const __m128 one = _mm_set1_ps(1.f);
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const __m128 index = _mm_add_ps(_mm_set1_ps(static_cast<float>(i)), lanes);
+            const __m128 rayX = _mm_add_ps(_mm_set1_ps(x), _mm_mul_ps(index, _mm_set1_ps(xStep)));
+            const __m128 dx = _mm_add_ps(_mm_set1_ps(direction[0]), _mm_mul_ps(rayX, _mm_set1_ps(step[0])));
+            const __m128 dy = _mm_add_ps(_mm_set1_ps(direction[1]), _mm_mul_ps(rayX, _mm_set1_ps(step[1])));
+            const __m128 dz = _mm_add_ps(_mm_set1_ps(direction[2]), _mm_mul_ps(rayX, _mm_set1_ps(step[2])));
+            const __m128 lengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+            const __m128 inverseLength = _mm_div_ps(one, _mm_sqrt_ps(lengthSquared));
+            _mm_storeu_ps(xs + i, _mm_mul_ps(dx, inverseLength));
+            _mm_storeu_ps(ys + i, _mm_mul_ps(dy, inverseLength));
+            _mm_storeu_ps(zs + i, _mm_mul_ps(dz, inverseLength));
+        }
+
+        if (i < count)
+        {
+            kernels::getGenericTable().normaliseDirections(direction, step, x + static_cast<float>(i) * xStep, xStep,
+                                                           count - i, xs + i, ys + i, zs + i);
+        }
+    }
+
+    __m128i toChannels(__m128 values)
+    {
+        const __m128 clamped = _mm_min_ps(_mm_max_ps(values, _mm_setzero_ps()), _mm_set1_ps(1.f));
+        return _mm_cvttps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(255.f)));
+    }
+
+    void packColours(const float *colours, std::uint32_t *packed, int count)
+    {
+        // Four colours are twelve channels in three registers. They're narrowed to bytes in order, then each colour's
+        // bytes are swapped around into 0x00RRGGBB.
+        const __m128i order = _mm_setr_epi8(2, 1, 0, -128, 5, 4, 3, -128, 8, 7, 6, -128, 11, 10, 9, -128);
+        int i = 0;
+        for (; i + 4 <= count; i += 4)
+        {
+            const float *source = colours + i * 3;
+            const __m128i first = toChannels(_mm_loadu_ps(source));
+            const __m128i second = toChannels(_mm_loadu_ps(source + 4));
+            const __m128i third = toChannels(_mm_loadu_ps(source + 8));
+            const __m128i bytes = _mm_packus_epi16(_mm_packus_epi32(first, second), _mm_packus_epi32(third, third));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(packed + i), _mm_shuffle_epi8(bytes, order));
+        }
+
+        if (i < count) { kernels::getGenericTable().packColours(colours + i * 3, packed + i, count - i); }
+    }
+
+    void rasteriseSpan(const kernels::rasterSpan &span, float *inverseDepths, std::uint32_t *actors,
+                       std::uint32_t *primitives)
+    {
+        const __m128 lanes = _mm_set_ps(3.f, 2.f, 1.f, 0.f);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128i actor = _mm_set1_epi32(static_cast<int>(span.actor));
+        const __m128i primitive = _mm_set1_epi32(static_cast<int>(span.primitive));
+        int x = span.xStart;
+        for (; x + 4 <= span.xEnd; x += 4)
+        {
+            const __m128 fx = _mm_add_ps(_mm_set1_ps(static_cast<float>(x)), lanes);
+            const __m128 weight0 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(span.weightStep[0]), fx), _mm_set1_ps(span.weightRow[0]));
+            const __m128 weight1 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(span.weightStep[1]), fx), _mm_set1_ps(span.weightRow[1]));
+            const __m128 weight2 = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(span.weightStep[2]), fx), _mm_set1_ps(span.weightRow[2]));
+            const __m128 depth = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(span.depthStep), fx), _mm_set1_ps(span.depthRow));
+            const __m128 oldDepth = _mm_loadu_ps(inverseDepths + x);
+
+            const __m128 isInside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(weight0, zero), _mm_cmpge_ps(weight1, zero)),
+                                               _mm_cmpge_ps(weight2, zero));
+            const __m128 isWritten = _mm_and_ps(isInside, _mm_cmpgt_ps(depth, oldDepth));
+            if (_mm_movemask_ps(isWritten) == 0) { continue; }
+
+            const __m128i mask = _mm_castps_si128(isWritten);
+            const auto oldActors = reinterpret_cast<__m128i *>(actors + x);
+            const auto oldPrimitives = reinterpret_cast<__m128i *>(primitives + x);
+            _mm_storeu_ps(inverseDepths + x, _mm_blendv_ps(oldDepth, depth, isWritten));
+            _mm_storeu_si128(oldActors, _mm_blendv_epi8(_mm_loadu_si128(oldActors), actor, mask));
+            _mm_storeu_si128(oldPrimitives, _mm_blendv_epi8(_mm_loadu_si128(oldPrimitives), primitive, mask));
+        }
+
+        if (x < span.xEnd)
+        {
+            kernels::rasterSpan rest = span;
+            rest.xStart = x;
+            kernels::getGenericTable().rasteriseSpan(rest, inverseDepths, actors, primitives);
+        }
+    }
+
+    /** @returns The two registers' cross product, as glm::cross() does it, with each register holding one axis. */
+    void cross(const __m128 (&a)[3], const __m128 (&b)[3], __m128 (&result)[3])
+    {
+        result[0] = _mm_sub_ps(_mm_mul_ps(a[1], b[2]), _mm_mul_ps(b[1], a[2]));
+        result[1] = _mm_sub_ps(_mm_mul_ps(a[2], b[0]), _mm_mul_ps(b[2], a[0]));
+        result[2] = _mm_sub_ps(_mm_mul_ps(a[0], b[1]), _mm_mul_ps(b[0], a[1]));
+    }
+
+    __m128 dot(const __m128 (&a)[3], const __m128 (&b)[3])
+    {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])), _mm_mul_ps(a[2], b[2]));
+    }
+
+    /** Intersects four triangles, one per lane. The rest of the lanes are zeroed if there are fewer. */
+    std::uint32_t intersectFour(const float *corners, int count, const float *origin, const float *direction,
+                                float maxDistance, float *distances)
+    {
+        // Each triangle is nine floats, so every register takes the same corner axis from each of them.
+        auto gather = [&](int offset) {
+            return _mm_setr_ps(corners[offset], count > 1 ? corners[9 + offset] : 0.f,
+                               count > 2 ? corners[18 + offset] : 0.f, count > 3 ? corners[27 + offset] : 0.f);
+        };
+        __m128 v0[3], edge1[3], edge2[3], toOrigin[3], rayDirection[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            v0[axis] = gather(axis);
+            edge1[axis] = _mm_sub_ps(gather(3 + axis), v0[axis]);
+            edge2[axis] = _mm_sub_ps(gather(6 + axis), v0[axis]);
+            toOrigin[axis] = _mm_sub_ps(_mm_set1_ps(origin[axis]), v0[axis]);
+            rayDirection[axis] = _mm_set1_ps(direction[axis]);
+        }
+
+        __m128 p[3], q[3];
+        cross(rayDirection, edge2, p);
+        cross(toOrigin, edge1, q);
+        const __m128 zero = _mm_setzero_ps();
+        const __m128 one = _mm_set1_ps(1.f);
+        const __m128 determinant = dot(edge1, p);
+        const __m128 inverseDeterminant = _mm_div_ps(one, determinant);
+        const __m128 u = _mm_mul_ps(dot(toOrigin, p), inverseDeterminant);
+        const __m128 v = _mm_mul_ps(dot(rayDirection, q), inverseDeterminant);
+        const __m128 distance = _mm_mul_ps(dot(edge2, q), inverseDeterminant);
+
+        // The negated comparisons are true for NaN, like the early outs of Generic that they stand in for.
+        const __m128 isInside = _mm_and_ps(_mm_and_ps(_mm_cmpnlt_ps(u, zero), _mm_cmpngt_ps(u, one)),
+                                           _mm_and_ps(_mm_cmpnlt_ps(v, zero), _mm_cmpngt_ps(_mm_add_ps(u, v), one)));
+        const __m128 isAhead = _mm_and_ps(_mm_cmpgt_ps(distance, zero),
+                                          _mm_cmplt_ps(distance, _mm_set1_ps(maxDistance)));
+        const __m128 isHit = _mm_and_ps(_mm_and_ps(_mm_cmpneq_ps(determinant, zero), isInside), isAhead);
+
+        float laneDistances[4];
+        _mm_storeu_ps(laneDistances, distance);
+        for (int i = 0; i < count; ++i) { distances[i] = laneDistances[i]; }
+        return static_cast<std::uint32_t>(_mm_movemask_ps(isHit)) & ((1u << static_cast<unsigned int>(count)) - 1u);
+    }
+
+    std::uint32_t intersectTriangles(const float *corners, int count, const float *origin, const float *direction,
+                                     float maxDistance, float *distances)
+    {
+        // Leaves rarely hold more than four triangles, so a group that isn't full is padded rather than left to
+        // Generic.
+        std::uint32_t hits = 0;
+        for (int i = 0; i < count; i += 4)
+        {
+            const int groupSize = count - i < 4 ? count - i : 4;
+            const std::uint32_t groupHits = intersectFour(corners + i * 9, groupSize, origin, direction, maxDistance,
+                                                          distances + i);
+            hits |= groupHits << static_cast<unsigned int>(i);
+        }
+        return hits;
+    }
+}
+
+const kernels::table &kernels::getSse42Table()
+{
+    static const table sse42 { normaliseDirections, packColours, rasteriseSpan, intersectTriangles };
+    return sse42;
+}
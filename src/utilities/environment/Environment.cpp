@@ -0,0 +1,207 @@
+/**
+ * @file Environment.cpp
+ * @brief What rays see when they leave the scene, either a procedural sky or an HDR image.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "Environment.h"
+#include "Geometry.h"
+
+#include "GLM/gtc/constants.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <sstream>
+
+Environment::Environment()
+    : Environment(skyColours())
+{
+
+}
+
+Environment::Environment(const skyColours &sky)
+{
+    setSky(sky);
+}
+
+void Environment::setSky(const skyColours &sky)
+{
+    mGround = sky.ground;
+    mSkyTable.resize(skyResolution + 2);
+    for (int step = 0; step <= skyResolution; ++step)
+    {
+        const float up = static_cast<float>(step) / static_cast<float>(skyResolution);
+        mSkyTable[step] = up < sky.skyBottomAngle
+                ? glm::mix(sky.horizon, sky.skyBottom, normalise(up, 0.f, sky.skyBottomAngle))
+                : glm::mix(sky.skyBottom, sky.skyTop, normalise(up, sky.skyBottomAngle, 1.f));
+    }
+    mSkyTable[skyResolution + 1] = mSkyTable[skyResolution];
+
+    mLayout = Sky;
+    mFile.close();
+    mTexels = nullptr;
+    mImageSize = mFaceSize = glm::ivec2(0);
+}
+
+bool Environment::load(const std::string &path, std::string &error)
+{
+    MappedFile file;
+    if (!file.open(path))
+    {
+        error = "Could not open the environment " + path;
+        return false;
+    }
+
+    // The header is three whitespace separated lines: PF, the width and height, then the scale, whose sign is the
+    // byte order. A single whitespace character separates it from the texels.
+    const std::size_t headerLimit = std::min<std::size_t>(file.getSize(), 256);
+    std::istringstream header(std::string(file.getData(), headerLimit));
+    std::string magic;
+    glm::ivec2 size(0);
+    float scale = 0.f;
+    header >> magic >> size.x >> size.y >> scale;
+    if (!header || magic != "PF" || size.x <= 0 || size.y <= 0)
+    {
+        error = path + " isn't an RGB PFM image";
+        return false;
+    }
+    if (scale >= 0.f)
+    {
+        error = path + " is big endian. Only little endian PFM images are supported";
+        return false;
+    }
+
+    const std::size_t offset = static_cast<std::size_t>(header.tellg()) + 1;
+    const std::size_t bytes = static_cast<std::size_t>(size.x) * static_cast<std::size_t>(size.y) * sizeof(glm::vec3);
+    if (file.getSize() < offset + bytes)
+    {
+        error = path + " is missing some of its texels";
+        return false;
+    }
+
+    layout imageLayout;
+    glm::ivec2 faceSize = size;
+    if (size.x == 2 * size.y)
+    {
+        imageLayout = Equirectangular;
+    }
+    else if (size.y == 6 * size.x)
+    {
+        imageLayout = Cubemap;
+        faceSize.y = size.x;
+    }
+    else
+    {
+        error = path + " has to be twice as wide as it is tall (equirectangular) or six times as tall as it is wide "
+                       "(a cubemap)";
+        return false;
+    }
+
+    mFile = std::move(file);
+    mTexels = mFile.getData() + offset;
+    mImageSize = size;
+    mFaceSize = faceSize;
+    mLayout = imageLayout;
+    return true;
+}
+
+glm::vec3 Environment::sample(const glm::vec3 &direction) const
+{
+    switch (mLayout)
+    {
+        case Equirectangular:   return sampleEquirectangular(direction);
+        case Cubemap:           return sampleCubemap(direction);
+        case Sky:               break;
+    }
+
+    if (!(direction.y >= 0.f)) { return mGround; }  // Below the horizon (or not a direction at all).
+
+    // The last step is repeated, so straight up (or a rounding error past it) still has a step above it.
+    const float position = direction.y * static_cast<float>(skyResolution);
+    const int step = glm::min(static_cast<int>(position), skyResolution);
+    return glm::mix(mSkyTable[step], mSkyTable[step + 1], position - static_cast<float>(step));
+}
+
+std::size_t Environment::getBytesUsed() const
+{
+    return mSkyTable.capacity() * sizeof(glm::vec3);
+}
+
+glm::vec3 Environment::getTexel(int x, int y) const
+{
+    // The texels may not be aligned to a float, so they're copied out.
+    const std::size_t row = static_cast<std::size_t>(mImageSize.y - 1 - y);
+    glm::vec3 colour;
+    std::memcpy(&colour.x, mTexels + (row * mImageSize.x + x) * sizeof(glm::vec3), sizeof(glm::vec3));
+    return colour;
+}
+
+glm::vec3 Environment::sampleBilinear(const glm::vec2 &position, int faceRow, bool isWrapping) const
+{
+    // Texel centres are half way across each texel.
+    const glm::vec2 texel = position - 0.5f;
+    const glm::vec2 corner = glm::floor(texel);
+    const glm::vec2 weight = texel - corner;
+
+    int left = static_cast<int>(corner.x);
+    int right = left + 1;
+    if (isWrapping)
+    {
+        left = (left % mFaceSize.x + mFaceSize.x) % mFaceSize.x;
+        right = right % mFaceSize.x;
+    }
+    else
+    {
+        left = glm::clamp(left, 0, mFaceSize.x - 1);
+        right = glm::clamp(right, 0, mFaceSize.x - 1);
+    }
+    const int top = faceRow + glm::clamp(static_cast<int>(corner.y), 0, mFaceSize.y - 1);
+    const int bottom = faceRow + glm::clamp(static_cast<int>(corner.y) + 1, 0, mFaceSize.y - 1);
+
+    return glm::mix(glm::mix(getTexel(left, top), getTexel(right, top), weight.x),
+                    glm::mix(getTexel(left, bottom), getTexel(right, bottom), weight.x),
+                    weight.y);
+}
+
+glm::vec3 Environment::sampleEquirectangular(const glm::vec3 &direction) const
+{
+    // Straight ahead (-Z) is in the middle of the image and straight up is the top row.
+    const float longitude = std::atan2(direction.x, -direction.z) * glm::one_over_two_pi<float>() + 0.5f;
+    const float latitude = std::acos(glm::clamp(direction.y, -1.f, 1.f)) * glm::one_over_pi<float>();
+    return sampleBilinear(glm::vec2(longitude, latitude) * glm::vec2(mFaceSize), 0, true);
+}
+
+glm::vec3 Environment::sampleCubemap(const glm::vec3 &direction) const
+{
+    // The face is picked by the largest axis, then the other two are projected onto it the same way as OpenGL.
+    const glm::vec3 size = glm::abs(direction);
+    int face;
+    glm::vec2 onFace;
+    float major;
+    if (size.x >= size.y && size.x >= size.z)
+    {
+        face = direction.x > 0.f ? 0 : 1;
+        onFace = glm::vec2(direction.x > 0.f ? -direction.z : direction.z, -direction.y);
+        major = size.x;
+    }
+    else if (size.y >= size.z)
+    {
+        face = direction.y > 0.f ? 2 : 3;
+        onFace = glm::vec2(direction.x, direction.y > 0.f ? direction.z : -direction.z);
+        major = size.y;
+    }
+    else
+    {
+        face = direction.z > 0.f ? 4 : 5;
+        onFace = glm::vec2(direction.z > 0.f ? direction.x : -direction.x, -direction.y);
+        major = size.z;
+    }
+
+    const glm::vec2 position = (onFace / major + 1.f) * 0.5f * glm::vec2(mFaceSize);
+    return sampleBilinear(position, face * mFaceSize.y, false);
+}
@@ -21,3 +21,59 @@ float map(const float &x, const float &xLb, const float &xUb, const float &yLb,
     const float xN = normalise(x, xLb, xUb);
     return yLb + xN * (yUb - yLb);
 }
+
+aabb aabb::transform(const glm::mat4 &matrix) const
+{
+    aabb box;
+    for (int corner = 0; corner < 8; ++corner)
+    {
+        const glm::vec3 point((corner & 1) ? max.x : min.x, (corner & 2) ? max.y : min.y, (corner & 4) ? max.z : min.z);
+        box.grow(glm::vec3(matrix * glm::vec4(point, 1.f)));
+    }
+    return box;
+}
+
+bool isIntersecting(const aabb &box, const glm::vec3 &origin, const glm::vec3 &inverseDirection,
+                    float maxDistance, float &entryDistance)
+{
+    const glm::vec3 t1 = (box.min - origin) * inverseDirection;
+    const glm::vec3 t2 = (box.max - origin) * inverseDirection;
+    const glm::vec3 tMin = glm::min(t1, t2);
+    const glm::vec3 tMax = glm::max(t1, t2);
+
+    entryDistance = glm::max(glm::max(tMin.x, tMin.y), glm::max(tMin.z, 0.f));
+    const float exitDistance = glm::min(glm::min(tMax.x, tMax.y), glm::min(tMax.z, maxDistance));
+    return entryDistance <= exitDistance;
+}
+
+namespace
+{
+    /** @returns -1 for negative numbers and 1 for everything else (including 0). */
+    glm::vec2 signNotZero(const glm::vec2 &value)
+    {
+        return { value.x >= 0.f ? 1.f : -1.f, value.y >= 0.f ? 1.f : -1.f };
+    }
+}
+
+std::uint32_t encodeOctahedral(const glm::vec3 &normal)
+{
+    // Project onto the octahedron and fold the bottom half over the top.
+    glm::vec2 point = glm::vec2(normal) / (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z));
+    if (normal.z < 0.f) { point = (1.f - glm::abs(glm::vec2(point.y, point.x))) * signNotZero(point); }
+
+    const glm::ivec2 quantised = glm::ivec2(glm::round(glm::clamp(point, -1.f, 1.f) * 32767.f));
+    return static_cast<std::uint16_t>(quantised.x)
+           | static_cast<std::uint32_t>(static_cast<std::uint16_t>(quantised.y)) << 16u;
+}
+
+glm::vec3 decodeOctahedral(std::uint32_t encoded)
+{
+    const glm::vec2 point(static_cast<std::int16_t>(encoded & 0xFFFFu) / 32767.f,
+                          static_cast<std::int16_t>(encoded >> 16u) / 32767.f);
+    glm::vec3 normal(point, 1.f - glm::abs(point.x) - glm::abs(point.y));
+    if (normal.z < 0.f)
+    {
+        normal = glm::vec3((1.f - glm::abs(glm::vec2(point.y, point.x))) * signNotZero(point), normal.z);
+    }
+    return glm::normalize(normal);
+}
@@ -0,0 +1,773 @@
+/**
+ * @file MeshImporter.cpp
+ * @brief Reads OBJ and binary PLY meshes into vertex and index buffers that are shared between meshes.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "MeshImporter.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+
+namespace
+{
+    /** OBJ files are split into chunks of about this many bytes. Chunks always end at the end of a line. */
+    const std::size_t objChunkSize = 1 << 20;
+
+    /** PLY elements are decoded in blocks of this many records. */
+    const std::size_t plyBlockSize = 1 << 16;
+
+    // Text parsing. The mapped file isn't null terminated, so nothing here can read past the end pointer.
+
+    bool isSpace(char c)
+    {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    bool isDigit(char c)
+    {
+        return c >= '0' && c <= '9';
+    }
+
+    const char *skipSpaces(const char *c, const char *end)
+    {
+        while (c < end && isSpace(*c)) { ++c; }
+        return c;
+    }
+
+    /** @returns The position of the next new line or end if there isn't one. */
+    const char *findLineEnd(const char *c, const char *end)
+    {
+        const auto *newLine = static_cast<const char*>(std::memchr(c, '\n', static_cast<std::size_t>(end - c)));
+        return newLine != nullptr ? newLine : end;
+    }
+
+    /** @returns True if the line starts with the keyword followed by a space. Moves c past the keyword if so. */
+    bool startsWith(const char *&c, const char *end, const char *keyword)
+    {
+        const std::size_t length = std::strlen(keyword);
+        if (static_cast<std::size_t>(end - c) <= length || std::memcmp(c, keyword, length) != 0) { return false; }
+        if (!isSpace(c[length])) { return false; }
+        c += length;
+        return true;
+    }
+
+    std::string readWord(const char *&c, const char *end)
+    {
+        c = skipSpaces(c, end);
+        const char *start = c;
+        while (c < end && !isSpace(*c)) { ++c; }
+        return std::string(start, c);
+    }
+
+    /** Reads a number such as -1.5e-3. Much quicker than strtof() and doesn't need a null terminator. */
+    bool parseFloat(const char *&c, const char *end, float &value)
+    {
+        static const double powersOfTen[] = {
+                1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+        };
+
+        c = skipSpaces(c, end);
+        bool isNegative = false;
+        if (c < end && (*c == '-' || *c == '+')) { isNegative = *c++ == '-'; }
+
+        double mantissa = 0.0;
+        int exponent = 0;
+        bool hasDigits = false;
+        for (; c < end && isDigit(*c); ++c, hasDigits = true)
+        {
+            mantissa = mantissa * 10.0 + (*c - '0');
+        }
+        if (c < end && *c == '.')
+        {
+            for (++c; c < end && isDigit(*c); ++c, hasDigits = true)
+            {
+                mantissa = mantissa * 10.0 + (*c - '0');
+                --exponent;
+            }
+        }
+        if (!hasDigits) { return false; }
+
+        if (c < end && (*c == 'e' || *c == 'E'))
+        {
+            ++c;
+            bool isExponentNegative = false;
+            if (c < end && (*c == '-' || *c == '+')) { isExponentNegative = *c++ == '-'; }
+            int value = 0;
+            for (; c < end && isDigit(*c); ++c)
+            {
+                value = std::min(value * 10 + (*c - '0'), 1000);
+            }
+            exponent += isExponentNegative ? -value : value;
+        }
+
+        if (exponent < 0 && exponent >= -22)    { mantissa /= powersOfTen[-exponent]; }
+        else if (exponent >= 0 && exponent <= 22) { mantissa *= powersOfTen[exponent]; }
+        else                                    { mantissa *= std::pow(10.0, exponent); }
+
+        value = static_cast<float>(isNegative ? -mantissa : mantissa);
+        return true;
+    }
+
+    /** Reads the vertex index of an OBJ face corner (v, v/vt, v//vn or v/vt/vn) and skips the rest. */
+    bool parseFaceIndex(const char *&c, const char *end, long long &index)
+    {
+        c = skipSpaces(c, end);
+        bool isNegative = false;
+        if (c < end && *c == '-') { isNegative = true; ++c; }
+        if (c == end || !isDigit(*c)) { return false; }
+
+        index = 0;
+        for (; c < end && isDigit(*c); ++c)
+        {
+            index = index * 10 + (*c - '0');
+        }
+        if (isNegative) { index = -index; }
+
+        while (c < end && !isSpace(*c) && *c != '\n') { ++c; }  // Texture and normal indices.
+        return true;
+    }
+
+    /** @returns The number of corners on the face. */
+    std::size_t countFaceCorners(const char *c, const char *end)
+    {
+        std::size_t corners = 0;
+        while (true)
+        {
+            c = skipSpaces(c, end);
+            if (c == end) { return corners; }
+            ++corners;
+            while (c < end && !isSpace(*c)) { ++c; }
+        }
+    }
+
+    std::string getDirectory(const std::string &path)
+    {
+        const std::size_t slash = path.find_last_of("/\\");
+        return slash == std::string::npos ? "" : path.substr(0, slash + 1);
+    }
+
+    /** Reads the colours of every material in a .mtl file. Missing files just have no materials. */
+    std::map<std::string, actorLightingMaterial> loadMaterialLibrary(const std::string &path, std::size_t &bytesRead)
+    {
+        struct mtlMaterial
+        {
+            glm::vec3 diffuse { 0.8f };
+            glm::vec3 ambient { -1.f };
+            glm::vec3 specular { 0.f };
+            float shininess { 32.f };
+            float dissolve { 1.f };
+            float opticalDensity { 1.5f };
+        };
+
+        std::map<std::string, mtlMaterial> found;
+        std::ifstream file(path);
+        std::string text;
+        mtlMaterial *current = nullptr;
+        while (std::getline(file, text))
+        {
+            bytesRead += text.size() + 1;
+            std::istringstream line(text);
+            std::string keyword;
+            line >> keyword;
+
+            if (keyword == "newmtl")
+            {
+                std::string name;
+                line >> name;
+                current = &found[name];
+            }
+            else if (current == nullptr)    { continue; }
+            else if (keyword == "Kd")       { line >> current->diffuse.x >> current->diffuse.y >> current->diffuse.z; }
+            else if (keyword == "Ka")       { line >> current->ambient.x >> current->ambient.y >> current->ambient.z; }
+            else if (keyword == "Ks")       { line >> current->specular.x >> current->specular.y >> current->specular.z; }
+            else if (keyword == "Ns")       { line >> current->shininess; }
+            else if (keyword == "d")        { line >> current->dissolve; }
+            else if (keyword == "Tr")       { float tr = 0.f; line >> tr; current->dissolve = 1.f - tr; }
+            else if (keyword == "Ni")       { line >> current->opticalDensity; }
+        }
+
+        std::map<std::string, actorLightingMaterial> materials;
+        for (const auto &material : found)
+        {
+            const mtlMaterial &m = material.second;
+            const glm::vec3 ambient = m.ambient.x < 0.f ? m.diffuse * 0.05f : m.ambient;
+            materials.emplace(material.first, actorLightingMaterial(m.diffuse, ambient, m.diffuse, m.specular,
+                                                                    glm::vec3(1.f - m.dissolve), glm::vec3(0.f),
+                                                                    m.shininess, m.opticalDensity));
+        }
+        return materials;
+    }
+
+    /** A part of an OBJ file that is decoded by a single job. */
+    struct objChunk
+    {
+        const char                  *begin;
+        const char                  *end;
+
+        // Counted by the first pass.
+        std::size_t                 vertexCount;
+        std::size_t                 triangleCount;
+        std::vector<std::string>    usedMaterials;
+        std::string                 materialLibrary;
+
+        // Where the chunk writes to in the second pass.
+        std::size_t                 firstVertex;
+        std::size_t                 firstTriangle;
+        std::uint32_t               startMaterial;
+
+        std::string                 error;
+    };
+
+    /** Counts everything in the chunk so that every chunk knows where to write to before any are decoded. */
+    void countObjChunk(objChunk &chunk)
+    {
+        for (const char *c = chunk.begin; c < chunk.end;)
+        {
+            const char *lineEnd = findLineEnd(c, chunk.end);
+            c = skipSpaces(c, lineEnd);
+
+            if (startsWith(c, lineEnd, "v"))
+            {
+                ++chunk.vertexCount;
+            }
+            else if (startsWith(c, lineEnd, "f"))
+            {
+                const std::size_t corners = countFaceCorners(c, lineEnd);
+                chunk.triangleCount += corners >= 3 ? corners - 2 : 0;
+            }
+            else if (startsWith(c, lineEnd, "usemtl"))
+            {
+                chunk.usedMaterials.push_back(readWord(c, lineEnd));
+            }
+            else if (startsWith(c, lineEnd, "mtllib") && chunk.materialLibrary.empty())
+            {
+                chunk.materialLibrary = readWord(c, lineEnd);
+            }
+            c = lineEnd + 1;
+        }
+    }
+
+    /** Decodes the chunk straight into its part of the buffer. */
+    void decodeObjChunk(objChunk &chunk, const std::map<std::string, std::uint32_t> &materialIds,
+                        std::size_t totalVertexCount, glm::vec3 *positions, std::uint32_t *indices,
+                        std::uint32_t *faceMaterials)
+    {
+        std::size_t vertex = chunk.firstVertex;
+        std::size_t triangle = chunk.firstTriangle;
+        std::uint32_t material = chunk.startMaterial;
+
+        for (const char *c = chunk.begin; c < chunk.end;)
+        {
+            const char *lineEnd = findLineEnd(c, chunk.end);
+            c = skipSpaces(c, lineEnd);
+
+            if (startsWith(c, lineEnd, "v"))
+            {
+                glm::vec3 &position = positions[vertex++];
+                if (!parseFloat(c, lineEnd, position.x) || !parseFloat(c, lineEnd, position.y)
+                    || !parseFloat(c, lineEnd, position.z))
+                {
+                    chunk.error = "a vertex is missing a coordinate";
+                    return;
+                }
+            }
+            else if (startsWith(c, lineEnd, "f"))
+            {
+                std::uint32_t corners[2];
+                std::size_t cornerCount = 0;
+                long long index;
+                while (parseFaceIndex(c, lineEnd, index))
+                {
+                    // Negative indices count back from the last vertex read.
+                    const long long resolved = index < 0 ? static_cast<long long>(vertex) + index : index - 1;
+                    if (resolved < 0 || resolved >= static_cast<long long>(totalVertexCount))
+                    {
+                        chunk.error = "a face uses a vertex that doesn't exist";
+                        return;
+                    }
+
+                    const auto corner = static_cast<std::uint32_t>(resolved);
+                    if (cornerCount >= 2)
+                    {
+                        // Fan out from the first corner.
+                        std::uint32_t *triangleIndices = &indices[triangle * 3];
+                        triangleIndices[0] = corners[0];
+                        triangleIndices[1] = corners[1];
+                        triangleIndices[2] = corner;
+                        faceMaterials[triangle++] = material;
+                        corners[1] = corner;
+                    }
+                    else
+                    {
+                        corners[cornerCount] = corner;
+                    }
+                    ++cornerCount;
+                }
+                if (skipSpaces(c, lineEnd) != lineEnd)
+                {
+                    chunk.error = "a face has an index that isn't a number";
+                    return;
+                }
+            }
+            else if (startsWith(c, lineEnd, "usemtl"))
+            {
+                const auto id = materialIds.find(readWord(c, lineEnd));
+                material = id == materialIds.end() ? noMaterialId : id->second;
+            }
+            c = lineEnd + 1;
+        }
+    }
+
+    bool importObj(const MappedFile &file, const std::string &path, meshBuffer &buffer, ThreadPool &pool,
+                   importedMesh &mesh)
+    {
+        // Split the file at the first new line after every chunk size.
+        std::vector<objChunk> chunks;
+        const char *data = file.getData();
+        const char *fileEnd = data + file.getSize();
+        for (const char *begin = data; begin < fileEnd;)
+        {
+            const char *end = begin + std::min(objChunkSize, static_cast<std::size_t>(fileEnd - begin));
+            end = end == fileEnd ? fileEnd : std::min(findLineEnd(end, fileEnd) + 1, fileEnd);
+            chunks.push_back({ begin, end, 0, 0, { }, { }, 0, 0, noMaterialId, { } });
+            begin = end;
+        }
+
+        pool.parallelFor(static_cast<int>(chunks.size()), [&chunks](int i) { countObjChunk(chunks[i]); });
+
+        // Work out where each chunk writes to and which material it starts with.
+        std::string materialLibrary;
+        for (const auto &chunk : chunks)
+        {
+            if (materialLibrary.empty()) { materialLibrary = chunk.materialLibrary; }
+        }
+        const std::map<std::string, actorLightingMaterial> library = materialLibrary.empty() ?
+                std::map<std::string, actorLightingMaterial>() :
+                loadMaterialLibrary(getDirectory(path) + materialLibrary, mesh.bytesRead);
+
+        std::map<std::string, std::uint32_t> materialIds;
+        std::uint32_t material = noMaterialId;
+        for (auto &chunk : chunks)
+        {
+            chunk.firstVertex = mesh.vertexCount;
+            chunk.firstTriangle = mesh.triangleCount;
+            chunk.startMaterial = material;
+            mesh.vertexCount += chunk.vertexCount;
+            mesh.triangleCount += chunk.triangleCount;
+
+            for (const std::string &name : chunk.usedMaterials)
+            {
+                const auto libraryMaterial = library.find(name);
+                if (libraryMaterial == library.end())
+                {
+                    material = noMaterialId;  // Falls back to the material of the mesh.
+                    continue;
+                }
+
+                const auto id = materialIds.find(name);
+                if (id != materialIds.end())
+                {
+                    material = id->second;
+                    continue;
+                }
+                material = static_cast<std::uint32_t>(mesh.materials.size());
+                materialIds[name] = material;
+                mesh.materials.push_back(libraryMaterial->second);
+            }
+        }
+
+        if (mesh.vertexCount > std::numeric_limits<std::uint32_t>::max())
+        {
+            mesh.error = "too many vertices";
+            return false;
+        }
+
+        buffer.positions.resize(mesh.firstVertex + mesh.vertexCount);
+        buffer.indices.resize((mesh.firstTriangle + mesh.triangleCount) * 3);
+        buffer.materialIds.resize(mesh.firstTriangle + mesh.triangleCount);
+
+        glm::vec3 *positions = buffer.positions.data() + mesh.firstVertex;
+        std::uint32_t *indices = buffer.indices.data() + mesh.firstTriangle * 3;
+        std::uint32_t *faceMaterials = buffer.materialIds.data() + mesh.firstTriangle;
+        const std::size_t vertexCount = mesh.vertexCount;
+        pool.parallelFor(static_cast<int>(chunks.size()), [&](int i) {
+            decodeObjChunk(chunks[i], materialIds, vertexCount, positions, indices, faceMaterials);
+        });
+
+        for (const auto &chunk : chunks)
+        {
+            if (!chunk.error.empty())
+            {
+                mesh.error = chunk.error;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Binary PLY
+
+    enum plyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64, NumberOfPlyTypes };
+
+    const std::size_t plyTypeSizes[NumberOfPlyTypes] = { 1, 1, 2, 2, 4, 4, 4, 8 };
+
+    bool toPlyType(const std::string &name, plyType &type)
+    {
+        static const std::map<std::string, plyType> types = {
+                { "char", Int8 },       { "int8", Int8 },
+                { "uchar", UInt8 },     { "uint8", UInt8 },
+                { "short", Int16 },     { "int16", Int16 },
+                { "ushort", UInt16 },   { "uint16", UInt16 },
+                { "int", Int32 },       { "int32", Int32 },
+                { "uint", UInt32 },     { "uint32", UInt32 },
+                { "float", Float32 },   { "float32", Float32 },
+                { "double", Float64 },  { "float64", Float64 }
+        };
+        const auto found = types.find(name);
+        if (found == types.end()) { return false; }
+        type = found->second;
+        return true;
+    }
+
+    struct plyProperty
+    {
+        std::string name;
+        plyType     type;
+        bool        isList;
+        plyType     countType;
+    };
+
+    struct plyElement
+    {
+        std::string                 name;
+        std::size_t                 count;
+        std::vector<plyProperty>    properties;
+    };
+
+    /** Reads a single value, swapping the bytes if the file's byte order doesn't match this machine. */
+    double readPly(const char *data, plyType type, bool swapBytes)
+    {
+        unsigned char bytes[8];
+        const std::size_t size = plyTypeSizes[type];
+        std::memcpy(bytes, data, size);
+        if (swapBytes) { std::reverse(bytes, bytes + size); }
+
+        switch (type)
+        {
+            case Int8:      { std::int8_t v;    std::memcpy(&v, bytes, size); return v; }
+            case UInt8:     { std::uint8_t v;   std::memcpy(&v, bytes, size); return v; }
+            case Int16:     { std::int16_t v;   std::memcpy(&v, bytes, size); return v; }
+            case UInt16:    { std::uint16_t v;  std::memcpy(&v, bytes, size); return v; }
+            case Int32:     { std::int32_t v;   std::memcpy(&v, bytes, size); return v; }
+            case UInt32:    { std::uint32_t v;  std::memcpy(&v, bytes, size); return v; }
+            case Float32:   { float v;          std::memcpy(&v, bytes, size); return v; }
+            case Float64:
+            default:        { double v;         std::memcpy(&v, bytes, size); return v; }
+        }
+    }
+
+    /** Where a block of faces starts and where its triangles go. */
+    struct plyFaceBlock
+    {
+        std::size_t offset;
+        std::size_t firstFace;
+        std::size_t firstTriangle;
+    };
+
+    bool importPly(const MappedFile &file, meshBuffer &buffer, ThreadPool &pool, importedMesh &mesh)
+    {
+        const char *data = file.getData();
+        const std::size_t size = file.getSize();
+
+        // The header is plain text and always small.
+        const char *headerEnd = nullptr;
+        for (const char *c = data; c < data + size; c = findLineEnd(c, data + size) + 1)
+        {
+            if (std::strncmp(c, "end_header", std::min<std::size_t>(10, data + size - c)) == 0)
+            {
+                headerEnd = findLineEnd(c, data + size) + 1;
+                break;
+            }
+        }
+        if (headerEnd == nullptr || headerEnd > data + size) { mesh.error = "missing end_header"; return false; }
+
+        std::istringstream header(std::string(data, headerEnd));
+        std::string text;
+        std::getline(header, text);
+        if (text.compare(0, 3, "ply") != 0) { mesh.error = "not a PLY file"; return false; }
+
+        const std::uint16_t byteOrderProbe = 1;
+        const bool isMachineLittleEndian = *reinterpret_cast<const unsigned char*>(&byteOrderProbe) == 1;
+        bool swapBytes = false;
+        std::vector<plyElement> elements;
+        while (std::getline(header, text))
+        {
+            std::istringstream line(text);
+            std::string keyword;
+            line >> keyword;
+            if (keyword == "format")
+            {
+                std::string format;
+                line >> format;
+                if      (format == "binary_little_endian")  { swapBytes = !isMachineLittleEndian; }
+                else if (format == "binary_big_endian")     { swapBytes = isMachineLittleEndian; }
+                else    { mesh.error = "only binary PLY files are supported"; return false; }
+            }
+            else if (keyword == "element")
+            {
+                plyElement element { };
+                line >> element.name >> element.count;
+                elements.push_back(element);
+            }
+            else if (keyword == "property" && !elements.empty())
+            {
+                plyProperty property { };
+                std::string type;
+                line >> type;
+                if (type == "list")
+                {
+                    std::string countType;
+                    line >> countType >> type;
+                    property.isList = true;
+                    if (!toPlyType(countType, property.countType)) { mesh.error = "unknown type " + countType; return false; }
+                }
+                if (!toPlyType(type, property.type)) { mesh.error = "unknown type " + type; return false; }
+                line >> property.name;
+                elements.back().properties.push_back(property);
+            }
+        }
+
+        // Walk the elements to find where the vertices and faces are.
+        const plyElement *vertexElement = nullptr;
+        const plyElement *faceElement = nullptr;
+        std::size_t vertexOffset = 0;
+        std::size_t vertexStride = 0;
+        std::size_t positionOffsets[3] = { };
+        plyType positionTypes[3] = { };
+        bool hasPosition[3] = { };
+        std::vector<plyFaceBlock> faceBlocks;
+
+        // The face record is the vertex index list with fixed size properties either side of it.
+        std::size_t faceBefore = 0, faceAfter = 0;
+        plyType faceCountType = UInt8, faceIndexType = Int32;
+        bool hasFaceMaterial = false, isFaceMaterialAfterList = false;
+        std::size_t faceMaterialOffset = 0;
+        plyType faceMaterialType = Int32;
+
+        std::size_t offset = static_cast<std::size_t>(headerEnd - data);
+        for (const plyElement &element : elements)
+        {
+            if (vertexElement != nullptr && faceElement != nullptr) { break; }  // Nothing else is needed.
+
+            if (element.name == "face")
+            {
+                bool hasList = false;
+                for (const plyProperty &property : element.properties)
+                {
+                    if (property.isList)
+                    {
+                        if (hasList || (property.name != "vertex_indices" && property.name != "vertex_index"))
+                        {
+                            mesh.error = "faces can only have a single list of vertex indices";
+                            return false;
+                        }
+                        hasList = true;
+                        faceCountType = property.countType;
+                        faceIndexType = property.type;
+                        continue;
+                    }
+
+                    std::size_t &fixedSize = hasList ? faceAfter : faceBefore;
+                    if (property.name == "material_index" || property.name == "material")
+                    {
+                        hasFaceMaterial = true;
+                        isFaceMaterialAfterList = hasList;
+                        faceMaterialOffset = fixedSize;
+                        faceMaterialType = property.type;
+                    }
+                    fixedSize += plyTypeSizes[property.type];
+                }
+                if (!hasList) { mesh.error = "faces don't have any vertex indices"; return false; }
+
+                // The faces are different sizes so they have to be walked to find out where each block starts.
+                faceElement = &element;
+                const std::size_t countSize = plyTypeSizes[faceCountType];
+                const std::size_t indexSize = plyTypeSizes[faceIndexType];
+                for (std::size_t face = 0; face < element.count; ++face)
+                {
+                    if (face % plyBlockSize == 0) { faceBlocks.push_back({ offset, face, mesh.triangleCount }); }
+                    if (offset + faceBefore + countSize > size) { mesh.error = "the file ends early"; return false; }
+
+                    const auto corners = static_cast<std::size_t>(readPly(data + offset + faceBefore, faceCountType,
+                                                                          swapBytes));
+                    mesh.triangleCount += corners >= 3 ? corners - 2 : 0;
+                    offset += faceBefore + countSize + corners * indexSize + faceAfter;
+                }
+                continue;
+            }
+
+            std::size_t stride = 0;
+            for (const plyProperty &property : element.properties)
+            {
+                if (property.isList) { mesh.error = "only faces can have lists"; return false; }
+                if (element.name == "vertex" && property.name.size() == 1
+                    && property.name[0] >= 'x' && property.name[0] <= 'z')
+                {
+                    const int axis = property.name[0] - 'x';
+                    positionOffsets[axis] = stride;
+                    positionTypes[axis] = property.type;
+                    hasPosition[axis] = true;
+                }
+                stride += plyTypeSizes[property.type];
+            }
+            if (element.name == "vertex")
+            {
+                vertexElement = &element;
+                vertexOffset = offset;
+                vertexStride = stride;
+            }
+            offset += stride * element.count;
+        }
+
+        if (vertexElement == nullptr || faceElement == nullptr) { mesh.error = "missing vertices or faces"; return false; }
+        if (!hasPosition[0] || !hasPosition[1] || !hasPosition[2]) { mesh.error = "vertices need an x, y and z"; return false; }
+        if (offset > size) { mesh.error = "the file ends early"; return false; }
+        mesh.vertexCount = vertexElement->count;
+        if (mesh.vertexCount > std::numeric_limits<std::uint32_t>::max()) { mesh.error = "too many vertices"; return false; }
+
+        buffer.positions.resize(mesh.firstVertex + mesh.vertexCount);
+        buffer.indices.resize((mesh.firstTriangle + mesh.triangleCount) * 3);
+        buffer.materialIds.resize(mesh.firstTriangle + mesh.triangleCount);
+        glm::vec3 *positions = buffer.positions.data() + mesh.firstVertex;
+        std::uint32_t *indices = buffer.indices.data() + mesh.firstTriangle * 3;
+        std::uint32_t *faceMaterials = buffer.materialIds.data() + mesh.firstTriangle;
+
+        const std::size_t vertexCount = mesh.vertexCount;
+        const int vertexBlocks = static_cast<int>((vertexCount + plyBlockSize - 1) / plyBlockSize);
+        pool.parallelFor(vertexBlocks, [&](int block) {
+            const std::size_t first = block * plyBlockSize;
+            const std::size_t last = std::min(first + plyBlockSize, vertexCount);
+            for (std::size_t i = first; i < last; ++i)
+            {
+                const char *record = data + vertexOffset + i * vertexStride;
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    positions[i][axis] = static_cast<float>(readPly(record + positionOffsets[axis],
+                                                                    positionTypes[axis], swapBytes));
+                }
+            }
+        });
+
+        std::vector<char> hasBadIndex(faceBlocks.size(), false);
+        const std::size_t faceCount = faceElement->count;
+        pool.parallelFor(static_cast<int>(faceBlocks.size()), [&](int block) {
+            std::size_t position = faceBlocks[block].offset;
+            std::size_t triangle = faceBlocks[block].firstTriangle;
+            const std::size_t last = std::min(faceBlocks[block].firstFace + plyBlockSize, faceCount);
+            const std::size_t countSize = plyTypeSizes[faceCountType];
+            const std::size_t indexSize = plyTypeSizes[faceIndexType];
+
+            for (std::size_t face = faceBlocks[block].firstFace; face < last; ++face)
+            {
+                const auto corners = static_cast<std::size_t>(readPly(data + position + faceBefore, faceCountType,
+                                                                      swapBytes));
+                const char *list = data + position + faceBefore + countSize;
+
+                std::uint32_t material = noMaterialId;
+                if (hasFaceMaterial)
+                {
+                    const char *property = isFaceMaterialAfterList ? list + corners * indexSize : data + position;
+                    material = static_cast<std::uint32_t>(readPly(property + faceMaterialOffset, faceMaterialType,
+                                                                  swapBytes));
+                }
+
+                std::uint32_t first = 0, previous = 0;
+                for (std::size_t corner = 0; corner < corners; ++corner)
+                {
+                    const double index = readPly(list + corner * indexSize, faceIndexType, swapBytes);
+                    if (index < 0 || index >= vertexCount) { hasBadIndex[block] = true; return; }
+
+                    const auto vertex = static_cast<std::uint32_t>(index);
+                    if (corner >= 2)
+                    {
+                        indices[triangle * 3] = first;
+                        indices[triangle * 3 + 1] = previous;
+                        indices[triangle * 3 + 2] = vertex;
+                        faceMaterials[triangle++] = material;
+                    }
+                    else if (corner == 0)
+                    {
+                        first = vertex;
+                    }
+                    previous = vertex;
+                }
+                position += faceBefore + countSize + corners * indexSize + faceAfter;
+            }
+        });
+
+        if (std::find(hasBadIndex.begin(), hasBadIndex.end(), true) != hasBadIndex.end())
+        {
+            mesh.error = "a face uses a vertex that doesn't exist";
+            return false;
+        }
+        return true;
+    }
+
+    std::string getExtension(const std::string &path)
+    {
+        const std::size_t dot = path.find_last_of('.');
+        std::string extension = dot == std::string::npos ? "" : path.substr(dot + 1);
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+        return extension;
+    }
+}
+
+importedMesh importMesh(const std::string &path, meshBuffer &buffer, ThreadPool &pool)
+{
+    const auto start = std::chrono::steady_clock::now();
+
+    importedMesh mesh { false };
+    mesh.firstVertex = buffer.positions.size();
+    mesh.firstTriangle = buffer.materialIds.size();
+
+    MappedFile file;
+    if (!file.open(path))
+    {
+        mesh.error = "could not open " + path;
+        return mesh;
+    }
+    mesh.bytesRead += file.getSize();
+
+    const std::string extension = getExtension(path);
+    if      (extension == "obj") { mesh.success = importObj(file, path, buffer, pool, mesh); }
+    else if (extension == "ply") { mesh.success = importPly(file, buffer, pool, mesh); }
+    else                         { mesh.error = "unknown mesh format ." + extension; }
+
+    if (!mesh.success)
+    {
+        // Leave the buffer as it was.
+        buffer.positions.resize(mesh.firstVertex);
+        buffer.indices.resize(mesh.firstTriangle * 3);
+        buffer.materialIds.resize(mesh.firstTriangle);
+        mesh.vertexCount = mesh.triangleCount = 0;
+        mesh.materials.clear();
+    }
+
+    mesh.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return mesh;
+}
@@ -0,0 +1,232 @@
+/**
+ * @file ClusterCache.cpp
+ * @brief Keeps a budgeted set of page file clusters in memory for scenes that are larger than memory.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "ClusterCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    /** Set when the ray that this thread is tracing needs a cluster that isn't resident. */
+    thread_local bool isDeferred = false;
+}
+
+ClusterCache::ClusterCache(const std::string &path, std::size_t residentBudget) :
+    mPath(path),
+    mWriter(path, std::ios::binary | std::ios::trunc),
+    mBudget(residentBudget)
+{
+
+}
+
+ClusterCache::~ClusterCache()
+{
+    mWriter.close();
+    mFile.close();
+    std::remove(mPath.c_str());
+}
+
+std::string ClusterCache::makeTemporaryPath()
+{
+    static std::atomic<unsigned int> counter { 0 };
+
+    std::string directory = ".";
+    for (const char *variable : { "TMPDIR", "TEMP", "TMP" })
+    {
+        const char *value = std::getenv(variable);
+        if (value != nullptr && *value != '\0')
+        {
+            directory = value;
+            break;
+        }
+    }
+
+    // Several copies of the program might be running, so the time keeps the names apart between them.
+    const auto time = std::chrono::steady_clock::now().time_since_epoch().count();
+    return directory + "/A2McgRayTracer-" + std::to_string(time) + "-" + std::to_string(counter++) + ".pages";
+}
+
+std::uint32_t ClusterCache::addCluster(const std::vector<char> &data)
+{
+    const char padding[pageSize] {};
+    const std::size_t start = (mWriteOffset + pageSize - 1) / pageSize * pageSize;
+    mWriter.write(padding, static_cast<std::streamsize>(start - mWriteOffset));
+    mWriter.write(data.data(), static_cast<std::streamsize>(data.size()));
+    mWriteOffset = start + data.size();
+
+    mRanges.emplace_back(start, data.size());
+    return static_cast<std::uint32_t>(mRanges.size() - 1);
+}
+
+bool ClusterCache::finish()
+{
+    mWriter.close();
+    if (mWriter.fail() || !mFile.open(mPath)) { return false; }
+
+    mClusterCount = mRanges.size();
+    mClusters = std::make_unique<cluster[]>(mClusterCount);
+    for (std::size_t i = 0; i < mClusterCount; ++i)
+    {
+        mClusters[i].offset = mRanges[i].first;
+        mClusters[i].size = mRanges[i].second;
+
+        // Writing the file leaves it in the OS's cache, which doesn't count as resident.
+        mFile.evict(mClusters[i].offset, mClusters[i].size);
+    }
+    mRanges = std::vector<std::pair<std::size_t, std::size_t>>();
+    return true;
+}
+
+const char *ClusterCache::find(std::uint32_t index)
+{
+    cluster &c = mClusters[index];
+    if (c.isResident.load(std::memory_order_acquire))
+    {
+        // Every thread touches the same clusters, so only write when it changes to keep the cache line shared.
+        if (c.lastUsed.load(std::memory_order_relaxed) != mBatch)
+        {
+            c.lastUsed.store(mBatch, std::memory_order_relaxed);
+        }
+        return mFile.getData() + c.offset;
+    }
+
+    if (!c.isRequested.load(std::memory_order_relaxed))
+    {
+        c.isRequested.store(true, std::memory_order_relaxed);
+        mHasRequests.store(true, std::memory_order_release);
+    }
+    isDeferred = true;
+    return nullptr;
+}
+
+void ClusterCache::beginRay()
+{
+    isDeferred = false;
+}
+
+bool ClusterCache::isRayDeferred()
+{
+    return isDeferred;
+}
+
+void ClusterCache::countDeferredRays(std::size_t count)
+{
+    mDeferredRays.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ClusterCache::pageIn()
+{
+    if (!hasRequests()) { return; }
+    const auto start = std::chrono::steady_clock::now();
+
+    std::vector<std::uint32_t> requested;
+    std::size_t requestedBytes = 0;
+    for (std::uint32_t i = 0; i < mClusterCount; ++i)
+    {
+        if (mClusters[i].isRequested.load(std::memory_order_relaxed))
+        {
+            requested.push_back(i);
+            requestedBytes += mClusters[i].size;
+        }
+    }
+
+    // Make room by throwing out whatever was used longest ago. Anything used since the last batch is kept
+    // (going over budget if it has to), otherwise rays that need more than the budget would never finish.
+    if (mResidentBytes + requestedBytes > mBudget)
+    {
+        std::vector<std::uint32_t> resident;
+        for (std::uint32_t i = 0; i < mClusterCount; ++i)
+        {
+            const cluster &c = mClusters[i];
+            if (c.isResident.load(std::memory_order_relaxed) && c.lastUsed.load(std::memory_order_relaxed) != mBatch)
+            {
+                resident.push_back(i);
+            }
+        }
+        std::sort(resident.begin(), resident.end(), [this](std::uint32_t a, std::uint32_t b) {
+            return mClusters[a].lastUsed.load(std::memory_order_relaxed)
+                   < mClusters[b].lastUsed.load(std::memory_order_relaxed);
+        });
+        for (std::size_t i = 0; i < resident.size() && mResidentBytes + requestedBytes > mBudget; ++i)
+        {
+            evict(mClusters[resident[i]]);
+        }
+    }
+
+    // Requests are already in file order, so the reads go through the file from front to back.
+    ++mBatch;
+    for (const std::uint32_t index : requested)
+    {
+        mFile.prefetch(mClusters[index].offset, mClusters[index].size);
+    }
+    for (const std::uint32_t index : requested)
+    {
+        cluster &c = mClusters[index];
+        const volatile char *data = mFile.getData() + c.offset;
+        for (std::size_t offset = 0; offset < c.size; offset += pageSize)
+        {
+            (void)data[offset];  // Fault every page in now rather than while rendering.
+        }
+
+        c.lastUsed.store(mBatch, std::memory_order_relaxed);
+        c.isRequested.store(false, std::memory_order_relaxed);
+        c.isResident.store(true, std::memory_order_release);
+        mResidentBytes += c.size;
+        mBytesPagedIn += c.size;
+        ++mPageIns;
+    }
+    mHasRequests.store(false, std::memory_order_release);
+
+    ++mBatches;
+    mPageInSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void ClusterCache::evict(cluster &evicted)
+{
+    evicted.isResident.store(false, std::memory_order_relaxed);
+    mFile.evict(evicted.offset, evicted.size);
+    mResidentBytes -= evicted.size;
+    ++mEvictions;
+}
+
+ClusterCache::statistics ClusterCache::getStatistics() const
+{
+    std::size_t residentClusters = 0;
+    for (std::size_t i = 0; i < mClusterCount; ++i)
+    {
+        residentClusters += mClusters[i].isResident.load(std::memory_order_relaxed) ? 1 : 0;
+    }
+
+    return {
+            mResidentBytes,
+            mBudget,
+            residentClusters,
+            mClusterCount,
+            mPageIns,
+            mBytesPagedIn,
+            mEvictions,
+            mDeferredRays.load(std::memory_order_relaxed),
+            mBatches,
+            mPageInSeconds
+    };
+}
+
+void ClusterCache::resetStatistics()
+{
+    mPageIns = 0;
+    mBytesPagedIn = 0;
+    mEvictions = 0;
+    mBatches = 0;
+    mPageInSeconds = 0.0;
+    mDeferredRays.store(0, std::memory_order_relaxed);
+}
@@ -0,0 +1,138 @@
+/**
+ * @file MappedFile.cpp
+ * @brief A read-only view of a file that is mapped straight into memory.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "MappedFile.h"
+
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept
+    : mData(other.mData), mSize(other.mSize)
+{
+    other.mData = nullptr;
+    other.mSize = 0;
+}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        std::swap(mData, other.mData);
+        std::swap(mSize, other.mSize);
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) { return false; }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    // The view keeps the file open, so neither handle is needed once it exists.
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (mapping == nullptr) { return false; }
+
+    void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (view == nullptr) { return false; }
+
+    mData = static_cast<const char*>(view);
+    mSize = static_cast<std::size_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mData != nullptr) { UnmapViewOfFile(mData); }
+    mData = nullptr;
+    mSize = 0;
+}
+
+void MappedFile::prefetch(std::size_t offset, std::size_t size) const
+{
+    // Touching the pages reads them in, so there's nothing to do ahead of time on older versions of Windows.
+}
+
+void MappedFile::evict(std::size_t offset, std::size_t size) const
+{
+    // Unlocking pages that were never locked removes them from the working set.
+    VirtualUnlock(const_cast<char*>(mData + offset), size);
+}
+#else
+bool MappedFile::open(const std::string &path)
+{
+    close();
+
+    const int file = ::open(path.c_str(), O_RDONLY);
+    if (file < 0) { return false; }
+
+    struct stat info {};
+    if (fstat(file, &info) != 0 || info.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+
+    // The mapping keeps the file open, so the descriptor isn't needed once it exists.
+    void *view = mmap(nullptr, static_cast<std::size_t>(info.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+    ::close(file);
+    if (view == MAP_FAILED) { return false; }
+
+    mData = static_cast<const char*>(view);
+    mSize = static_cast<std::size_t>(info.st_size);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mData != nullptr) { munmap(const_cast<char*>(mData), mSize); }
+    mData = nullptr;
+    mSize = 0;
+}
+
+void MappedFile::prefetch(std::size_t offset, std::size_t size) const
+{
+    madvise(const_cast<char*>(mData + offset), size, MADV_WILLNEED);
+}
+
+void MappedFile::evict(std::size_t offset, std::size_t size) const
+{
+    // The mapping is never written to, so the pages are read back from the file the next time they're touched.
+    madvise(const_cast<char*>(mData + offset), size, MADV_DONTNEED);
+}
+#endif
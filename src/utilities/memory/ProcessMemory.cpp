@@ -0,0 +1,37 @@
+/**
+ * @file ProcessMemory.cpp
+ * @brief Asks the OS how much memory the whole process is using.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "ProcessMemory.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+std::size_t getPeakMemoryUsage()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) { return 0; }
+    return counters.PeakWorkingSetSize;
+#else
+    rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#ifdef __APPLE__
+    return static_cast<std::size_t>(usage.ru_maxrss);  // Already in bytes.
+#else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;  // In kilobytes everywhere else.
+#endif
+#endif
+}
@@ -0,0 +1,187 @@
+/**
+ * @file SceneArena.cpp
+ * @brief Owns every entity in a scene in a few large chunks of memory.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "SceneArena.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+
+#if defined(__GNUC__) || defined(__clang__)
+#include <cxxabi.h>
+#endif
+
+namespace
+{
+    /** The number of objects in the first block of each type. Every block after doubles it. */
+    const std::size_t firstBlockCapacity = 8;
+
+    std::size_t alignUp(std::size_t value, std::size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    /** @returns The name of the type as it's written in the source, rather than mangled. */
+    std::string getReadableName(const std::type_info &type)
+    {
+#if defined(__GNUC__) || defined(__clang__)
+        int status = 0;
+        std::unique_ptr<char, void (*)(void *)> demangled(abi::__cxa_demangle(type.name(), nullptr, nullptr, &status),
+                                                          std::free);
+        if (status == 0 && demangled) { return demangled.get(); }
+#endif
+        // MSVC already gives readable names, although prefixed with class or struct.
+        const std::string name = type.name();
+        for (const std::string prefix : { "class ", "struct " })
+        {
+            if (name.compare(0, prefix.size(), prefix) == 0) { return name.substr(prefix.size()); }
+        }
+        return name;
+    }
+}
+
+SceneArena::SceneArena()
+    : SceneArena(64 * 1024)
+{
+
+}
+
+SceneArena::SceneArena(std::size_t chunkSize)
+    : mChunkSize(chunkSize)
+{
+
+}
+
+SceneArena::~SceneArena()
+{
+    release();
+}
+
+SceneArena::SceneArena(SceneArena &&other) noexcept
+    : mPools(std::move(other.mPools)), mChunks(std::move(other.mChunks)),
+    mChunkSize(other.mChunkSize), mChunkOffset(other.mChunkOffset),
+    mCurrentChunkSize(other.mCurrentChunkSize), mBytesReserved(other.mBytesReserved)
+{
+    other.mPools.clear();
+    other.mChunks.clear();
+    other.mChunkOffset = other.mCurrentChunkSize = other.mBytesReserved = 0;
+}
+
+SceneArena &SceneArena::operator=(SceneArena &&other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        std::swap(mPools, other.mPools);
+        std::swap(mChunks, other.mChunks);
+        std::swap(mChunkSize, other.mChunkSize);
+        std::swap(mChunkOffset, other.mChunkOffset);
+        std::swap(mCurrentChunkSize, other.mCurrentChunkSize);
+        std::swap(mBytesReserved, other.mBytesReserved);
+    }
+    return *this;
+}
+
+void SceneArena::release()
+{
+    // Destroyed backwards, in case anything depends on something made before it.
+    for (auto objectPool = mPools.rbegin(); objectPool != mPools.rend(); ++objectPool)
+    {
+        for (auto b = objectPool->blocks.rbegin(); b != objectPool->blocks.rend(); ++b)
+        {
+            for (std::size_t i = b->count; i > 0; --i)
+            {
+                objectPool->destroy(b->data + (i - 1) * objectPool->size);
+            }
+        }
+    }
+
+    for (auto &chunk : mChunks)
+    {
+        ::operator delete(chunk);
+    }
+
+    mPools.clear();
+    mChunks.clear();
+    mChunkOffset = 0;
+    mCurrentChunkSize = 0;
+    mBytesReserved = 0;
+}
+
+std::vector<SceneArena::usage> SceneArena::getUsage() const
+{
+    std::vector<usage> usages;
+    for (const auto &objectPool : mPools)
+    {
+        usage typeUsage { objectPool.typeName, 0, 0, 0 };
+        for (const auto &b : objectPool.blocks)
+        {
+            typeUsage.count += b.count;
+            typeUsage.bytesReserved += b.capacity * objectPool.size;
+        }
+        typeUsage.bytesUsed = typeUsage.count * objectPool.size;
+        usages.push_back(typeUsage);
+    }
+    return usages;
+}
+
+std::size_t SceneArena::getBytesUsed() const
+{
+    std::size_t bytes = 0;
+    for (const auto &typeUsage : getUsage())
+    {
+        bytes += typeUsage.bytesUsed;
+    }
+    return bytes;
+}
+
+SceneArena::pool &SceneArena::getPool(const std::type_info &type, std::size_t size, std::size_t alignment,
+                                      void (*destroy)(void *))
+{
+    // A scene only has a handful of types, so a search is quicker than a map.
+    const std::type_index index(type);
+    for (auto &objectPool : mPools)
+    {
+        if (objectPool.type == index) { return objectPool; }
+    }
+
+    mPools.push_back({ index, getReadableName(type), size, alignment, destroy, { } });
+    return mPools.back();
+}
+
+void *SceneArena::allocate(pool &objectPool)
+{
+    if (objectPool.blocks.empty() || objectPool.blocks.back().count == objectPool.blocks.back().capacity)
+    {
+        const std::size_t capacity = objectPool.blocks.empty() ? firstBlockCapacity
+                                                               : objectPool.blocks.back().capacity * 2;
+        char *data = allocateFromChunk(capacity * objectPool.size, objectPool.alignment);
+        objectPool.blocks.push_back({ data, capacity, 0 });
+    }
+
+    const block &b = objectPool.blocks.back();
+    return b.data + b.count * objectPool.size;
+}
+
+char *SceneArena::allocateFromChunk(std::size_t bytes, std::size_t alignment)
+{
+    std::size_t offset = alignUp(mChunkOffset, alignment);
+    if (mChunks.empty() || offset + bytes > mCurrentChunkSize)
+    {
+        // Big blocks get a chunk to themselves.
+        mCurrentChunkSize = std::max(mChunkSize, bytes);
+        mChunks.push_back(static_cast<char*>(::operator new(mCurrentChunkSize)));
+        mBytesReserved += mCurrentChunkSize;
+        offset = 0;
+    }
+
+    mChunkOffset = offset + bytes;
+    return mChunks.back() + offset;
+}
@@ -0,0 +1,308 @@
+/**
+ * @file Profiler.cpp
+ * @brief Counters and timers for the renderer's hot paths that are only compiled in with A2_PROFILING.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "Profiler.h"
+
+#ifdef A2_PROFILING
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+
+namespace profiling
+{
+    bool isTracing = false;
+
+    namespace
+    {
+        const char *timerNames[NumberOfTimers] = {
+                "Update", "Commit", "Visibility", "RenderPass", "Tile", "AntiAliasing", "Presentation",
+                "RayGeneration", "Tracing", "Shading"
+        };
+
+        /** How many of the most recent frames the percentiles are taken over. */
+        const std::size_t frameWindow = 256;
+
+        /** How many of the most tested actors are listed each frame. */
+        const std::size_t listedActors = 5;
+
+        struct threadEvent
+        {
+            std::uint32_t   threadId;
+            traceEvent      event;
+        };
+
+        struct frameCounter
+        {
+            clock::time_point   time;
+            double              frameSeconds;
+            std::uint64_t       intersectionTests;
+            std::uint64_t       shadowRays;
+        };
+
+        struct profiler
+        {
+            std::mutex                  lock;
+            std::vector<threadProfile*> threads;
+            std::uint32_t               nextThreadId { 0 };
+
+            /** Counts are only gathered while this is 1, so that no other renderer is counting. */
+            std::uint32_t               rendererCount { 0 };
+
+            /** What threads that have since finished counted before they finished. */
+            profileCounts               retired;
+            std::vector<threadEvent>    retiredEvents;
+
+            std::vector<double>         frameSeconds;
+            std::size_t                 nextFrame { 0 };
+            bool                        hasLastFrame { false };
+            clock::time_point           lastFrame;
+
+            std::string                 tracePath;
+            clock::time_point           traceStart;
+            std::vector<threadEvent>    events;
+            std::vector<frameCounter>   counters;
+        };
+
+        /** Never destroyed, so it outlives every thread's profile however the program ends. */
+        profiler &getProfiler()
+        {
+            static profiler *instance = new profiler();
+            return *instance;
+        }
+
+        void addCounts(std::vector<std::uint64_t> &total, std::vector<std::uint64_t> &counts)
+        {
+            if (total.size() < counts.size()) { total.resize(counts.size()); }
+            for (std::size_t i = 0; i < counts.size(); ++i) { total[i] += counts[i]; }
+            counts.clear();
+        }
+
+        /** Adds everything in counts to total, moves the events out and then resets counts. */
+        void gather(profileCounts &total, profileCounts &counts, std::uint32_t threadId, std::vector<threadEvent> &events)
+        {
+            for (int i = 0; i < NumberOfTimers; ++i)
+            {
+                total.timerSeconds[i] += counts.timerSeconds[i];
+                total.timerCalls[i] += counts.timerCalls[i];
+                counts.timerSeconds[i] = 0.0;
+                counts.timerCalls[i] = 0;
+            }
+            addCounts(total.actorTests, counts.actorTests);
+            addCounts(total.actorHits, counts.actorHits);
+            addCounts(total.lightShadowRays, counts.lightShadowRays);
+            for (int i = 0; i <= maxCountedBounces; ++i)
+            {
+                total.pathBounces[i] += counts.pathBounces[i];
+                counts.pathBounces[i] = 0;
+            }
+            for (const traceEvent &event : counts.events) { events.push_back({ threadId, event }); }
+            counts.events.clear();
+        }
+
+        std::uint64_t sum(const std::vector<std::uint64_t> &counts)
+        {
+            std::uint64_t total = 0;
+            for (const std::uint64_t count : counts) { total += count; }
+            return total;
+        }
+
+        double percentile(const std::vector<double> &sorted, double p)
+        {
+            return sorted[static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1) + 0.5)];
+        }
+
+        void writeSummary(std::ostream &out, const profileCounts &frame, const std::vector<double> &frameSeconds)
+        {
+            const std::ios::fmtflags flags = out.flags();
+            const std::streamsize precision = out.precision();
+            out << std::fixed << std::setprecision(2) << "\nProfile:";
+            for (int i = 0; i < NumberOfTimers; ++i)
+            {
+                if (frame.timerCalls[i] > 0)
+                {
+                    out << " " << timerNames[i] << " " << frame.timerSeconds[i] * 1000.0 << "ms";
+                }
+            }
+
+            out << "\n  Intersection tests: " << sum(frame.actorTests) << " (" << sum(frame.actorHits) << " hits)";
+            std::vector<std::size_t> actors;
+            for (std::size_t i = 0; i < frame.actorTests.size(); ++i)
+            {
+                if (frame.actorTests[i] > 0) { actors.push_back(i); }
+            }
+            const std::size_t listed = std::min(listedActors, actors.size());
+            std::partial_sort(actors.begin(), actors.begin() + listed, actors.end(), [&frame](std::size_t a, std::size_t b) {
+                return frame.actorTests[a] > frame.actorTests[b];
+            });
+            if (listed > 0) { out << ", most tested (tests/hits):"; }
+            for (std::size_t i = 0; i < listed; ++i)
+            {
+                out << " #" << actors[i] << " " << frame.actorTests[actors[i]] << "/" << frame.actorHits[actors[i]];
+            }
+
+            out << "\n  Shadow rays per light:";
+            for (const std::uint64_t count : frame.lightShadowRays) { out << " " << count; }
+
+            out << "\n  Paths by surfaces hit:";
+            for (int i = 0; i <= maxCountedBounces; ++i)
+            {
+                if (frame.pathBounces[i] > 0)
+                {
+                    out << " " << i << (i == maxCountedBounces ? "+" : "") << ":" << frame.pathBounces[i];
+                }
+            }
+
+            if (!frameSeconds.empty())
+            {
+                std::vector<double> sorted = frameSeconds;
+                std::sort(sorted.begin(), sorted.end());
+                out << "\n  Frame times over the last " << sorted.size() << " frames: p50 "
+                    << percentile(sorted, 0.5) * 1000.0 << "ms, p99 " << percentile(sorted, 0.99) * 1000.0 << "ms";
+            }
+            out << "\n";
+            out.flags(flags);
+            out.precision(precision);
+        }
+
+        double toMicroseconds(clock::duration duration)
+        {
+            return std::chrono::duration<double, std::micro>(duration).count();
+        }
+    }
+
+    threadProfile::threadProfile()
+    {
+        profiler &p = getProfiler();
+        std::lock_guard<std::mutex> guard(p.lock);
+        threadId = p.nextThreadId++;
+        p.threads.push_back(this);
+    }
+
+    threadProfile::~threadProfile()
+    {
+        profiler &p = getProfiler();
+        std::lock_guard<std::mutex> guard(p.lock);
+        p.threads.erase(std::remove(p.threads.begin(), p.threads.end(), this), p.threads.end());
+        gather(p.retired, *this, threadId, p.retiredEvents);
+    }
+
+    void endFrame(std::ostream *out)
+    {
+        profiler &p = getProfiler();
+        std::lock_guard<std::mutex> guard(p.lock);
+        if (p.rendererCount > 1) { return; }
+
+        const clock::time_point now = clock::now();
+        if (p.hasLastFrame)
+        {
+            const double seconds = std::chrono::duration<double>(now - p.lastFrame).count();
+            if (p.frameSeconds.size() < frameWindow) { p.frameSeconds.push_back(seconds); }
+            else                                     { p.frameSeconds[p.nextFrame] = seconds; }
+            p.nextFrame = (p.nextFrame + 1) % frameWindow;
+        }
+
+        profileCounts frame;
+        std::vector<threadEvent> events;
+        events.swap(p.retiredEvents);
+        gather(frame, p.retired, 0, events);
+        for (threadProfile *profile : p.threads)
+        {
+            gather(frame, *profile, profile->threadId, events);
+        }
+
+        if (isTracing)
+        {
+            p.events.insert(p.events.end(), events.begin(), events.end());
+            p.counters.push_back({
+                    now,
+                    p.hasLastFrame ? std::chrono::duration<double>(now - p.lastFrame).count() : 0.0,
+                    sum(frame.actorTests),
+                    sum(frame.lightShadowRays)
+            });
+        }
+        p.lastFrame = now;
+        p.hasLastFrame = true;
+
+        if (out != nullptr) { writeSummary(*out, frame, p.frameSeconds); }
+    }
+
+    void addRenderer()
+    {
+        profiler &p = getProfiler();
+        std::lock_guard<std::mutex> guard(p.lock);
+        ++p.rendererCount;
+    }
+
+    void removeRenderer()
+    {
+        profiler &p = getProfiler();
+        std::lock_guard<std::mutex> guard(p.lock);
+        --p.rendererCount;
+    }
+
+    void startTrace(const std::string &path)
+    {
+        profiler &p = getProfiler();
+        std::lock_guard<std::mutex> guard(p.lock);
+        p.tracePath = path;
+        p.traceStart = clock::now();
+        p.events.clear();
+        p.counters.clear();
+        isTracing = true;
+    }
+
+    bool stopTrace()
+    {
+        profiler &p = getProfiler();
+        std::lock_guard<std::mutex> guard(p.lock);
+        if (!isTracing) { return true; }
+        isTracing = false;
+
+        // Anything since the last frame ended hasn't been gathered yet.
+        p.events.insert(p.events.end(), p.retiredEvents.begin(), p.retiredEvents.end());
+        p.retiredEvents.clear();
+        for (threadProfile *profile : p.threads)
+        {
+            for (const traceEvent &event : profile->events) { p.events.push_back({ profile->threadId, event }); }
+            profile->events.clear();
+        }
+
+        std::ofstream file(p.tracePath);
+        file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool isFirst = true;
+        for (const threadEvent &e : p.events)
+        {
+            if (e.event.start < p.traceStart) { continue; }
+            file << (isFirst ? "" : ",\n")
+                 << "{\"name\":\"" << timerNames[e.event.timer] << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.threadId
+                 << ",\"ts\":" << toMicroseconds(e.event.start - p.traceStart)
+                 << ",\"dur\":" << toMicroseconds(e.event.end - e.event.start) << "}";
+            isFirst = false;
+        }
+        for (const frameCounter &counter : p.counters)
+        {
+            file << (isFirst ? "" : ",\n")
+                 << "{\"name\":\"Frame\",\"ph\":\"C\",\"pid\":1,\"ts\":" << toMicroseconds(counter.time - p.traceStart)
+                 << ",\"args\":{\"frameMs\":" << counter.frameSeconds * 1000.0
+                 << ",\"intersectionTests\":" << counter.intersectionTests
+                 << ",\"shadowRays\":" << counter.shadowRays << "}}";
+            isFirst = false;
+        }
+        file << "\n]}\n";
+
+        p.events = std::vector<threadEvent>();
+        p.counters = std::vector<frameCounter>();
+        return static_cast<bool>(file);
+    }
+}
+
+#endif
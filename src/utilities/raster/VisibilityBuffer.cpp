@@ -0,0 +1,346 @@
+/**
+ * @file VisibilityBuffer.cpp
+ * @brief The nearest surface under every pixel of a camera, found by rasterising the scene instead of tracing rays.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "VisibilityBuffer.h"
+#include "Actor.h"
+#include "Camera.h"
+#include "Kernels.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace
+{
+    /** @returns The plane through a and b that is 0 along the edge and 1 at the opposite corner. */
+    glm::vec3 edgePlane(const glm::vec2 &a, const glm::vec2 &b, float area)
+    {
+        return glm::vec3(a.y - b.y, b.x - a.x, (b.y - a.y) * a.x - (b.x - a.x) * a.y) / area;
+    }
+
+    /** @returns The pixels from min to max (inclusive) that are on the screen. x and y are the start, z and w the end. */
+    glm::ivec4 getPixelBounds(const glm::vec2 &min, const glm::vec2 &max, const glm::ivec2 &resolution)
+    {
+        return glm::ivec4(glm::max(static_cast<int>(std::ceil(min.x)), 0),
+                          glm::max(static_cast<int>(std::ceil(min.y)), 0),
+                          glm::min(static_cast<int>(std::floor(max.x)), resolution.x - 1),
+                          glm::min(static_cast<int>(std::floor(max.y)), resolution.y - 1));
+    }
+
+    /** Limits projected positions so that nothing overflows when they're turned into pixels. */
+    const float maxScreenPosition = 1e7f;
+
+    /** How far apart (relative to the nearest) two inverse depths can be for isNearestAt() to count them as equal. */
+    const float depthTolerance = 1e-3f;
+}
+
+// Passed by reference to std::fill, so it needs a definition.
+const std::uint32_t VisibilityBuffer::noActor;
+
+VisibilityBuffer::VisibilityBuffer(const glm::ivec2 &resolution) :
+    mResolution(resolution),
+    mTileCount((resolution + tileSize - 1) / tileSize)
+{
+}
+
+void VisibilityBuffer::render(const Camera &camera, const std::vector<Actor*> &actors, ThreadPool &threadPool,
+                              const std::atomic<bool> &cancel)
+{
+    const std::size_t pixelCount = static_cast<std::size_t>(mResolution.x) * mResolution.y;
+    mInverseDepths.resize(pixelCount);
+    mActors.resize(pixelCount);
+    mPrimitives.resize(pixelCount);
+
+    // Only the w row is needed to find how far in front of the camera each sphere's hit is.
+    const glm::mat4 worldToScreen = camera.getWorldToScreen();
+    mToDepth = glm::vec4(worldToScreen[0][3], worldToScreen[1][3], worldToScreen[2][3], worldToScreen[3][3]);
+    mNearPlane = camera.getNearPlane();
+
+    // Actors are set up in fixed batches and joined back together in order, so the threads can't change the result.
+    const std::size_t actorsPerJob = 64;
+    const int jobCount = static_cast<int>((actors.size() + actorsPerJob - 1) / actorsPerJob);
+    std::vector<std::vector<screenTriangle>> triangles(jobCount);
+    std::vector<std::vector<screenSphere>> spheres(jobCount);
+    threadPool.parallelFor(jobCount, [&](int job)
+    {
+        if (cancel) { return; }
+        const std::size_t first = job * actorsPerJob;
+        setUp(camera, actors, first, std::min(first + actorsPerJob, actors.size()), triangles[job], spheres[job]);
+    });
+
+    mTriangles.clear();
+    mSpheres.clear();
+    for (int job = 0; job < jobCount; ++job)
+    {
+        mTriangles.insert(mTriangles.end(), triangles[job].begin(), triangles[job].end());
+        mSpheres.insert(mSpheres.end(), spheres[job].begin(), spheres[job].end());
+    }
+    bin();
+
+    threadPool.parallelFor(mTileCount.x * mTileCount.y, [&](int tileIndex)
+    {
+        if (cancel) { return; }
+        rasteriseTile(camera, tileIndex);
+    });
+}
+
+bool VisibilityBuffer::isNearestAt(const glm::ivec2 &pixelPosition, const glm::vec3 &position) const
+{
+    const float depth = 1.f / glm::max(glm::dot(mToDepth, glm::vec4(position, 1.f)), mNearPlane);
+    const float nearest = getInverseDepth(pixelPosition);
+    return glm::abs(depth - nearest) <= depthTolerance * nearest;
+}
+
+int VisibilityBuffer::getNeighbours(const glm::ivec2 &pixelPosition, texel (&neighbours)[4]) const
+{
+    const glm::ivec2 offsets[] = { { -1, 0 }, { 1, 0 }, { 0, -1 }, { 0, 1 } };
+    int count = 0;
+    for (const glm::ivec2 &offset : offsets)
+    {
+        const glm::ivec2 neighbour = pixelPosition + offset;
+        if (glm::all(glm::greaterThanEqual(neighbour, glm::ivec2(0))) && glm::all(glm::lessThan(neighbour, mResolution)))
+        {
+            neighbours[count++] = get(neighbour);
+        }
+    }
+    return count;
+}
+
+std::size_t VisibilityBuffer::getBytesUsed() const
+{
+    std::size_t bytes = mInverseDepths.capacity() * sizeof(float)
+                        + (mActors.capacity() + mPrimitives.capacity()) * sizeof(std::uint32_t)
+                        + mTriangles.capacity() * sizeof(screenTriangle) + mSpheres.capacity() * sizeof(screenSphere);
+    for (const std::vector<std::uint32_t> &bin : mTriangleBins) { bytes += bin.capacity() * sizeof(std::uint32_t); }
+    for (const std::vector<std::uint32_t> &bin : mSphereBins)   { bytes += bin.capacity() * sizeof(std::uint32_t); }
+    return bytes;
+}
+
+void VisibilityBuffer::setUp(const Camera &camera, const std::vector<Actor*> &actors, std::size_t first,
+                             std::size_t last, std::vector<screenTriangle> &triangles,
+                             std::vector<screenSphere> &spheres) const
+{
+    const glm::mat4 worldToScreen = camera.getWorldToScreen();
+    const float nearPlane = camera.getNearPlane();
+    rasterPrimitives primitives;
+    for (std::size_t actor = first; actor < last; ++actor)
+    {
+        primitives.clear();
+        actors[actor]->rasterize(primitives);
+        const auto actorIndex = static_cast<std::uint32_t>(actor);
+
+        const std::size_t triangleCount = primitives.triangles.size() / 3;
+        for (std::size_t triangle = 0; triangle < triangleCount; ++triangle)
+        {
+            // x, y and w. The depth that a perspective projection would normally keep isn't needed.
+            glm::vec3 corners[3];
+            int behindCount = 0;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const glm::vec4 projected = worldToScreen * glm::vec4(primitives.triangles[triangle * 3 + corner], 1.f);
+                corners[corner] = glm::vec3(projected.x, projected.y, projected.w);
+                behindCount += projected.w < nearPlane ? 1 : 0;
+            }
+            if (behindCount == 3) { continue; }
+
+            // Clip against the near plane, which leaves a triangle or a quad that gets split into two.
+            glm::vec3 polygon[4];
+            int polygonSize = 0;
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const glm::vec3 &a = corners[corner];
+                const glm::vec3 &b = corners[(corner + 1) % 3];
+                if (a.z >= nearPlane) { polygon[polygonSize++] = a; }
+                if ((a.z >= nearPlane) != (b.z >= nearPlane))
+                {
+                    polygon[polygonSize++] = glm::mix(a, b, (nearPlane - a.z) / (b.z - a.z));
+                }
+            }
+
+            for (int i = 0; i < polygonSize; ++i)
+            {
+                const glm::vec2 position = glm::clamp(glm::vec2(polygon[i]) / polygon[i].z,
+                                                      -maxScreenPosition, maxScreenPosition);
+                polygon[i] = glm::vec3(position, polygon[i].z);
+            }
+            for (int i = 1; i + 1 < polygonSize; ++i)
+            {
+                const glm::vec3 fan[3] = { polygon[0], polygon[i], polygon[i + 1] };
+                addTriangle(fan, actorIndex, static_cast<std::uint32_t>(triangle), triangles);
+            }
+        }
+
+        for (std::size_t sphere = 0; sphere < primitives.spheres.size(); ++sphere)
+        {
+            const glm::vec4 &centreRadius = primitives.spheres[sphere];
+            const glm::vec3 centre(centreRadius);
+            const float radius = centreRadius.w;
+            if ((worldToScreen * glm::vec4(centre, 1.f)).w + radius < nearPlane) { continue; }
+
+            // The box around the sphere is simpler to project than the sphere's outline and never any smaller.
+            glm::vec2 min(std::numeric_limits<float>::max());
+            glm::vec2 max(-std::numeric_limits<float>::max());
+            bool isCrossingNearPlane = false;
+            for (int corner = 0; corner < 8; ++corner)
+            {
+                const glm::vec3 offset(corner & 1 ? radius : -radius, corner & 2 ? radius : -radius,
+                                       corner & 4 ? radius : -radius);
+                const glm::vec4 projected = worldToScreen * glm::vec4(centre + offset, 1.f);
+                if (projected.w < nearPlane)
+                {
+                    isCrossingNearPlane = true;
+                    break;
+                }
+                min = glm::min(min, glm::vec2(projected) / projected.w);
+                max = glm::max(max, glm::vec2(projected) / projected.w);
+            }
+
+            const glm::ivec4 bounds = isCrossingNearPlane ? glm::ivec4(0, 0, mResolution - 1)
+                                                          : getPixelBounds(min, max, mResolution);
+            if (bounds.x > bounds.z || bounds.y > bounds.w) { continue; }
+            spheres.push_back({ centreRadius, bounds, actorIndex, static_cast<std::uint32_t>(triangleCount + sphere) });
+        }
+    }
+}
+
+void VisibilityBuffer::addTriangle(const glm::vec3 (&corners)[3], std::uint32_t actor, std::uint32_t primitive,
+                                   std::vector<screenTriangle> &triangles) const
+{
+    const glm::vec2 p0(corners[0]);
+    const glm::vec2 p1(corners[1]);
+    const glm::vec2 p2(corners[2]);
+    const glm::vec2 edge1 = p1 - p0;
+    const glm::vec2 edge2 = p2 - p0;
+    const float area = edge1.x * edge2.y - edge1.y * edge2.x;
+    if (!(std::abs(area) > 0.f)) { return; }  // Edge on. Rays slide past it as well.
+
+    const glm::ivec4 bounds = getPixelBounds(glm::min(p0, glm::min(p1, p2)), glm::max(p0, glm::max(p1, p2)), mResolution);
+    if (bounds.x > bounds.z || bounds.y > bounds.w) { return; }
+
+    screenTriangle triangle;
+    triangle.weights[0] = edgePlane(p1, p2, area);
+    triangle.weights[1] = edgePlane(p2, p0, area);
+    triangle.weights[2] = edgePlane(p0, p1, area);
+
+    // 1 / w is linear in screen space, unlike w itself.
+    triangle.inverseDepth = triangle.weights[0] / corners[0].z + triangle.weights[1] / corners[1].z
+                            + triangle.weights[2] / corners[2].z;
+    triangle.bounds = bounds;
+    triangle.actor = actor;
+    triangle.primitive = primitive;
+    triangles.push_back(triangle);
+}
+
+void VisibilityBuffer::bin()
+{
+    const auto binPrimitives = [this](std::vector<std::vector<std::uint32_t>> &bins, const auto &primitives) {
+        bins.resize(mTileCount.x * mTileCount.y);
+        for (std::vector<std::uint32_t> &bin : bins) { bin.clear(); }
+        for (std::size_t i = 0; i < primitives.size(); ++i)
+        {
+            const glm::ivec4 tiles = primitives[i].bounds / tileSize;
+            for (int y = tiles.y; y <= tiles.w; ++y)
+            {
+                for (int x = tiles.x; x <= tiles.z; ++x)
+                {
+                    bins[y * mTileCount.x + x].push_back(static_cast<std::uint32_t>(i));
+                }
+            }
+        }
+    };
+    binPrimitives(mTriangleBins, mTriangles);
+    binPrimitives(mSphereBins, mSpheres);
+}
+
+void VisibilityBuffer::rasteriseTile(const Camera &camera, int tileIndex)
+{
+    const glm::ivec2 tileStart = glm::ivec2(tileIndex % mTileCount.x, tileIndex / mTileCount.x) * tileSize;
+    const glm::ivec2 tileEnd = glm::min(tileStart + tileSize, mResolution);
+    for (int y = tileStart.y; y < tileEnd.y; ++y)
+    {
+        const int rowStart = y * mResolution.x;
+        std::fill(mInverseDepths.begin() + rowStart + tileStart.x, mInverseDepths.begin() + rowStart + tileEnd.x, 0.f);
+        std::fill(mActors.begin() + rowStart + tileStart.x, mActors.begin() + rowStart + tileEnd.x, noActor);
+        std::fill(mPrimitives.begin() + rowStart + tileStart.x, mPrimitives.begin() + rowStart + tileEnd.x, 0u);
+    }
+
+    for (const std::uint32_t triangle : mTriangleBins[tileIndex])
+    {
+        rasteriseTriangle(mTriangles[triangle], tileStart, tileEnd);
+    }
+    for (const std::uint32_t sphere : mSphereBins[tileIndex])
+    {
+        rasteriseSphere(camera, mSpheres[sphere], tileStart, tileEnd);
+    }
+}
+
+void VisibilityBuffer::rasteriseTriangle(const screenTriangle &triangle, const glm::ivec2 &tileStart,
+                                         const glm::ivec2 &tileEnd)
+{
+    const glm::vec3 (&weights)[3] = triangle.weights;
+    const glm::vec3 &inverseDepth = triangle.inverseDepth;
+    const kernels::table &kernel = kernels::get();
+    kernels::rasterSpan span {
+            { weights[0].x, weights[1].x, weights[2].x }, { 0.f, 0.f, 0.f }, inverseDepth.x, 0.f,
+            glm::max(triangle.bounds.x, tileStart.x), glm::min(triangle.bounds.z + 1, tileEnd.x),
+            triangle.actor, triangle.primitive
+    };
+
+    const int yEnd = glm::min(triangle.bounds.w + 1, tileEnd.y);
+    for (int y = glm::max(triangle.bounds.y, tileStart.y); y < yEnd; ++y)
+    {
+        // Every kernel works each pixel out the same way, so they all give the same result.
+        const auto fy = static_cast<float>(y);
+        span.weightRow[0] = weights[0].y * fy + weights[0].z;
+        span.weightRow[1] = weights[1].y * fy + weights[1].z;
+        span.weightRow[2] = weights[2].y * fy + weights[2].z;
+        span.depthRow = inverseDepth.y * fy + inverseDepth.z;
+        const int row = y * mResolution.x;
+        kernel.rasteriseSpan(span, &mInverseDepths[row], &mActors[row], &mPrimitives[row]);
+    }
+}
+
+void VisibilityBuffer::rasteriseSphere(const Camera &camera, const screenSphere &sphere, const glm::ivec2 &tileStart,
+                                       const glm::ivec2 &tileEnd)
+{
+    const int xStart = glm::max(sphere.bounds.x, tileStart.x);
+    const int xEnd = glm::min(sphere.bounds.z + 1, tileEnd.x);
+    const int yEnd = glm::min(sphere.bounds.w + 1, tileEnd.y);
+    const glm::vec3 centre(sphere.sphere);
+    const float radius = sphere.sphere.w;
+
+    Ray rays[tileSize];
+    for (int y = glm::max(sphere.bounds.y, tileStart.y); y < yEnd; ++y)
+    {
+        camera.generateRow({ xStart, y }, xEnd - xStart, 1, rays);
+        for (int x = xStart; x < xEnd; ++x)
+        {
+            // The same test as Sphere::isIntersecting(), so the outline matches the traced one exactly.
+            const Ray &ray = rays[x - xStart];
+            const glm::vec3 delta = centre - ray.mPosition;
+            const float deltaDot = glm::dot(delta, ray.mDirection);
+            if (deltaDot < 0.f) { continue; }
+
+            const float closestPoint = glm::length(delta - deltaDot * ray.mDirection);
+            if (closestPoint > radius) { continue; }
+
+            const float distance = deltaDot - glm::sqrt(radius * radius - closestPoint * closestPoint);
+            const glm::vec3 hitPosition = ray.mPosition + distance * ray.mDirection;
+            const float depth = 1.f / glm::max(glm::dot(mToDepth, glm::vec4(hitPosition, 1.f)), mNearPlane);
+            const int index = y * mResolution.x + x;
+            if (depth > mInverseDepths[index])
+            {
+                mInverseDepths[index] = depth;
+                mActors[index] = sphere.actor;
+                mPrimitives[index] = sphere.primitive;
+            }
+        }
+    }
+}
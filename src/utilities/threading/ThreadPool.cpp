@@ -0,0 +1,87 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief A fixed set of worker threads that split a range of jobs between them.
+ * Project: A2McgRayTracer
+ * @author Ryan Purse
+ * @version 1.0.0
+ * Initial Version: 19/10/2026
+ */
+
+
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned int threadCount)
+{
+    if (threadCount == 0) { threadCount = std::thread::hardware_concurrency(); }
+    if (threadCount == 0) { threadCount = 1; }  // hardware_concurrency() is allowed to not know.
+
+    // The caller of parallelFor() makes up the last thread.
+    for (unsigned int i = 1; i < threadCount; ++i)
+    {
+        mWorkers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mIsStopping = true;
+    }
+    mWakeCondition.notify_all();
+
+    for (auto &worker : mWorkers)
+    {
+        worker.join();
+    }
+}
+
+void ThreadPool::parallelFor(int count, const std::function<void(int)> &job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mJob = &job;
+        mJobCount = count;
+        mNextJob = 0;
+        mBusyWorkers = static_cast<unsigned int>(mWorkers.size());
+        ++mGeneration;
+    }
+    mWakeCondition.notify_all();
+
+    runJobs();  // Help out rather than sitting idle.
+
+    std::unique_lock<std::mutex> lock(mMutex);
+    mDoneCondition.wait(lock, [this]() { return mBusyWorkers == 0; });
+    mJob = nullptr;
+}
+
+void ThreadPool::workerLoop()
+{
+    unsigned int generation = 0;
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWakeCondition.wait(lock, [&]() { return mIsStopping || mGeneration != generation; });
+            if (mIsStopping) { return; }
+            generation = mGeneration;
+        }
+
+        runJobs();
+
+        bool isLastWorker;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            isLastWorker = --mBusyWorkers == 0;
+        }
+        if (isLastWorker) { mDoneCondition.notify_one(); }
+    }
+}
+
+void ThreadPool::runJobs()
+{
+    for (int i = mNextJob++; i < mJobCount; i = mNextJob++)
+    {
+        (*mJob)(i);
+    }
+}